@@ -460,9 +460,12 @@ scan_for_multibyte_characters (const unsigned char *  start,
 }
 
 /* This function is called to process input characters.  The GET
-   parameter is used to retrieve more input characters.  GET should
-   set its parameter to point to a buffer, and return the length of
-   the buffer; it should return 0 at end of file.  The scrubbed output
+   parameter is used to retrieve more input characters.  GET is passed
+   a pointer to a buffer of BUFLEN characters, which it may fill, or it
+   may instead set the pointer to a writable buffer of its own holding
+   at most BUFLEN characters, which must stay valid until all of them
+   have been processed.  It returns the number of characters, or 0 at
+   end of file.  The scrubbed output
    characters are put into the buffer starting at TOSTART; the TOSTART
    buffer is TOLEN bytes in length.  The function returns the number
    of scrubbed characters put into TOSTART.  This will be TOLEN unless
@@ -471,7 +474,7 @@ scan_for_multibyte_characters (const unsigned char *  start,
    This is the way the old code used to work.  */
 
 size_t
-do_scrub_chars (size_t (*get) (char *, size_t), char *tostart, size_t tolen,
+do_scrub_chars (size_t (*get) (char **, size_t), char *tostart, size_t tolen,
 		bool check_multibyte)
 {
   char *to = tostart;
@@ -533,8 +536,8 @@ do_scrub_chars (size_t (*get) (char *, size_t), char *tostart, size_t tolen,
   (from < fromend						\
    ? * (unsigned char *) (from++)				\
    : (saved_input = NULL,					\
-      fromlen = (*get) (input_buffer, sizeof input_buffer),	\
       from = input_buffer,					\
+      fromlen = (*get) (&from, sizeof input_buffer),		\
       fromend = from + fromlen,					\
       (fromlen == 0						\
        ? EOF							\
@@ -569,10 +572,10 @@ do_scrub_chars (size_t (*get) (char *, size_t), char *tostart, size_t tolen,
     }
   else
     {
-      fromlen = (*get) (input_buffer, sizeof input_buffer);
+      from = input_buffer;
+      fromlen = (*get) (&from, sizeof input_buffer);
       if (fromlen == 0)
 	return 0;
-      from = input_buffer;
       fromend = from + fromlen;
 
       if (check_multibyte)
@@ -1614,6 +1617,20 @@ do_scrub_chars (size_t (*get) (char *, size_t), char *tostart, size_t tolen,
   return to - tostart;
 }
 
+/* Copy any input the scrubber has saved out of the buffer its GET
+   function handed back, so that the buffer can be freed.  */
+
+void
+do_scrub_keep_input (void)
+{
+  if (saved_input != NULL && saved_input != input_buffer)
+    {
+      gas_assert (saved_input_len <= sizeof (input_buffer));
+      memmove (input_buffer, saved_input, saved_input_len);
+      saved_input = input_buffer;
+    }
+}
+
 /* Return amount of pending input.  */
 
 size_t
@@ -502,8 +502,9 @@ void   input_scrub_insert_line (const char *);
 void   input_scrub_insert_file (char *);
 char * input_scrub_new_file (const char *);
 char * input_scrub_next_buffer (char **bufp);
-size_t do_scrub_chars (size_t (*get) (char *, size_t), char *, size_t, bool);
+size_t do_scrub_chars (size_t (*get) (char **, size_t), char *, size_t, bool);
 size_t do_scrub_pending (void);
+void   do_scrub_keep_input (void);
 bool   scan_for_multibyte_characters (const unsigned char *, const unsigned char *, bool);
 int    gen_to_words (LITTLENUM_TYPE *, int, long);
 int    had_err (void);
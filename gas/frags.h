@@ -73,6 +73,10 @@ struct frag {
      fr_address has been adjusted.  */
   unsigned int relax_marker:1;
 
+  /* Set when relax_frag has settled this frag against relax_target,
+     so that it need not look at it again unless one of them moves.  */
+  unsigned int relax_target_valid:1;
+
   /* Used to ensure that all insns are emitted on proper address
      boundaries.  */
   unsigned int has_code:1;
@@ -82,6 +86,13 @@ struct frag {
   relax_stateT fr_type;
   relax_substateT fr_subtype;
 
+  /* The state chosen, the address of this frag and the address of the
+     frag holding fr_symbol when relax_frag last relaxed this frag.
+     Valid if relax_target_valid is set.  */
+  relax_substateT relax_state;
+  addressT relax_address;
+  addressT relax_target;
+
 #ifdef USING_CGEN
   /* Don't include this unless using CGEN to keep frag size down.  */
   struct {
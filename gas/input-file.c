@@ -26,6 +26,14 @@
 #include "as.h"
 #include "input-file.h"
 #include "safe-ctype.h"
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+#define USE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
 
 /* This variable is non-zero if the file currently being read should be
    preprocessed by app.  It is zero if the file can be read straight in.  */
@@ -44,6 +52,18 @@ int preprocess = 0;
 static FILE *f_in;
 static const char *file_name;
 
+#ifdef USE_MMAP
+/* When the input is a regular file it is mapped privately, so that the
+   scrubber and the non-preprocessed path can work on it in place.  The
+   mapping is preceded by a page holding a newline sentinel and followed
+   by zeros.  MAP_POS is the next unread character, MAP_END the end of
+   the file contents.  */
+static char *map_base;
+static size_t map_size;
+static char *map_pos;
+static char *map_end;
+#endif
+
 /* Struct for saving the state of this module for file includes.  */
 struct saved_file
   {
@@ -51,6 +71,12 @@ struct saved_file
     const char * file_name;
     int    preprocess;
     char * app_save;
+#ifdef USE_MMAP
+    char * map_base;
+    size_t map_size;
+    char * map_pos;
+    char * map_end;
+#endif
   };
 
 /* These hooks accommodate most operating systems.  */
@@ -59,6 +85,9 @@ void
 input_file_begin (void)
 {
   f_in = (FILE *) 0;
+#ifdef USE_MMAP
+  map_base = NULL;
+#endif
 }
 
 void
@@ -88,6 +117,12 @@ input_file_push (void)
   saved->preprocess = preprocess;
   if (preprocess)
     saved->app_save = app_push ();
+#ifdef USE_MMAP
+  saved->map_base = map_base;
+  saved->map_size = map_size;
+  saved->map_pos = map_pos;
+  saved->map_end = map_end;
+#endif
 
   /* Initialize for new file.  */
   input_file_begin ();
@@ -107,10 +142,81 @@ input_file_pop (char *arg)
   preprocess = saved->preprocess;
   if (preprocess)
     app_pop (saved->app_save);
+#ifdef USE_MMAP
+  map_base = saved->map_base;
+  map_size = saved->map_size;
+  map_pos = saved->map_pos;
+  map_end = saved->map_end;
+#endif
 
   free (arg);
 }
 
+#ifdef USE_MMAP
+/* Try to map the rest of F_IN, from the current stream position on.
+   Leaves MAP_BASE NULL if that is not possible, in which case the
+   input is read through stdio.  */
+
+static void
+input_file_map (void)
+{
+  struct stat st;
+  long pagesize;
+  size_t size, len;
+  long pos;
+  char *base;
+  int c;
+
+  map_base = NULL;
+  if (fstat (fileno (f_in), &st) != 0
+      || !S_ISREG (st.st_mode)
+      || st.st_size <= 0
+      || (size_t) st.st_size != (unsigned long long) st.st_size)
+    return;
+
+  /* The next character may have been pushed back by input_file_open;
+     only use the mapping if it matches the file contents.  */
+  pos = ftell (f_in);
+  c = getc (f_in);
+  if (c == EOF)
+    return;
+  ungetc (c, f_in);
+  size = st.st_size;
+  if (pos < 0 || (size_t) pos >= size)
+    return;
+
+  pagesize = sysconf (_SC_PAGESIZE);
+  if (pagesize <= 0)
+    return;
+  len = (size + pagesize - 1) & -(size_t) pagesize;
+  base = mmap (NULL, len + 2 * pagesize, PROT_READ | PROT_WRITE,
+	       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return;
+  if (mmap (base + pagesize, len, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_FIXED, fileno (f_in), 0) == MAP_FAILED
+      || base[pagesize + pos] != c)
+    {
+      munmap (base, len + 2 * pagesize);
+      return;
+    }
+  base[pagesize - 1] = '\n';
+
+  map_base = base;
+  map_size = len + 2 * pagesize;
+  map_pos = base + pagesize + pos;
+  map_end = base + pagesize + size;
+}
+
+static void
+input_file_unmap (void)
+{
+  if (map_base != NULL)
+    munmap (map_base, map_size);
+  map_base = NULL;
+}
+#endif
+
 /* Open the specified file, "" means stdin.  Filename must not be null.  */
 
 void
@@ -199,6 +305,10 @@ input_file_open (const char *filename,
     }
   else
     ungetc (c, f_in);
+
+#ifdef USE_MMAP
+  input_file_map ();
+#endif
 }
 
 /* Close input file.  */
@@ -211,19 +321,36 @@ input_file_close (void)
     fclose (f_in);
 
   f_in = 0;
+#ifdef USE_MMAP
+  /* The scrubber may still hold characters from the mapping.  */
+  do_scrub_keep_input ();
+  input_file_unmap ();
+#endif
 }
 
 /* This function is passed to do_scrub_chars.  */
 
 static size_t
-input_file_get (char *buf, size_t buflen)
+input_file_get (char **bufp, size_t buflen)
 {
   size_t size;
 
+#ifdef USE_MMAP
+  if (map_base != NULL)
+    {
+      size = map_end - map_pos;
+      if (size > buflen)
+	size = buflen;
+      *bufp = map_pos;
+      map_pos += size;
+      return size;
+    }
+#endif
+
   if (feof (f_in))
     return 0;
 
-  size = fread (buf, sizeof (char), buflen, f_in);
+  size = fread (*bufp, sizeof (char), buflen, f_in);
   if (ferror (f_in))
     as_bad (_("can't read from %s: %s"), file_name, xstrerror (errno));
   return size;
@@ -248,7 +375,11 @@ input_file_give_next_buffer (char *where /* Where to place 1st character of new
                            multibyte_handling == multibyte_warn);
   else
     {
-      size = input_file_get (where, BUFFER_SIZE);
+      char *buf = where;
+
+      size = input_file_get (&buf, BUFFER_SIZE);
+      if (buf != where)
+	memcpy (where, buf, size);
 
       if (multibyte_handling == multibyte_warn)
 	{
@@ -267,8 +398,47 @@ input_file_give_next_buffer (char *where /* Where to place 1st character of new
 	as_warn (_("can't close %s: %s"), file_name, xstrerror (errno));
 
       f_in = (FILE *) 0;
+#ifdef USE_MMAP
+      input_file_unmap ();
+#endif
       return_value = 0;
     }
 
   return return_value;
 }
+
+/* If the rest of the input file needs no preprocessing and is held in
+   memory, return a pointer to it and set *LIMIT to just after its last
+   character, without consuming it.  The buffer is writable, preceded
+   by a newline and followed by a NUL.  Otherwise return NULL.  */
+
+char *
+input_file_whole_buffer (char **limit)
+{
+#ifdef USE_MMAP
+  if (f_in != NULL && map_base != NULL && !preprocess && map_pos < map_end)
+    {
+      /* Characters before MAP_POS have been copied out already.  */
+      map_pos[-1] = '\n';
+      *limit = map_end;
+      return map_pos;
+    }
+#else
+  (void) limit;
+#endif
+  return NULL;
+}
+
+/* Consume the buffer returned by input_file_whole_buffer.  */
+
+void
+input_file_take_whole_buffer (void)
+{
+#ifdef USE_MMAP
+  if (multibyte_handling == multibyte_warn)
+    (void) scan_for_multibyte_characters ((const unsigned char *) map_pos,
+					  (const unsigned char *) map_end,
+					  true /* Generate warnings */);
+  map_pos = map_end;
+#endif
+}
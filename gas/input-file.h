@@ -51,6 +51,12 @@
  *
  * input_file_close ()			Closes opened file.
  *
+ * input_file_whole_buffer(&limit)	Returns the rest of the file in place
+ *					when it is mapped and needs no
+ *					preprocessing, else NULL.
+ *
+ * input_file_take_whole_buffer()	Consumes that buffer.
+ *
  * All errors are reported so caller doesn't have to think
  * about I/O errors.
  */
@@ -63,3 +69,5 @@ void input_file_close (void);
 void input_file_end (void);
 void input_file_open (const char *filename, int pre);
 void input_file_pop (char *arg);
+char *input_file_whole_buffer (char **limit);
+void input_file_take_whole_buffer (void);
@@ -372,6 +372,34 @@ input_scrub_next_buffer (char **bufp)
       memmove (buffer_start + BEFORE_SIZE, partial_where, partial_size);
       memcpy (buffer_start + BEFORE_SIZE, save_source, AFTER_SIZE);
     }
+  else
+    {
+      /* If the rest of the file can be used in place, hand out all of
+	 its complete lines at once rather than copying them through
+	 our buffer.  */
+      char *start = input_file_whole_buffer (&limit);
+
+      if (start != NULL)
+	{
+	  char *p;
+
+	  for (p = limit - 1; p >= start; --p)
+	    if (*p == '\n' && !TC_EOL_IN_INSN (p))
+	      break;
+	  ++p;
+	  if (p > start
+	      && (size_t) (limit - p) <= input_file_buffer_size ())
+	    {
+	      input_file_take_whole_buffer ();
+	      *bufp = start;
+	      partial_where = p;
+	      partial_size = limit - p;
+	      memcpy (save_source, partial_where, (int) AFTER_SIZE);
+	      memcpy (partial_where, AFTER_STRING, (int) AFTER_SIZE);
+	      return partial_where;
+	    }
+	}
+    }
 
   while (1)
     {
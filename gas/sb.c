@@ -91,13 +91,13 @@ sb_add_sb (sb *ptr, sb *s)
 static sb *sb_to_scrub;
 static char *scrub_position;
 static size_t
-scrub_from_sb (char *buf, size_t buflen)
+scrub_from_sb (char **bufp, size_t buflen)
 {
   size_t copy;
   copy = sb_to_scrub->len - (scrub_position - sb_to_scrub->ptr);
   if (copy > buflen)
     copy = buflen;
-  memcpy (buf, scrub_position, copy);
+  memcpy (*bufp, scrub_position, copy);
   scrub_position += copy;
   return copy;
 }
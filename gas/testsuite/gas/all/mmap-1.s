@@ -0,0 +1,8 @@
+	.data
+	.byte 1
+	.include "mmap-1a.s"
+	.byte 2
+	.include "mmap-1b.s"
+	.byte 5
+	.include "mmap-1c.s"
+	.byte 8
@@ -0,0 +1,2 @@
+	.byte 3
+	.byte 4
\ No newline at end of file
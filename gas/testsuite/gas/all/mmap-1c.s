@@ -0,0 +1,3 @@
+#NO_APP
+	.byte 6
+	.byte 7
\ No newline at end of file
@@ -0,0 +1,3 @@
+	.data
+	.byte 9
+	.byte 10
\ No newline at end of file
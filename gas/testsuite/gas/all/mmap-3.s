@@ -0,0 +1,4 @@
+#NO_APP
+	.data
+	.byte 11
+	.byte 12
\ No newline at end of file
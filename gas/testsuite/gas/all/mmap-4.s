@@ -0,0 +1,2 @@
+	.data
+	.byte 14
@@ -0,0 +1,4 @@
+	.data
+	.byte 13
+	.end
+	.byte 99
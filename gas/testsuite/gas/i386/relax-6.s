@@ -0,0 +1,61 @@
+# A chain of branches, each of which only needs its long form once
+# the next one has grown.  The last branch is out of range of its
+# short form, and each relaxation pass grows one more branch, so the
+# branches before the one growing settle and have to be looked at
+# again when their target moves.  The branches of the second chain
+# stay in range of their short form.
+
+	.text
+chain:
+	jmp	.L1
+	.fill	124, 1, 0x90
+	jne	.L2
+.L1:
+	.fill	124, 1, 0x90
+	jmp	.L3
+.L2:
+	.fill	124, 1, 0x90
+	jne	.L4
+.L3:
+	.fill	124, 1, 0x90
+	jmp	.L5
+.L4:
+	.fill	124, 1, 0x90
+	jne	.L6
+.L5:
+	.fill	124, 1, 0x90
+	jmp	.L7
+.L6:
+	.fill	124, 1, 0x90
+	jne	.L8
+.L7:
+	.fill	128, 1, 0x90
+.L8:
+	nop
+
+short_chain:
+	jmp	.LS1
+	.fill	120, 1, 0x90
+	jne	.LS2
+.LS1:
+	.fill	120, 1, 0x90
+	jmp	.LS3
+.LS2:
+	.fill	120, 1, 0x90
+	jne	.LS4
+.LS3:
+	.fill	120, 1, 0x90
+	jmp	.LS5
+.LS4:
+	.fill	120, 1, 0x90
+	jne	.LS6
+.LS5:
+	.fill	120, 1, 0x90
+	jmp	.LS7
+.LS6:
+	.fill	120, 1, 0x90
+	jne	.LS8
+.LS7:
+	.fill	125, 1, 0x90
+.LS8:
+	nop
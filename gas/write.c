@@ -123,6 +123,14 @@ static bool frags_chained = false;
 
 static unsigned int n_fixups;
 
+/* Relaxation statistics, reported by --statistics.  */
+static unsigned long n_relax_passes;
+static unsigned long n_relax_frags;
+#ifdef TC_GENERIC_RELAX_TABLE
+static unsigned long n_relax_frag_calls;
+static unsigned long n_relax_frag_settled;
+#endif
+
 #define RELOC_ENUM enum bfd_reloc_code_real
 
 /* Create a fixS in obstack 'notes'.  */
@@ -2575,6 +2583,8 @@ relax_frag (segT segment, fragS *fragP, long stretch)
   symbolS *symbolP;
   const relax_typeS *table;
 
+  n_relax_frag_calls++;
+
   target = fragP->fr_offset;
   address = fragP->fr_address + fragP->fr_fix;
   table = TC_GENERIC_RELAX_TABLE;
@@ -2588,6 +2598,29 @@ relax_frag (segT segment, fragS *fragP, long stretch)
 
       sym_frag = symbol_get_frag (symbolP);
 
+#ifndef md_prepare_relax_scan
+      /* If neither this frag nor the frag holding a constant symbol
+	 has moved since this frag was last relaxed with no stretch,
+	 the aim is the same as last time, and the state chosen then
+	 still reaches it.  Both addresses are checked, since some
+	 md_relax_frag implementations move frags themselves.  This
+	 saves re-relaxing the frags which have settled, which in a
+	 large section with many branches is nearly all of them.  */
+      if (stretch == 0
+	  && fragP->relax_target_valid
+	  && fragP->relax_address == fragP->fr_address
+	  && fragP->relax_target == sym_frag->fr_address
+	  && fragP->relax_state == this_state)
+	{
+	  n_relax_frag_settled++;
+	  return 0;
+	}
+      fragP->relax_target_valid = (stretch == 0
+				   && symbol_constant_p (symbolP));
+      fragP->relax_address = fragP->fr_address;
+      fragP->relax_target = sym_frag->fr_address;
+#endif
+
 #ifndef DIFF_EXPR_OK
       know (sym_frag != NULL);
 #endif
@@ -2663,6 +2696,7 @@ relax_frag (segT segment, fragS *fragP, long stretch)
   growth = this_type->rlx_length - start_type->rlx_length;
   if (growth != 0)
     fragP->fr_subtype = this_state;
+  fragP->relax_state = this_state;
   return growth;
 }
 
@@ -2720,6 +2754,7 @@ relax_segment (struct frag *segment_frag_root, segT segment, int pass)
     {
       fragP->region = region;
       fragP->relax_marker = 0;
+      fragP->relax_target_valid = 0;
       fragP->fr_address = address;
       address += fragP->fr_fix;
 
@@ -2863,6 +2898,7 @@ relax_segment (struct frag *segment_frag_root, segT segment, int pass)
       {
 	stretch = 0;
 	stretched = 0;
+	n_relax_passes++;
 
 	for (fragP = segment_frag_root; fragP; fragP = fragP->fr_next)
 	  {
@@ -2871,6 +2907,7 @@ relax_segment (struct frag *segment_frag_root, segT segment, int pass)
 	    offsetT offset;
 	    symbolS *symbolP;
 
+	    n_relax_frags++;
 	    fragP->relax_marker ^= 1;
 	    was_address = fragP->fr_address;
 	    address = fragP->fr_address += stretch;
@@ -3232,6 +3269,12 @@ void
 write_print_statistics (FILE *file)
 {
   fprintf (file, "fixups: %d\n", n_fixups);
+  fprintf (file, "relax passes: %lu, frags: %lu\n",
+	   n_relax_passes, n_relax_frags);
+#ifdef TC_GENERIC_RELAX_TABLE
+  fprintf (file, "relax_frag calls: %lu, settled: %lu\n",
+	   n_relax_frag_calls, n_relax_frag_settled);
+#endif
 }
 
 /* For debugging.  */
@@ -158,6 +158,32 @@ amd64_linux_collect_native_gregset (const struct regcache *regcache,
     }
 }
 
+/* Return true if REGCACHE holds valid values for all the registers of
+   the native general-purpose register set of a 64-bit inferior, so
+   that the set can be written back without reading it first.  */
+
+static bool
+amd64_linux_gregset_cached_p (const struct regcache *regcache)
+{
+  struct gdbarch *gdbarch = regcache->arch ();
+
+  if (gdbarch_bfd_arch_info (gdbarch)->bits_per_word == 32)
+    return false;
+
+  int count = 0;
+  for (int i = 0; i < gdbarch_num_regs (gdbarch); i++)
+    if (amd64_native_gregset_supplies_p (gdbarch, i))
+      {
+	if (regcache->get_register_status (i) != REG_VALID)
+	  return false;
+	count++;
+      }
+
+  /* Every slot of the set must come from some register; otherwise the
+     slots that do not would be written back uninitialized.  */
+  return count == ELF_NGREG;
+}
+
 /* Fill GDB's register cache with the general-purpose register values
    in *GREGSETP.  */
 
@@ -223,6 +249,7 @@ amd64_linux_nat_target::fetch_registers (struct regcache *regcache, int regnum)
     {
       elf_gregset_t regs;
 
+      linux_ptrace_stop_requests++;
       if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regs) < 0)
 	perror_with_name (_("Couldn't get registers"));
 
@@ -247,6 +274,7 @@ amd64_linux_nat_target::fetch_registers (struct regcache *regcache, int regnum)
 
 	  iov.iov_base = xstateregs.data ();
 	  iov.iov_len = xstateregs.size ();
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_GETREGSET, tid,
 		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
 	    perror_with_name (_("Couldn't get extended state status"));
@@ -255,6 +283,7 @@ amd64_linux_nat_target::fetch_registers (struct regcache *regcache, int regnum)
 	}
       else
 	{
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_GETFPREGS, tid, 0, (long) &fpregs) < 0)
 	    perror_with_name (_("Couldn't get floating point status"));
 
@@ -283,11 +312,20 @@ amd64_linux_nat_target::store_registers (struct regcache *regcache, int regnum)
     {
       elf_gregset_t regs;
 
-      if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regs) < 0)
-	perror_with_name (_("Couldn't get registers"));
+      /* Only the registers of REGNUM are written, so the others have
+	 to be read first, unless they are all in REGCACHE already.  */
+      if (amd64_linux_gregset_cached_p (regcache))
+	amd64_linux_collect_native_gregset (regcache, &regs, -1);
+      else
+	{
+	  linux_ptrace_stop_requests++;
+	  if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regs) < 0)
+	    perror_with_name (_("Couldn't get registers"));
 
-      amd64_linux_collect_native_gregset (regcache, &regs, regnum);
+	  amd64_linux_collect_native_gregset (regcache, &regs, regnum);
+	}
 
+      linux_ptrace_stop_requests++;
       if (ptrace (PTRACE_SETREGS, tid, 0, (long) &regs) < 0)
 	perror_with_name (_("Couldn't write registers"));
 
@@ -306,23 +344,27 @@ amd64_linux_nat_target::store_registers (struct regcache *regcache, int regnum)
 
 	  iov.iov_base = xstateregs.data ();
 	  iov.iov_len = xstateregs.size ();
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_GETREGSET, tid,
 		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
 	    perror_with_name (_("Couldn't get extended state status"));
 
 	  amd64_collect_xsave (regcache, regnum, xstateregs.data (), 0);
 
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_SETREGSET, tid,
 		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
 	    perror_with_name (_("Couldn't write extended state status"));
 	}
       else
 	{
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_GETFPREGS, tid, 0, (long) &fpregs) < 0)
 	    perror_with_name (_("Couldn't get floating point status"));
 
 	  amd64_collect_fxsave (regcache, regnum, &fpregs);
 
+	  linux_ptrace_stop_requests++;
 	  if (ptrace (PTRACE_SETFPREGS, tid, 0, (long) &fpregs) < 0)
 	    perror_with_name (_("Couldn't write floating point status"));
 	}
@@ -330,6 +372,39 @@ amd64_linux_nat_target::store_registers (struct regcache *regcache, int regnum)
 }
 
 
+/* If the registers of LWPID, a thread of the process of PH, are in its
+   regcache, store in *BASE the %fs base register if WHICH is 0, or the
+   %gs base register if WHICH is 1, and return true.  Otherwise return
+   false.  libthread_db asks for the thread area of a thread at each of
+   its stops, by which time linux-nat.c has usually fetched the
+   registers of the thread, so this saves a ptrace call.  */
+
+static bool
+amd64_linux_cached_segment_base (struct ps_prochandle *ph, lwpid_t lwpid,
+				 int which, unsigned long *base)
+{
+  process_stratum_target *target = ph->thread->inf->process_target ();
+  thread_info *tp = target->find_thread (ptid_t (ph->thread->ptid.pid (),
+						 lwpid));
+  if (tp == nullptr || tp->state == THREAD_EXITED)
+    return false;
+
+  struct regcache *regcache = get_thread_regcache (tp);
+  const i386_gdbarch_tdep *tdep
+    = gdbarch_tdep<i386_gdbarch_tdep> (regcache->arch ());
+  if (tdep->fsbase_regnum < 0)
+    return false;
+
+  int regnum = tdep->fsbase_regnum + which;
+  if (regcache->get_register_status (regnum) != REG_VALID)
+    return false;
+
+  ULONGEST value;
+  regcache->raw_read (regnum, &value);
+  *base = value;
+  return true;
+}
+
 /* This function is called by libthread_db as part of its handling of
    a request for a thread's local storage address.  */
 
@@ -364,7 +439,14 @@ ps_get_thread_area (struct ps_prochandle *ph,
 	case FS:
 	    {
 	      unsigned long fs;
+	      if (amd64_linux_cached_segment_base (ph, lwpid, 0, &fs))
+		{
+		  *base = (void *) fs;
+		  return PS_OK;
+		}
+
 	      errno = 0;
+	      linux_ptrace_stop_requests++;
 	      fs = ptrace (PTRACE_PEEKUSER, lwpid,
 			   offsetof (struct user_regs_struct, fs_base), 0);
 	      if (errno == 0)
@@ -379,7 +461,14 @@ ps_get_thread_area (struct ps_prochandle *ph,
 	case GS:
 	    {
 	      unsigned long gs;
+	      if (amd64_linux_cached_segment_base (ph, lwpid, 1, &gs))
+		{
+		  *base = (void *) gs;
+		  return PS_OK;
+		}
+
 	      errno = 0;
+	      linux_ptrace_stop_requests++;
 	      gs = ptrace (PTRACE_PEEKUSER, lwpid,
 			   offsetof (struct user_regs_struct, gs_base), 0);
 	      if (errno == 0)
@@ -34,6 +34,7 @@
 #include "cli/cli-utils.h"
 #include "extension.h"
 #include "gdbarch.h"
+#include "gdbsupport/unordered_map.h"
 
 /* For maintenance commands.  */
 #include "record-btrace.h"
@@ -195,6 +196,11 @@ ftrace_function_switched (const struct btrace_function *bfun,
   msym = bfun->msym;
   sym = bfun->sym;
 
+  /* This is by far the most common case: we are still in the same
+     function.  */
+  if (mfun == msym && fun == sym)
+    return 0;
+
   /* If the minimal symbol changed, we certainly switched functions.  */
   if (mfun != NULL && msym != NULL
       && strcmp (mfun->linkage_name (), msym->linkage_name ()) != 0)
@@ -542,6 +548,47 @@ ftrace_new_gap (struct btrace_thread_info *btinfo, int errcode,
   return bfun;
 }
 
+/* The symbols found for a PC of the trace.  */
+
+using ftrace_symbols = std::pair<minimal_symbol *, symbol *>;
+
+/* A cache of the symbols found for the PCs of the trace, mapping each PC
+   to its symbols.  The same instructions are typically traced many times
+   over, and looking up their symbols is one of the most expensive parts
+   of computing the function segments.  */
+
+using ftrace_symbol_cache = gdb::unordered_map<CORE_ADDR, ftrace_symbols>;
+
+/* The cache used while computing the function segments of a trace, or
+   NULL when none is being computed.  Symbols can go away between two
+   computations, so the cache only lives for one of them.  */
+
+static ftrace_symbol_cache *ftrace_symbol_cache_current;
+
+/* Return the symbols we have for the instruction at PC.  */
+
+static ftrace_symbols
+ftrace_find_symbols (CORE_ADDR pc)
+{
+  ftrace_symbol_cache *cache = ftrace_symbol_cache_current;
+  if (cache != nullptr)
+    {
+      auto it = cache->find (pc);
+      if (it != cache->end ())
+	return it->second;
+    }
+
+  ftrace_symbols syms (lookup_minimal_symbol_by_pc (pc).minsym,
+		       find_pc_function (pc));
+  if (syms.first == nullptr && syms.second == nullptr)
+    DEBUG_FTRACE ("no symbol at %s", core_addr_to_string_nz (pc));
+
+  if (cache != nullptr)
+    cache->emplace (pc, syms);
+
+  return syms;
+}
+
 /* Update the current function segment at the end of the trace in BTINFO with
    respect to the instruction at PC.  This may create new function segments.
    Return the chronologically latest function segment, never NULL.  */
@@ -557,14 +604,7 @@ ftrace_update_function (struct btrace_thread_info *btinfo,
      to avoid surprises when we sometimes get a full symbol and sometimes
      only a minimal symbol.  */
   if (pc.has_value ())
-    {
-      fun = find_pc_function (*pc);
-      bound_minimal_symbol bmfun = lookup_minimal_symbol_by_pc (*pc);
-      mfun = bmfun.minsym;
-
-      if (fun == nullptr && mfun == nullptr)
-	DEBUG_FTRACE ("no symbol at %s", core_addr_to_string_nz (*pc));
-    }
+    std::tie (mfun, fun) = ftrace_find_symbols (*pc);
 
   /* If we didn't have a function, we create one.  */
   if (btinfo->functions.empty ())
@@ -1917,6 +1957,9 @@ btrace_compute_ftrace (struct thread_info *tp, struct btrace_data *btrace,
 		       const struct btrace_cpu *cpu)
 {
   std::vector<unsigned int> gaps;
+  ftrace_symbol_cache symbols;
+  scoped_restore restore_symbols
+    = make_scoped_restore (&ftrace_symbol_cache_current, &symbols);
 
   try
     {
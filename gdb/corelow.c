@@ -50,10 +50,14 @@
 #include "gdbsupport/x86-xstate.h"
 #include <unordered_map>
 #include <unordered_set>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include "cli/cli-cmds.h"
 #include "xml-tdesc.h"
 #include "memtag.h"
 #include "cli/cli-style.h"
+#include "observable.h"
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -185,10 +189,145 @@ static const target_info core_target_info = {
 Specify the filename of the core file.")
 };
 
+/* An index from addresses to the entries of a table of address
+   ranges, such as a section table.  A lookup finds the first entry, in
+   table order, whose range contains an address, just like a linear
+   search of the table would, but usually in logarithmic time.  */
+
+class address_range_index
+{
+public:
+  /* Add the range [START, END) of the table entry at INDEX.  Entries
+     must be added in table order.  */
+  void add (CORE_ADDR start, CORE_ADDR end, size_t index)
+  {
+    if (start < end)
+      m_entries.push_back ({start, end, index});
+  }
+
+  /* Prepare the index for lookups, once all the entries have been
+     added.  */
+  void finish ()
+  {
+    std::stable_sort (m_entries.begin (), m_entries.end (),
+		      [] (const entry &a, const entry &b)
+		      {
+			return a.start < b.start;
+		      });
+
+    /* Overlapping ranges are unusual, but possible.  If there are any,
+       fall back to scanning all the entries, to keep table order.  */
+    m_overlap = false;
+    for (size_t i = 1; i < m_entries.size () && !m_overlap; i++)
+      if (m_entries[i].start < m_entries[i - 1].end)
+	m_overlap = true;
+  }
+
+  /* Return the index of the first table entry whose range contains
+     ADDR, or -1 if there is none.  */
+  ssize_t find (CORE_ADDR addr) const
+  {
+    if (m_overlap)
+      {
+	ssize_t found = -1;
+	for (const entry &e : m_entries)
+	  if (e.start <= addr && addr < e.end
+	      && (found == -1 || e.index < (size_t) found))
+	    found = e.index;
+	return found;
+      }
+
+    auto it = std::upper_bound (m_entries.begin (), m_entries.end (), addr,
+				[] (CORE_ADDR a, const entry &e)
+				{
+				  return a < e.start;
+				});
+    if (it == m_entries.begin ())
+      return -1;
+    --it;
+    if (addr < it->end)
+      return it->index;
+    return -1;
+  }
+
+private:
+  struct entry
+  {
+    CORE_ADDR start;
+    CORE_ADDR end;
+    size_t index;
+  };
+
+  /* The entries, sorted by start address.  */
+  std::vector<entry> m_entries;
+
+  /* True if some of the ranges overlap.  */
+  bool m_overlap = false;
+};
+
+/* A file that was mapped into the inferior when the core file was
+   generated, and from which the contents of its mappings are read.  */
+
+struct core_mapped_file
+{
+  core_mapped_file (const std::string &note_filename_,
+		    std::string &&filename_)
+    : note_filename (note_filename_),
+      filename (std::move (filename_))
+  {}
+
+  /* The name of the file in the mappings note.  */
+  std::string note_filename;
+
+  /* The name of the file on disk, after sysroot expansion.  */
+  std::string filename;
+
+  /* The file, opened with the "binary" BFD target, or nullptr if it has
+     not been opened (yet).  */
+  gdb_bfd_ref_ptr abfd;
+
+  /* True if we tried to open the file, successfully or not.  Files
+     without a build-id are only opened when their contents are first
+     needed.  */
+  bool open_attempted = false;
+
+  /* The indexes of the mappings of this file in
+     core_target::m_core_file_mappings.  */
+  std::vector<size_t> mappings;
+};
+
+/* A file-backed address space mapping.  */
+
+struct core_file_mapping
+{
+  core_file_mapping (CORE_ADDR start_, CORE_ADDR end_, CORE_ADDR file_ofs_,
+		     core_mapped_file *file_)
+    : start (start_),
+      end (end_),
+      file_ofs (file_ofs_),
+      file (file_)
+  {}
+
+  /* The inferior address range of the mapping.  */
+  CORE_ADDR start;
+  CORE_ADDR end;
+
+  /* The offset within FILE of the mapped content.  */
+  CORE_ADDR file_ofs;
+
+  /* The mapped file.  */
+  core_mapped_file *file;
+
+  /* The section of FILE's BFD that covers this mapping, or nullptr if
+     FILE is not open.  */
+  asection *section = nullptr;
+};
+
 class core_target final : public process_stratum_target
 {
 public:
   core_target ();
+  ~core_target () override;
 
   const target_info &info () const override
   { return core_target_info; }
@@ -293,15 +432,46 @@ class core_target final : public process_stratum_target
      targets.  */
   std::vector<target_section> m_core_section_table;
 
+  /* Indexes of the sections of m_core_section_table which have
+     contents in the core file, and of those which do not.  */
+  address_range_index m_core_contents_index;
+  address_range_index m_core_no_contents_index;
+
   /* File-backed address space mappings: some core files include
      information about memory mapped files.  */
-  std::vector<target_section> m_core_file_mappings;
+  std::vector<core_file_mapping> m_core_file_mappings;
+
+  /* The files of m_core_file_mappings.  */
+  std::vector<std::unique_ptr<core_mapped_file>> m_core_mapped_files;
+
+  /* Index of m_core_file_mappings.  */
+  address_range_index m_core_file_mappings_index;
 
   /* Unavailable mappings.  These correspond to pathnames which either
      weren't found or could not be opened.  Knowing these addresses can
      still be useful.  */
   std::vector<mem_range> m_core_unavailable_mappings;
 
+#ifdef HAVE_MMAP
+  /* The whole core file, mapped into memory to read the contents of
+     its sections, or nullptr if it could not be mapped.  */
+  const gdb_byte *m_core_map = nullptr;
+
+  /* The size of the core file when it was mapped, or when it was last
+     checked if smaller.  Reading the mapping past the end of the file
+     would raise SIGBUS.  */
+  ufile_ptr m_core_map_size = 0;
+
+  /* Set before each prompt, as the core file may have been truncated
+     since; the next read checks its size again.  */
+  bool m_core_map_size_stale = false;
+  gdb::observers::token m_before_prompt_token;
+
+  /* The arguments to munmap for m_core_map.  */
+  void *m_core_map_addr = nullptr;
+  size_t m_core_map_len = 0;
+#endif
+
   /* Data structure that holds information mapping filenames and address
      ranges to the corresponding build-ids as well as the reverse build-id
      to filename mapping.  */
@@ -311,6 +481,21 @@ class core_target final : public process_stratum_target
      constructor.  */
   void build_file_mappings ();
 
+  /* Create the sections of the mappings of FILE, which is open.  */
+  void make_mapped_file_sections (core_mapped_file &file);
+
+  /* Open FILE with the "binary" target, if that has not been tried yet,
+     and create the sections of its mappings.  */
+  void open_mapped_file (core_mapped_file &file);
+
+  /* Read or write from section P of the core file, as
+     section_xfer_memory_partial does.  */
+  enum target_xfer_status xfer_core_section (gdb_byte *readbuf,
+					     const gdb_byte *writebuf,
+					     ULONGEST offset, ULONGEST len,
+					     ULONGEST *xfered_len,
+					     const target_section &p);
+
   /* FIXME: kettenis/20031023: Eventually this field should
      disappear.  */
   struct gdbarch *m_core_gdbarch = NULL;
@@ -347,16 +532,84 @@ core_target::core_target ()
   /* Find the data section */
   m_core_section_table = build_section_table (current_program_space->core_bfd ());
 
+  for (size_t i = 0; i < m_core_section_table.size (); i++)
+    {
+      const target_section &p = m_core_section_table[i];
+
+      if ((p.the_bfd_section->flags & SEC_HAS_CONTENTS) != 0)
+	m_core_contents_index.add (p.addr, p.endaddr, i);
+      else
+	m_core_no_contents_index.add (p.addr, p.endaddr, i);
+    }
+  m_core_contents_index.finish ();
+  m_core_no_contents_index.finish ();
+
   build_file_mappings ();
+
+#ifdef HAVE_MMAP
+  /* Map the whole core file, so that reading memory from it is just a
+     copy.  The sections of ELF core files are plain ranges of the
+     file, so this is only done for those.  */
+  bfd *cbfd = current_program_space->core_bfd ();
+  ufile_ptr size = bfd_get_file_size (cbfd);
+  if (bfd_get_flavour (cbfd) == bfd_target_elf_flavour
+      && size > 0 && size <= SIZE_MAX)
+    {
+      void *data = bfd_mmap (cbfd, nullptr, size, PROT_READ, MAP_PRIVATE, 0,
+			     &m_core_map_addr, &m_core_map_len);
+      if (data != MAP_FAILED)
+	{
+	  m_core_map = (const gdb_byte *) data;
+	  m_core_map_size = size;
+	  gdb::observers::before_prompt.attach
+	    ([this] (const char *)
+	     {
+	       m_core_map_size_stale = true;
+	     },
+	     m_before_prompt_token, "corelow");
+	}
+    }
+#endif
+}
+
+core_target::~core_target ()
+{
+#ifdef HAVE_MMAP
+  if (m_core_map != nullptr)
+    {
+      gdb::observers::before_prompt.detach (m_before_prompt_token);
+      munmap (m_core_map_addr, m_core_map_len);
+    }
+#endif
+}
+
+/* Warn that the file named FILENAME in the file-backed mappings note
+   can't be opened.  EXPANDED_FILENAME is the name it was expanded to
+   on disk, or NULL if it wasn't found.  */
+
+static void
+warn_cant_open_mapped_file (const std::string &filename,
+			    const char *expanded_filename)
+{
+  if (expanded_filename == nullptr || filename == expanded_filename)
+    warning (_("Can't open file %ps during file-backed mapping "
+	       "note processing"),
+	     styled_string (file_name_style.style (), filename.c_str ()));
+  else
+    warning (_("Can't open file %ps which was expanded to %ps "
+	       "during file-backed mapping note processing"),
+	     styled_string (file_name_style.style (), filename.c_str ()),
+	     styled_string (file_name_style.style (), expanded_filename));
 }
 
 /* Construct the table for file-backed mappings if they exist.
 
    For each unique path in the note, we'll open a BFD with a bfd
-   target of "binary".  This is an unstructured bfd target upon which
-   we'll impose a structure from the mappings in the architecture-specific
-   mappings note.  A BFD section is allocated and initialized for each
-   file-backed mapping.
+   target of "binary" -- right away if the file has a build-id to check,
+   otherwise only when its contents are first needed.  This is an
+   unstructured bfd target upon which we'll impose a structure from the
+   mappings in the architecture-specific mappings note.  A BFD section
+   is allocated and initialized for each file-backed mapping.
 
    We take care to not share already open bfds with other parts of
    GDB; in particular, we don't want to add new sections to existing
@@ -448,6 +701,24 @@ core_target::build_file_mappings ()
 	  }
       });
 
+  /* Record the file named NOTE_FILENAME in the note and FILENAME on
+     disk, and the mappings of it that FILE_DATA describes.  */
+  auto add_file = [this] (const std::string &note_filename,
+			  const char *filename, const mapped_file &file_data)
+    -> core_mapped_file &
+    {
+      m_core_mapped_files.emplace_back
+	(std::make_unique<core_mapped_file> (note_filename, filename));
+      core_mapped_file &file = *m_core_mapped_files.back ();
+      for (const mapped_file::region &region : file_data.regions)
+	{
+	  file.mappings.push_back (m_core_file_mappings.size ());
+	  m_core_file_mappings.emplace_back (region.start, region.end,
+					     region.file_ofs, &file);
+	}
+      return file;
+    };
+
   /* Get the build-id of the core file.  */
   const bfd_build_id *core_build_id
     = build_id_bfd_get (current_program_space->core_bfd ());
@@ -472,6 +743,15 @@ core_target::build_file_mappings ()
       gdb::unique_xmalloc_ptr<char> expanded_fname
 	= exec_file_find (filename.c_str (), nullptr);
 
+      /* Without a build-id to check, there is no need to open the file
+	 until its contents are needed, which saves a lot of time when
+	 many files are mapped.  */
+      if (expanded_fname != nullptr && file_data.build_id == nullptr)
+	{
+	  add_file (filename, expanded_fname.get (), file_data);
+	  continue;
+	}
+
       bool build_id_mismatch = false;
       if (expanded_fname != nullptr && file_data.build_id != nullptr)
 	{
@@ -565,21 +845,7 @@ core_target::build_file_mappings ()
 					expanded_fname.get ()));
 	    }
 	  else
-	    {
-	      if (expanded_fname == nullptr
-		  || filename == expanded_fname.get ())
-		warning (_("Can't open file %ps during file-backed mapping "
-			   "note processing"),
-			 styled_string (file_name_style.style (),
-					filename.c_str ()));
-	      else
-		warning (_("Can't open file %ps which was expanded to %ps "
-			   "during file-backed mapping note processing"),
-			 styled_string (file_name_style.style (),
-					filename.c_str ()),
-			 styled_string (file_name_style.style (),
-					expanded_fname.get ()));
-	    }
+	    warn_cant_open_mapped_file (filename, expanded_fname.get ());
 	}
       else
 	{
@@ -589,24 +855,11 @@ core_target::build_file_mappings ()
 	  gdb_bfd_record_inclusion (current_program_space->core_bfd (),
 				    abfd.get ());
 
-	  /* Create sections for each mapped region.  */
-	  for (const mapped_file::region &region : file_data.regions)
-	    {
-	      /* Make new BFD section.  All sections have the same name,
-		 which is permitted by bfd_make_section_anyway().  */
-	      asection *sec = bfd_make_section_anyway (abfd.get (), "load");
-	      if (sec == nullptr)
-		error (_("Can't make section"));
-	      sec->filepos = region.file_ofs;
-	      bfd_set_section_flags (sec, SEC_READONLY | SEC_HAS_CONTENTS);
-	      bfd_set_section_size (sec, region.end - region.start);
-	      bfd_set_section_vma (sec, region.start);
-	      bfd_set_section_lma (sec, region.start);
-	      bfd_set_section_alignment (sec, 2);
-
-	      /* Set target_section fields.  */
-	      m_core_file_mappings.emplace_back (region.start, region.end, sec);
-	    }
+	  core_mapped_file &file
+	    = add_file (filename, expanded_fname.get (), file_data);
+	  file.abfd = abfd;
+	  file.open_attempted = true;
+	  make_mapped_file_sections (file);
 	}
 
       /* If this is a bfd with a build-id then record the filename,
@@ -632,9 +885,64 @@ core_target::build_file_mappings ()
 	}
     }
 
+  for (size_t i = 0; i < m_core_file_mappings.size (); i++)
+    m_core_file_mappings_index.add (m_core_file_mappings[i].start,
+				    m_core_file_mappings[i].end, i);
+  m_core_file_mappings_index.finish ();
+
   normalize_mem_ranges (&m_core_unavailable_mappings);
 }
 
+/* See the declaration.  */
+
+void
+core_target::make_mapped_file_sections (core_mapped_file &file)
+{
+  for (size_t i : file.mappings)
+    {
+      core_file_mapping &mapping = m_core_file_mappings[i];
+
+      /* Make new BFD section.  All sections have the same name, which
+	 is permitted by bfd_make_section_anyway().  */
+      asection *sec = bfd_make_section_anyway (file.abfd.get (), "load");
+      if (sec == nullptr)
+	error (_("Can't make section"));
+      sec->filepos = mapping.file_ofs;
+      bfd_set_section_flags (sec, SEC_READONLY | SEC_HAS_CONTENTS);
+      bfd_set_section_size (sec, mapping.end - mapping.start);
+      bfd_set_section_vma (sec, mapping.start);
+      bfd_set_section_lma (sec, mapping.start);
+      bfd_set_section_alignment (sec, 2);
+
+      mapping.section = sec;
+    }
+}
+
+/* See the declaration.  */
+
+void
+core_target::open_mapped_file (core_mapped_file &file)
+{
+  if (file.open_attempted)
+    return;
+  file.open_attempted = true;
+
+  struct bfd *b = bfd_openr (file.filename.c_str (), "binary");
+  gdb_bfd_ref_ptr abfd = gdb_bfd_ref_ptr::new_reference (b);
+  if (abfd == nullptr || !bfd_check_format (abfd.get (), bfd_object))
+    {
+      warn_cant_open_mapped_file (file.note_filename, file.filename.c_str ());
+      return;
+    }
+
+  /* As in build_file_mappings, ensure that the bfd will be closed when
+     core_bfd is closed.  */
+  gdb_bfd_record_inclusion (current_program_space->core_bfd (), abfd.get ());
+
+  file.abfd = std::move (abfd);
+  make_mapped_file_sections (file);
+}
+
 /* An arbitrary identifier for the core inferior.  */
 #define CORELOW_PID 1
 
@@ -1413,6 +1721,44 @@ core_target::files_info ()
 }
 
 
+/* See the declaration.  */
+
+enum target_xfer_status
+core_target::xfer_core_section (gdb_byte *readbuf, const gdb_byte *writebuf,
+				ULONGEST offset, ULONGEST len,
+				ULONGEST *xfered_len, const target_section &p)
+{
+#ifdef HAVE_MMAP
+  if (readbuf != nullptr && m_core_map != nullptr)
+    {
+      len = std::min<ULONGEST> (len, p.endaddr - offset);
+      ufile_ptr pos = p.the_bfd_section->filepos + (offset - p.addr);
+
+      if (m_core_map_size_stale)
+	{
+	  struct stat st;
+	  if (bfd_stat (current_program_space->core_bfd (), &st) != 0)
+	    m_core_map_size = 0;
+	  else if ((ufile_ptr) st.st_size < m_core_map_size)
+	    m_core_map_size = st.st_size;
+	  m_core_map_size_stale = false;
+	}
+
+      /* A truncated core file does not have all the contents of its
+	 sections; let BFD report the error then.  */
+      if (pos + len <= m_core_map_size)
+	{
+	  memcpy (readbuf, m_core_map + pos, len);
+	  *xfered_len = len;
+	  return TARGET_XFER_OK;
+	}
+    }
+#endif
+
+  return section_xfer_memory_partial (readbuf, writebuf, offset, len,
+				      xfered_len, p);
+}
+
 enum target_xfer_status
 core_target::xfer_partial (enum target_object object, const char *annex,
 			   gdb_byte *readbuf, const gdb_byte *writebuf,
@@ -1427,28 +1773,50 @@ core_target::xfer_partial (enum target_object object, const char *annex,
 	/* Try accessing memory contents from core file data,
 	   restricting consideration to those sections for which
 	   the BFD section flag SEC_HAS_CONTENTS is set.  */
-	auto has_contents_cb = [] (const struct target_section *s)
+	ssize_t idx = m_core_contents_index.find (offset);
+	if (idx >= 0)
 	  {
-	    return ((s->the_bfd_section->flags & SEC_HAS_CONTENTS) != 0);
-	  };
-	xfer_status = section_table_xfer_memory_partial
-			(readbuf, writebuf,
-			 offset, len, xfered_len,
-			 m_core_section_table,
-			 has_contents_cb);
-	if (xfer_status == TARGET_XFER_OK)
-	  return TARGET_XFER_OK;
+	    xfer_status = xfer_core_section (readbuf, writebuf, offset, len,
+					     xfered_len,
+					     m_core_section_table[idx]);
+	    if (xfer_status == TARGET_XFER_OK)
+	      return TARGET_XFER_OK;
+	  }
 
 	/* Check file backed mappings.  If they're available, use core file
 	   provided mappings (e.g. from .note.linuxcore.file or the like)
 	   as this should provide a more accurate result.  */
-	if (!m_core_file_mappings.empty ())
+	idx = m_core_file_mappings_index.find (offset);
+	if (idx >= 0)
 	  {
-	    xfer_status = section_table_xfer_memory_partial
-			    (readbuf, writebuf, offset, len, xfered_len,
-			     m_core_file_mappings);
-	    if (xfer_status == TARGET_XFER_OK)
-	      return xfer_status;
+	    const core_file_mapping &mapping = m_core_file_mappings[idx];
+
+	    open_mapped_file (*mapping.file);
+	    if (mapping.section != nullptr)
+	      {
+		target_section p (mapping.start, mapping.end,
+				  mapping.section);
+		xfer_status = section_xfer_memory_partial (readbuf, writebuf,
+							   offset, len,
+							   xfered_len, p);
+		if (xfer_status == TARGET_XFER_OK)
+		  return xfer_status;
+	      }
+	    else
+	      {
+		/* The file could not be opened, so this is an unavailable
+		   mapping, see below.  */
+		len = std::min<ULONGEST> (len, mapping.end - offset);
+		xfer_status
+		  = this->beneath ()->xfer_partial (TARGET_OBJECT_MEMORY,
+						    nullptr, readbuf,
+						    writebuf, offset,
+						    len, xfered_len);
+		if (xfer_status == TARGET_XFER_OK)
+		  return TARGET_XFER_OK;
+
+		return TARGET_XFER_E_IO;
+	      }
 	  }
 
 	/* If the access is within an unavailable file mapping then we try
@@ -1466,8 +1834,16 @@ core_target::xfer_partial (enum target_object object, const char *annex,
 
 	   If that fails, but the access is within an unavailable region,
 	   then the access itself should fail.  */
-	for (const auto &mr : m_core_unavailable_mappings)
+	auto mr_it = std::upper_bound (m_core_unavailable_mappings.begin (),
+				       m_core_unavailable_mappings.end (),
+				       offset,
+				       [] (CORE_ADDR addr, const mem_range &r)
+				       {
+					 return addr < r.start;
+				       });
+	if (mr_it != m_core_unavailable_mappings.begin ())
 	  {
+	    const mem_range &mr = *std::prev (mr_it);
 	    if (mr.contains (offset))
 	      {
 		if (!mr.contains (offset + len))
@@ -1508,17 +1884,12 @@ core_target::xfer_partial (enum target_object object, const char *annex,
 
 	/* Finally, attempt to access data in core file sections with
 	   no contents.  These will typically read as all zero.  */
-	auto no_contents_cb = [&] (const struct target_section *s)
-	  {
-	    return !has_contents_cb (s);
-	  };
-	xfer_status = section_table_xfer_memory_partial
-			(readbuf, writebuf,
-			 offset, len, xfered_len,
-			 m_core_section_table,
-			 no_contents_cb);
-
-	return xfer_status;
+	idx = m_core_no_contents_index.find (offset);
+	if (idx < 0)
+	  return TARGET_XFER_EOF;
+	return section_xfer_memory_partial (readbuf, writebuf, offset, len,
+					    xfered_len,
+					    m_core_section_table[idx]);
       }
     case TARGET_OBJECT_AUXV:
       if (readbuf)
@@ -1913,12 +2284,12 @@ core_target::info_proc_mappings (struct gdbarch *gdbarch)
   current_uiout->table_header (0, ui_left, "objfile", "File");
   current_uiout->table_body ();
 
-  for (const target_section &tsp : m_core_file_mappings)
+  for (const core_file_mapping &mapping : m_core_file_mappings)
     {
-      ULONGEST start = tsp.addr;
-      ULONGEST end = tsp.endaddr;
-      ULONGEST file_ofs = tsp.the_bfd_section->filepos;
-      const char *filename = bfd_get_filename (tsp.the_bfd_section->owner);
+      ULONGEST start = mapping.start;
+      ULONGEST end = mapping.end;
+      ULONGEST file_ofs = mapping.file_ofs;
+      const char *filename = mapping.file->filename.c_str ();
 
       ui_out_emit_tuple tuple_emitter (current_uiout, nullptr);
       current_uiout->field_core_addr ("start", gdbarch, start);
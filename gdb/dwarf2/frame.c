@@ -39,12 +39,17 @@
 #include "dwarf2/public.h"
 #include "dwarf2/loc.h"
 #include "dwarf2/frame-tailcall.h"
+#include "cli/cli-cmds.h"
 #include "gdbsupport/gdb_binary_search.h"
+#include "gdbsupport/parallel-for.h"
 #if GDB_SELF_TEST
 #include "gdbsupport/selftest.h"
 #include "selftest-arch.h"
 #endif
 #include <unordered_map>
+#include <map>
+#include <atomic>
+#include <mutex>
 
 #include <algorithm>
 
@@ -246,13 +251,15 @@ execute_stack_op (const gdb_byte *exp, ULONGEST len, int addr_size,
 
 /* Execute FDE program from INSN_PTR possibly up to INSN_END or up to inferior
    PC.  Modify FS state accordingly.  Return current INSN_PTR where the
-   execution has stopped, one can resume it on the next call.  */
+   execution has stopped, one can resume it on the next call.  If ROW_START
+   is not NULL, store in it the location at which the last instruction was
+   executed; the state FS describes applies from there on.  */
 
 static const gdb_byte *
 execute_cfa_program (struct dwarf2_fde *fde, const gdb_byte *insn_ptr,
 		     const gdb_byte *insn_end, struct gdbarch *gdbarch,
 		     CORE_ADDR pc, struct dwarf2_frame_state *fs,
-		     CORE_ADDR text_offset)
+		     CORE_ADDR text_offset, CORE_ADDR *row_start = nullptr)
 {
   int eh_frame_p = fde->eh_frame_p;
   unsigned int bytes_read;
@@ -260,6 +267,9 @@ execute_cfa_program (struct dwarf2_fde *fde, const gdb_byte *insn_ptr,
 
   while (insn_ptr < insn_end && fs->pc <= pc)
     {
+      if (row_start != nullptr)
+	*row_start = fs->pc;
+
       gdb_byte insn = *insn_ptr++;
       uint64_t utmp, reg;
       int64_t offset;
@@ -768,6 +778,165 @@ dwarf2_frame_find_quirks (struct dwarf2_frame_state *fs,
 }
 
 
+/* A row of the table that the CFI of an FDE describes: the rules for
+   finding the CFA and the registers of the caller, from START up to
+   END.  */
+
+struct dwarf2_frame_row
+{
+  /* The range of addresses the rules apply to.  */
+  unrelocated_addr start;
+  unrelocated_addr end;
+
+  /* The architecture the CFI was decoded for.  */
+  struct gdbarch *gdbarch;
+
+  /* The rules, after executing the CIE and FDE programs.  */
+  struct dwarf2_frame_state_reg_info regs;
+
+  /* The return address column of the CIE.  */
+  ULONGEST retaddr_column;
+
+  /* See dwarf2_frame_state.  */
+  bool armcc_cfa_offsets_reversed;
+};
+
+/* The rows of the CFI tables of an objfile that have been decoded so
+   far.  Unwinding a frame means executing the CIE and FDE programs
+   from the start up to the frame's PC; with the cache, that is only
+   done once for all the frames, of all the threads, that stop in the
+   same row.  The cache is kept on the objfile, so that it goes away
+   when the objfile's symbols are reread.  */
+
+struct dwarf2_frame_row_cache
+{
+  /* The decoded rows of each FDE, by start address.  */
+  std::unordered_map<const dwarf2_fde *,
+		     std::map<unrelocated_addr, dwarf2_frame_row>> rows;
+
+  /* Usage statistics.  */
+  unsigned int n_rows = 0;
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+};
+
+static const registry<objfile>::key<dwarf2_frame_row_cache>
+  dwarf2_frame_row_cache_data;
+
+/* Return the row of the table described by FDE, which comes from
+   PER_OBJFILE, that applies to PC.  Decode it for GDBARCH if it isn't
+   in the cache yet.  */
+
+static const dwarf2_frame_row &
+dwarf2_frame_find_row (struct gdbarch *gdbarch, struct dwarf2_fde *fde,
+		       dwarf2_per_objfile *per_objfile, CORE_ADDR pc)
+{
+  struct objfile *objfile = per_objfile->objfile;
+  CORE_ADDR text_offset = objfile->text_section_offset ();
+  unrelocated_addr seek_pc = (unrelocated_addr) (pc - text_offset);
+
+  dwarf2_frame_row_cache *cache = dwarf2_frame_row_cache_data.get (objfile);
+  if (cache == nullptr)
+    cache = dwarf2_frame_row_cache_data.emplace (objfile);
+
+  std::map<unrelocated_addr, dwarf2_frame_row> &rows = cache->rows[fde];
+  auto it = rows.upper_bound (seek_pc);
+  if (it != rows.begin ())
+    {
+      --it;
+      if (seek_pc < it->second.end && it->second.gdbarch == gdbarch)
+	{
+	  cache->hits++;
+	  return it->second;
+	}
+    }
+  cache->misses++;
+
+  dwarf2_frame_state fs ((CORE_ADDR) fde->initial_location + text_offset,
+			 fde->cie);
+
+  /* Check for "quirks" - known bugs in producers.  */
+  dwarf2_frame_find_quirks (&fs, fde);
+
+  /* First decode all the insns in the CIE.  */
+  CORE_ADDR row_start = fs.pc;
+  execute_cfa_program (fde, fde->cie->initial_instructions,
+		       fde->cie->end, gdbarch, pc, &fs, text_offset,
+		       &row_start);
+
+  /* Save the initialized register set.  */
+  fs.initial = fs.regs;
+
+  /* Then decode the insns in the FDE up to our target PC.  */
+  execute_cfa_program (fde, fde->instructions, fde->end, gdbarch, pc, &fs,
+		       text_offset, &row_start);
+
+  dwarf2_frame_row row;
+  row.gdbarch = gdbarch;
+  row.retaddr_column = fs.retaddr_column;
+  row.armcc_cfa_offsets_reversed = fs.armcc_cfa_offsets_reversed;
+
+  /* If the execution stopped at an advance past PC, the row ends
+     there; otherwise it extends to the end of the FDE.  */
+  row.start = (unrelocated_addr) (row_start - text_offset);
+  if (fs.pc > pc)
+    row.end = (unrelocated_addr) (fs.pc - text_offset);
+  else
+    row.end = fde->end_addr ();
+
+  /* A DW_CFA_set_loc going backwards can leave us with a range that
+     doesn't contain PC.  Only trust the rules for PC itself then.  */
+  if (seek_pc < row.start || row.end <= seek_pc)
+    {
+      row.start = seek_pc;
+      row.end = (unrelocated_addr) ((ULONGEST) seek_pc + 1);
+    }
+
+  row.regs = std::move (fs.regs);
+
+  /* Any state remembered by the FDE program is of no further use.  */
+  delete row.regs.prev;
+  row.regs.prev = nullptr;
+
+  auto inserted = rows.insert_or_assign (row.start, std::move (row));
+  if (inserted.second)
+    cache->n_rows++;
+  return inserted.first->second;
+}
+
+/* The "maint print dwarf-cfi-cache-statistics" command.  */
+
+static void
+maintenance_print_dwarf_cfi_cache_statistics (const char *args, int from_tty)
+{
+  for (struct program_space *pspace : program_spaces)
+    for (objfile *objfile : pspace->objfiles ())
+      {
+	dwarf2_frame_row_cache *cache
+	  = dwarf2_frame_row_cache_data.get (objfile);
+
+	if (cache == nullptr)
+	  continue;
+
+	gdb_printf (_("DWARF CFI row cache statistics for pspace %d\n%s:\n"),
+		    pspace->num, objfile_name (objfile));
+	gdb_printf ("  rows:   %u\n", cache->n_rows);
+	gdb_printf ("  hits:   %u\n", cache->hits);
+	gdb_printf ("  misses: %u\n", cache->misses);
+      }
+}
+
+/* The "maint flush dwarf-cfi-cache" command.  */
+
+static void
+maintenance_flush_dwarf_cfi_cache (const char *args, int from_tty)
+{
+  for (struct program_space *pspace : program_spaces)
+    for (objfile *objfile : pspace->objfiles ())
+      dwarf2_frame_row_cache_data.clear (objfile);
+}
+
+
 /* See dwarf2/frame.h.  */
 
 int
@@ -789,42 +958,29 @@ dwarf2_fetch_cfa_info (struct gdbarch *gdbarch, CORE_ADDR pc,
 
   gdb_assert (per_objfile != nullptr);
 
-  dwarf2_frame_state fs (pc1, fde->cie);
-
-  /* Check for "quirks" - known bugs in producers.  */
-  dwarf2_frame_find_quirks (&fs, fde);
-
-  /* First decode all the insns in the CIE.  */
-  execute_cfa_program (fde, fde->cie->initial_instructions,
-		       fde->cie->end, gdbarch, pc, &fs,
-		       per_objfile->objfile->text_section_offset ());
-
-  /* Save the initialized register set.  */
-  fs.initial = fs.regs;
-
-  /* Then decode the insns in the FDE up to our target PC.  */
-  execute_cfa_program (fde, fde->instructions, fde->end, gdbarch, pc, &fs,
-		       per_objfile->objfile->text_section_offset ());
+  /* Find the rules at our target PC.  */
+  const dwarf2_frame_row &row
+    = dwarf2_frame_find_row (gdbarch, fde, per_objfile, pc);
 
   /* Calculate the CFA.  */
-  switch (fs.regs.cfa_how)
+  switch (row.regs.cfa_how)
     {
     case CFA_REG_OFFSET:
       {
-	int regnum = dwarf_reg_to_regnum_or_error (gdbarch, fs.regs.cfa_reg);
+	int regnum = dwarf_reg_to_regnum_or_error (gdbarch, row.regs.cfa_reg);
 
 	*regnum_out = regnum;
-	if (fs.armcc_cfa_offsets_reversed)
-	  *offset_out = -fs.regs.cfa_offset;
+	if (row.armcc_cfa_offsets_reversed)
+	  *offset_out = -row.regs.cfa_offset;
 	else
-	  *offset_out = fs.regs.cfa_offset;
+	  *offset_out = row.regs.cfa_offset;
 	return 1;
       }
 
     case CFA_EXP:
       *text_offset_out = per_objfile->objfile->text_section_offset ();
-      *cfa_start_out = fs.regs.cfa_exp;
-      *cfa_end_out = fs.regs.cfa_exp + fs.regs.cfa_exp_len;
+      *cfa_start_out = row.regs.cfa_exp;
+      *cfa_end_out = row.regs.cfa_exp + row.regs.cfa_exp_len;
       return 0;
 
     default:
@@ -892,7 +1048,6 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
   struct dwarf2_frame_cache *cache;
   struct dwarf2_fde *fde;
   CORE_ADDR entry_pc;
-  const gdb_byte *instr;
 
   if (*this_cache)
     return (struct dwarf2_frame_cache *) *this_cache;
@@ -926,23 +1081,8 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
 
   CORE_ADDR text_offset = cache->per_objfile->objfile->text_section_offset ();
 
-  /* Allocate and initialize the frame state.  */
-  struct dwarf2_frame_state fs (pc1, fde->cie);
-
   cache->addr_size = fde->cie->addr_size;
 
-  /* Check for "quirks" - known bugs in producers.  */
-  dwarf2_frame_find_quirks (&fs, fde);
-
-  /* First decode all the insns in the CIE.  */
-  execute_cfa_program (fde, fde->cie->initial_instructions,
-		       fde->cie->end, gdbarch,
-		       get_frame_address_in_block (this_frame), &fs,
-		       text_offset);
-
-  /* Save the initialized register set.  */
-  fs.initial = fs.regs;
-
   /* Fetching the entry pc for THIS_FRAME won't necessarily result
      in an address that's within the range of FDE locations.  This
      is due to the possibility of the function occupying non-contiguous
@@ -953,42 +1093,40 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
       && fde->initial_location <= (unrelocated_addr) (entry_pc - text_offset)
       && (unrelocated_addr) (entry_pc - text_offset) < fde->end_addr ())
     {
-      /* Decode the insns in the FDE up to the entry PC.  */
-      instr = execute_cfa_program (fde, fde->instructions, fde->end, gdbarch,
-				   entry_pc, &fs, text_offset);
+      /* Find the rules at the entry PC.  */
+      const dwarf2_frame_row &entry_row
+	= dwarf2_frame_find_row (gdbarch, fde, cache->per_objfile, entry_pc);
 
-      if (fs.regs.cfa_how == CFA_REG_OFFSET
-	  && (dwarf_reg_to_regnum (gdbarch, fs.regs.cfa_reg)
+      if (entry_row.regs.cfa_how == CFA_REG_OFFSET
+	  && (dwarf_reg_to_regnum (gdbarch, entry_row.regs.cfa_reg)
 	      == gdbarch_sp_regnum (gdbarch)))
 	{
-	  entry_cfa_sp_offset = fs.regs.cfa_offset;
+	  entry_cfa_sp_offset = entry_row.regs.cfa_offset;
 	  entry_cfa_sp_offset_p = 1;
 	}
     }
-  else
-    instr = fde->instructions;
 
-  /* Then decode the insns in the FDE up to our target PC.  */
-  execute_cfa_program (fde, instr, fde->end, gdbarch,
-		       get_frame_address_in_block (this_frame), &fs,
-		       text_offset);
+  /* Then find the rules at our target PC.  */
+  const dwarf2_frame_row &row
+    = dwarf2_frame_find_row (gdbarch, fde, cache->per_objfile,
+			     get_frame_address_in_block (this_frame));
 
   try
     {
       /* Calculate the CFA.  */
-      switch (fs.regs.cfa_how)
+      switch (row.regs.cfa_how)
 	{
 	case CFA_REG_OFFSET:
-	  cache->cfa = read_addr_from_reg (this_frame, fs.regs.cfa_reg);
-	  if (fs.armcc_cfa_offsets_reversed)
-	    cache->cfa -= fs.regs.cfa_offset;
+	  cache->cfa = read_addr_from_reg (this_frame, row.regs.cfa_reg);
+	  if (row.armcc_cfa_offsets_reversed)
+	    cache->cfa -= row.regs.cfa_offset;
 	  else
-	    cache->cfa += fs.regs.cfa_offset;
+	    cache->cfa += row.regs.cfa_offset;
 	  break;
 
 	case CFA_EXP:
 	  cache->cfa =
-	    execute_stack_op (fs.regs.cfa_exp, fs.regs.cfa_exp_len,
+	    execute_stack_op (row.regs.cfa_exp, row.regs.cfa_exp_len,
 			      cache->addr_size, this_frame, 0, 0,
 			      cache->per_objfile);
 	  break;
@@ -1023,7 +1161,7 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
   {
     int column;		/* CFI speak for "register number".  */
 
-    for (column = 0; column < fs.regs.reg.size (); column++)
+    for (column = 0; column < row.regs.reg.size (); column++)
       {
 	/* Use the GDB register number as the destination index.  */
 	int regnum = dwarf_reg_to_regnum (gdbarch, column);
@@ -1043,16 +1181,18 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
 	   problems when a debug info register falls outside of the
 	   table.  We need a way of iterating through all the valid
 	   DWARF2 register numbers.  */
-	if (fs.regs.reg[column].how == DWARF2_FRAME_REG_UNSPECIFIED)
+	if (row.regs.reg[column].how == DWARF2_FRAME_REG_UNSPECIFIED)
 	  {
 	    if (cache->reg[regnum].how == DWARF2_FRAME_REG_UNSPECIFIED)
 	      complaint (_("\
-incomplete CFI data; unspecified registers (e.g., %s) at %s"),
+incomplete CFI data; unspecified registers (e.g., %s) \
+in the row starting at %s"),
 			 gdbarch_register_name (gdbarch, regnum),
-			 paddress (gdbarch, fs.pc));
+			 paddress (gdbarch,
+				   (CORE_ADDR) row.start + text_offset));
 	  }
 	else
-	  cache->reg[regnum] = fs.regs.reg[column];
+	  cache->reg[regnum] = row.regs.reg[column];
       }
   }
 
@@ -1067,8 +1207,8 @@ incomplete CFI data; unspecified registers (e.g., %s) at %s"),
 	    || cache->reg[regnum].how == DWARF2_FRAME_REG_RA_OFFSET)
 	  {
 	    const std::vector<struct dwarf2_frame_state_reg> &regs
-	      = fs.regs.reg;
-	    ULONGEST retaddr_column = fs.retaddr_column;
+	      = row.regs.reg;
+	    ULONGEST retaddr_column = row.retaddr_column;
 
 	    /* It seems rather bizarre to specify an "empty" column as
 	       the return address column.  However, this is exactly
@@ -1077,7 +1217,7 @@ incomplete CFI data; unspecified registers (e.g., %s) at %s"),
 	       register corresponding to the return address column.
 	       Incidentally, that's how we should treat a return
 	       address column specifying "same value" too.  */
-	    if (fs.retaddr_column < fs.regs.reg.size ()
+	    if (row.retaddr_column < row.regs.reg.size ()
 		&& regs[retaddr_column].how != DWARF2_FRAME_REG_UNSPECIFIED
 		&& regs[retaddr_column].how != DWARF2_FRAME_REG_SAME_VALUE)
 	      {
@@ -1090,12 +1230,12 @@ incomplete CFI data; unspecified registers (e.g., %s) at %s"),
 	      {
 		if (cache->reg[regnum].how == DWARF2_FRAME_REG_RA)
 		  {
-		    cache->reg[regnum].loc.reg = fs.retaddr_column;
+		    cache->reg[regnum].loc.reg = row.retaddr_column;
 		    cache->reg[regnum].how = DWARF2_FRAME_REG_SAVED_REG;
 		  }
 		else
 		  {
-		    cache->retaddr_reg.loc.reg = fs.retaddr_column;
+		    cache->retaddr_reg.loc.reg = row.retaddr_column;
 		    cache->retaddr_reg.how = DWARF2_FRAME_REG_SAVED_REG;
 		  }
 	      }
@@ -1103,8 +1243,8 @@ incomplete CFI data; unspecified registers (e.g., %s) at %s"),
       }
   }
 
-  if (fs.retaddr_column < fs.regs.reg.size ()
-      && fs.regs.reg[fs.retaddr_column].how == DWARF2_FRAME_REG_UNDEFINED)
+  if (row.retaddr_column < row.regs.reg.size ()
+      && row.regs.reg[row.retaddr_column].how == DWARF2_FRAME_REG_UNDEFINED)
     cache->undefined_retaddr = 1;
 
   dwarf2_tailcall_sniffer_first (this_frame, &cache->tailcall_cache,
@@ -1615,18 +1755,24 @@ set_comp_unit (struct objfile *objfile, struct comp_unit *unit)
 }
 
 /* Find the FDE for *PC.  Return a pointer to the FDE, and store the
-   initial location associated with it into *PC.  */
+   initial location associated with it into *PC.
+
+   If *PC is in a section of an objfile, the FDEs of that objfile and
+   of its separate debug objfiles are searched first, so that the FDE
+   tables of the other objfiles, which take a while to build for big
+   objfiles, are left alone when they are not needed.  Only if none is
+   found there, or if *PC is in no section, is every other objfile
+   searched, in order.  */
 
 static struct dwarf2_fde *
 dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
 {
-  for (objfile *objfile : current_program_space->objfiles ())
+  /* Search OBJFILE for the FDE covering *PC, reading its frame
+     sections first if needed.  */
+  auto search = [&] (objfile *objfile) -> dwarf2_fde *
     {
       CORE_ADDR offset;
 
-      if (objfile->obfd == nullptr)
-	continue;
-
       comp_unit *unit = find_comp_unit (objfile);
       if (unit == NULL)
 	{
@@ -1637,7 +1783,7 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
 
       dwarf2_fde_table *fde_table = &unit->fde_table;
       if (fde_table->empty ())
-	continue;
+	return nullptr;
 
       gdb_assert (!objfile->section_offsets.empty ());
       offset = objfile->text_section_offset ();
@@ -1645,19 +1791,58 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
       gdb_assert (!fde_table->empty ());
       unrelocated_addr seek_pc = (unrelocated_addr) (*pc - offset);
       if (seek_pc < (*fde_table)[0]->initial_location)
-	continue;
+	return nullptr;
 
       auto it = gdb::binary_search (fde_table->begin (), fde_table->end (),
 				    seek_pc, bsearch_fde_cmp);
-      if (it != fde_table->end ())
-	{
-	  *pc = (CORE_ADDR) (*it)->initial_location + offset;
-	  if (out_per_objfile != nullptr)
-	    *out_per_objfile = get_dwarf2_per_objfile (objfile);
+      if (it == fde_table->end ())
+	return nullptr;
 
-	  return *it;
-	}
+      *pc = (CORE_ADDR) (*it)->initial_location + offset;
+      if (out_per_objfile != nullptr)
+	*out_per_objfile = get_dwarf2_per_objfile (objfile);
+      return *it;
+    };
+
+  struct obj_section *pc_section = find_pc_section (*pc);
+  struct objfile *pc_objfile = nullptr;
+  if (pc_section != nullptr)
+    {
+      pc_objfile = pc_section->objfile;
+      if (pc_objfile->separate_debug_objfile_backlink != nullptr)
+	pc_objfile = pc_objfile->separate_debug_objfile_backlink;
+    }
+
+  auto related_p = [&] (objfile *objfile)
+    {
+      return (pc_objfile == nullptr
+	      || objfile == pc_objfile
+	      || objfile->separate_debug_objfile_backlink == pc_objfile);
+    };
+
+  for (objfile *objfile : current_program_space->objfiles ())
+    {
+      if (objfile->obfd == nullptr || !related_p (objfile))
+	continue;
+
+      dwarf2_fde *fde = search (objfile);
+      if (fde != nullptr)
+	return fde;
     }
+
+  /* The CFI may come from an objfile not linked to the one containing
+     *PC, such as one loaded with add-symbol-file or by a JIT reader.  */
+  if (pc_objfile != nullptr)
+    for (objfile *objfile : current_program_space->objfiles ())
+      {
+	if (objfile->obfd == nullptr || related_p (objfile))
+	  continue;
+
+	dwarf2_fde *fde = search (objfile);
+	if (fde != nullptr)
+	  return fde;
+      }
+
   return NULL;
 }
 
@@ -1695,6 +1880,71 @@ static const gdb_byte *decode_frame_entry (struct gdbarch *gdbarch,
 /* Decode the next CIE or FDE, entry_type specifies the expected type.
    Return NULL if invalid input, otherwise the next byte to be processed.  */
 
+/* Decode the body of an FDE, from BUF, just past the CIE pointer, up to
+   END, into FDE.  FDE->cie must be set already.  Return END, or NULL
+   if the FDE is corrupt.  The addresses are left as they are encoded,
+   for adjust_fde_addresses.  This doesn't touch anything but FDE, so
+   it can be called for several FDEs at the same time.  */
+
+static const gdb_byte *
+decode_fde (struct comp_unit *unit, struct dwarf2_fde *fde,
+	    const gdb_byte *buf, const gdb_byte *end, int eh_frame_p)
+{
+  unsigned int bytes_read;
+
+  fde->initial_location
+    = (unrelocated_addr) read_encoded_value (unit, fde->cie->encoding,
+					     fde->cie->ptr_size, buf,
+					     &bytes_read,
+					     (unrelocated_addr) 0);
+  buf += bytes_read;
+
+  fde->address_range
+    = read_encoded_value (unit, fde->cie->encoding & 0x0f,
+			  fde->cie->ptr_size, buf, &bytes_read,
+			  (unrelocated_addr) 0);
+  buf += bytes_read;
+
+  /* A 'z' augmentation in the CIE implies the presence of an
+     augmentation field in the FDE as well.  The only thing known
+     to be in here at present is the LSDA entry for EH.  So we
+     can skip the whole thing.  */
+  if (fde->cie->saw_z_augmentation)
+    {
+      uint64_t uleb_length;
+
+      buf = gdb_read_uleb128 (buf, end, &uleb_length);
+      if (buf == NULL)
+	return NULL;
+      buf += uleb_length;
+      if (buf > end)
+	return NULL;
+    }
+
+  fde->instructions = buf;
+  fde->end = end;
+
+  fde->eh_frame_p = eh_frame_p;
+
+  return end;
+}
+
+/* Apply gdbarch_adjust_dwarf2_addr to the addresses of FDE, as decoded
+   by decode_fde.  The hook may look up symbols, so unlike decode_fde,
+   this must only be called from the main thread.  */
+
+static void
+adjust_fde_addresses (struct gdbarch *gdbarch, struct dwarf2_fde *fde)
+{
+  ULONGEST init_addr = (ULONGEST) fde->initial_location;
+  ULONGEST addr = gdbarch_adjust_dwarf2_addr (gdbarch,
+					      init_addr + fde->address_range);
+
+  fde->initial_location
+    = (unrelocated_addr) gdbarch_adjust_dwarf2_addr (gdbarch, init_addr);
+  fde->address_range = addr - (ULONGEST) fde->initial_location;
+}
+
 static const gdb_byte *
 decode_frame_entry_1 (struct gdbarch *gdbarch,
 		      struct comp_unit *unit, const gdb_byte *start,
@@ -1955,42 +2205,10 @@ decode_frame_entry_1 (struct gdbarch *gdbarch,
 
       gdb_assert (fde->cie != NULL);
 
-      ULONGEST init_addr
-	= read_encoded_value (unit, fde->cie->encoding, fde->cie->ptr_size,
-			      buf, &bytes_read, (unrelocated_addr) 0);
-      fde->initial_location
-	= (unrelocated_addr) gdbarch_adjust_dwarf2_addr (gdbarch, init_addr);
-      buf += bytes_read;
-
-      ULONGEST range
-	= read_encoded_value (unit, fde->cie->encoding & 0x0f,
-			      fde->cie->ptr_size, buf, &bytes_read,
-			      (unrelocated_addr) 0);
-      ULONGEST addr = gdbarch_adjust_dwarf2_addr (gdbarch, init_addr + range);
-      fde->address_range = addr - (ULONGEST) fde->initial_location;
-      buf += bytes_read;
-
-      /* A 'z' augmentation in the CIE implies the presence of an
-	 augmentation field in the FDE as well.  The only thing known
-	 to be in here at present is the LSDA entry for EH.  So we
-	 can skip the whole thing.  */
-      if (fde->cie->saw_z_augmentation)
-	{
-	  uint64_t uleb_length;
-
-	  buf = gdb_read_uleb128 (buf, end, &uleb_length);
-	  if (buf == NULL)
-	    return NULL;
-	  buf += uleb_length;
-	  if (buf > end)
-	    return NULL;
-	}
-
-      fde->instructions = buf;
-      fde->end = end;
-
-      fde->eh_frame_p = eh_frame_p;
+      if (decode_fde (unit, fde, buf, end, eh_frame_p) == NULL)
+	return NULL;
 
+      adjust_fde_addresses (gdbarch, fde);
       add_fde (fde_table, fde);
     }
 
@@ -2095,6 +2313,139 @@ Corrupt data in %s:%s; align 8 workaround apparently succeeded"),
   return ret;
 }
 
+/* An FDE found by decode_frame_section, waiting to be decoded.  */
+
+struct pending_fde
+{
+  /* The start of the body of the FDE, just past the CIE pointer, and
+     its end.  */
+  const gdb_byte *buf;
+  const gdb_byte *end;
+
+  /* The offset of the FDE's CIE in the section.  */
+  ULONGEST cie_pointer;
+};
+
+/* Decode the CIEs and FDEs of the frame section of UNIT, adding the
+   FDEs to FDE_TABLE in section order, as repeated calls of
+   decode_frame_entry would.  The CIEs are few, so they are decoded
+   first, in this thread; then the FDEs are split across the worker
+   threads, and their addresses adjusted back in this thread.  Return
+   false, leaving FDE_TABLE alone, if the section has
+   anything unusual in it -- corrupt entries, or FDEs whose CIE isn't
+   one of the entries -- so that the caller can decode it entry by
+   entry instead, with all the workarounds and complaints that
+   entails.  */
+
+static bool
+decode_frame_section (struct gdbarch *gdbarch, struct comp_unit *unit,
+		      int eh_frame_p, dwarf2_cie_table &cie_table,
+		      dwarf2_fde_table *fde_table)
+{
+  const gdb_byte *section_end
+    = unit->dwarf_frame_buffer + unit->dwarf_frame_size;
+  std::vector<pending_fde> pending;
+
+  for (const gdb_byte *start = unit->dwarf_frame_buffer;
+       start < section_end;)
+    {
+      unsigned int bytes_read;
+      ULONGEST length = read_initial_length (unit->abfd, start, &bytes_read,
+					     false);
+      const gdb_byte *buf = start + bytes_read;
+      const gdb_byte *end = buf + (size_t) length;
+
+      if (length == 0)
+	{
+	  start = end;
+	  continue;
+	}
+
+      bool dwarf64_p = (bytes_read == 12);
+      size_t pointer_size = dwarf64_p ? 8 : 4;
+      if (end <= buf || end > section_end || length < pointer_size)
+	return false;
+
+      ULONGEST cie_id;
+      if (eh_frame_p)
+	cie_id = 0;
+      else if (dwarf64_p)
+	cie_id = DW64_CIE_ID;
+      else
+	cie_id = DW_CIE_ID;
+
+      ULONGEST cie_pointer = (dwarf64_p
+			      ? read_8_bytes (unit->abfd, buf)
+			      : read_4_bytes (unit->abfd, buf));
+      buf += pointer_size;
+
+      if (cie_pointer == cie_id)
+	{
+	  if (decode_frame_entry_1 (gdbarch, unit, start, eh_frame_p,
+				    cie_table, fde_table,
+				    EH_CIE_TYPE_ID) == NULL)
+	    return false;
+	}
+      else
+	{
+	  /* See decode_frame_entry_1.  */
+	  if (eh_frame_p)
+	    cie_pointer = (buf - pointer_size - unit->dwarf_frame_buffer
+			   - cie_pointer);
+	  pending.push_back ({ buf, end, cie_pointer });
+	}
+
+      start = end;
+    }
+
+  struct dwarf2_fde *fdes = XOBNEWVEC (&unit->obstack, struct dwarf2_fde,
+				       pending.size ());
+  for (size_t i = 0; i < pending.size (); i++)
+    {
+      fdes[i].cie = find_cie (cie_table, pending[i].cie_pointer);
+      if (fdes[i].cie == NULL)
+	return false;
+    }
+
+  std::atomic<bool> failed (false);
+
+  /* Arbitrarily require at least 100 FDEs in a thread.  */
+  gdb::parallel_for_each (100, fdes, fdes + pending.size (),
+    [&] (dwarf2_fde *first, dwarf2_fde *last)
+    {
+      /* Errors must not escape a worker thread; just note them, and
+	 let the caller find them again.  */
+      try
+	{
+	  for (dwarf2_fde *fde = first; fde < last; fde++)
+	    {
+	      const pending_fde &p = pending[fde - fdes];
+
+	      if (decode_fde (unit, fde, p.buf, p.end, eh_frame_p) == NULL)
+		{
+		  failed = true;
+		  return;
+		}
+	    }
+	}
+      catch (const gdb_exception &)
+	{
+	  failed = true;
+	}
+    });
+
+  if (failed)
+    return false;
+
+  for (size_t i = 0; i < pending.size (); i++)
+    {
+      adjust_fde_addresses (gdbarch, &fdes[i]);
+      add_fde (fde_table, &fdes[i]);
+    }
+
+  return true;
+}
+
 static bool
 fde_is_less_than (const dwarf2_fde *aa, const dwarf2_fde *bb)
 {
@@ -2113,6 +2464,37 @@ fde_is_less_than (const dwarf2_fde *aa, const dwarf2_fde *bb)
   return aa->initial_location < bb->initial_location;
 }
 
+/* Sort FDE_TABLE with fde_is_less_than.  Parts of the table are
+   sorted in parallel, and then merged.  */
+
+static void
+sort_fde_table (dwarf2_fde_table &fde_table)
+{
+#if CXX_STD_THREAD
+  std::mutex bounds_mutex;
+#endif
+  std::vector<size_t> bounds;
+
+  /* Arbitrarily require at least 1000 FDEs in a thread.  */
+  gdb::parallel_for_each (1000, fde_table.begin (), fde_table.end (),
+    [&] (dwarf2_fde_table::iterator first, dwarf2_fde_table::iterator last)
+    {
+      std::sort (first, last, fde_is_less_than);
+
+#if CXX_STD_THREAD
+      std::lock_guard<std::mutex> guard (bounds_mutex);
+#endif
+      bounds.push_back (last - fde_table.begin ());
+    });
+
+  std::sort (bounds.begin (), bounds.end ());
+  for (size_t i = 1; i < bounds.size (); i++)
+    std::inplace_merge (fde_table.begin (),
+			fde_table.begin () + bounds[i - 1],
+			fde_table.begin () + bounds[i],
+			fde_is_less_than);
+}
+
 void
 dwarf2_build_frame_info (struct objfile *objfile)
 {
@@ -2153,12 +2535,17 @@ dwarf2_build_frame_info (struct objfile *objfile)
 
 	  try
 	    {
-	      frame_ptr = unit->dwarf_frame_buffer;
-	      while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
-		frame_ptr = decode_frame_entry (gdbarch, unit.get (),
-						frame_ptr, 1,
-						cie_table, &fde_table,
-						EH_CIE_OR_FDE_TYPE_ID);
+	      if (!decode_frame_section (gdbarch, unit.get (), 1, cie_table,
+					 &fde_table))
+		{
+		  frame_ptr = unit->dwarf_frame_buffer;
+		  while (frame_ptr < (unit->dwarf_frame_buffer
+				      + unit->dwarf_frame_size))
+		    frame_ptr = decode_frame_entry (gdbarch, unit.get (),
+						    frame_ptr, 1,
+						    cie_table, &fde_table,
+						    EH_CIE_OR_FDE_TYPE_ID);
+		}
 	    }
 
 	  catch (const gdb_exception_error &e)
@@ -2184,11 +2571,17 @@ dwarf2_build_frame_info (struct objfile *objfile)
 
       try
 	{
-	  frame_ptr = unit->dwarf_frame_buffer;
-	  while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
-	    frame_ptr = decode_frame_entry (gdbarch, unit.get (), frame_ptr, 0,
-					    cie_table, &fde_table,
-					    EH_CIE_OR_FDE_TYPE_ID);
+	  if (!decode_frame_section (gdbarch, unit.get (), 0, cie_table,
+				     &fde_table))
+	    {
+	      frame_ptr = unit->dwarf_frame_buffer;
+	      while (frame_ptr < (unit->dwarf_frame_buffer
+				  + unit->dwarf_frame_size))
+		frame_ptr = decode_frame_entry (gdbarch, unit.get (),
+						frame_ptr, 0,
+						cie_table, &fde_table,
+						EH_CIE_OR_FDE_TYPE_ID);
+	    }
 	}
       catch (const gdb_exception_error &e)
 	{
@@ -2203,7 +2596,7 @@ dwarf2_build_frame_info (struct objfile *objfile)
   struct dwarf2_fde *first_non_zero_fde = NULL;
 
   /* Prepare FDE table for lookups.  */
-  std::sort (fde_table.begin (), fde_table.end (), fde_is_less_than);
+  sort_fde_table (fde_table);
 
   /* Check for leftovers from --gc-sections.  The GNU linker sets
      the relevant symbols to zero, but doesn't zero the FDE *end*
@@ -2252,6 +2645,16 @@ void _initialize_dwarf2_frame ();
 void
 _initialize_dwarf2_frame ()
 {
+  add_cmd ("dwarf-cfi-cache-statistics", class_maintenance,
+	   maintenance_print_dwarf_cfi_cache_statistics,
+	   _("Print DWARF CFI row cache statistics for each objfile."),
+	   &maintenanceprintlist);
+
+  add_cmd ("dwarf-cfi-cache", class_maintenance,
+	   maintenance_flush_dwarf_cfi_cache,
+	   _("Flush the DWARF CFI row cache of each objfile."),
+	   &maintenanceflushlist);
+
 #if GDB_SELF_TEST
   selftests::register_test_foreach_arch ("execute_cfa_program",
 					 selftests::execute_cfa_program_test);
@@ -819,6 +819,39 @@ section_table_read_available_memory (gdb_byte *readbuf, ULONGEST offset,
   return TARGET_XFER_UNAVAILABLE;
 }
 
+/* See exec.h.  */
+
+enum target_xfer_status
+section_xfer_memory_partial (gdb_byte *readbuf, const gdb_byte *writebuf,
+			     ULONGEST offset, ULONGEST len,
+			     ULONGEST *xfered_len, const target_section &p)
+{
+  struct bfd_section *asect = p.the_bfd_section;
+  bfd *abfd = asect->owner;
+  int res;
+
+  gdb_assert (offset >= p.addr && offset < p.endaddr);
+
+  /* If the section ends before the transfer does, just do part of
+     it.  */
+  len = std::min<ULONGEST> (len, p.endaddr - offset);
+
+  if (writebuf)
+    res = bfd_set_section_contents (abfd, asect, writebuf,
+				    offset - p.addr, len);
+  else
+    res = bfd_get_section_contents (abfd, asect, readbuf,
+				    offset - p.addr, len);
+
+  if (res != 0)
+    {
+      *xfered_len = len;
+      return TARGET_XFER_OK;
+    }
+  else
+    return TARGET_XFER_EOF;
+}
+
 enum target_xfer_status
 section_table_xfer_memory_partial (gdb_byte *readbuf, const gdb_byte *writebuf,
 				   ULONGEST offset, ULONGEST len,
@@ -827,67 +860,15 @@ section_table_xfer_memory_partial (gdb_byte *readbuf, const gdb_byte *writebuf,
 				   gdb::function_view<bool
 				     (const struct target_section *)> match_cb)
 {
-  int res;
-  ULONGEST memaddr = offset;
-  ULONGEST memend = memaddr + len;
-
   gdb_assert (len != 0);
 
   for (const target_section &p : sections)
     {
-      struct bfd_section *asect = p.the_bfd_section;
-      bfd *abfd = asect->owner;
-
       if (match_cb != nullptr && !match_cb (&p))
 	continue;		/* not the section we need.  */
-      if (memaddr >= p.addr)
-	{
-	  if (memend <= p.endaddr)
-	    {
-	      /* Entire transfer is within this section.  */
-	      if (writebuf)
-		res = bfd_set_section_contents (abfd, asect,
-						writebuf, memaddr - p.addr,
-						len);
-	      else
-		res = bfd_get_section_contents (abfd, asect,
-						readbuf, memaddr - p.addr,
-						len);
-
-	      if (res != 0)
-		{
-		  *xfered_len = len;
-		  return TARGET_XFER_OK;
-		}
-	      else
-		return TARGET_XFER_EOF;
-	    }
-	  else if (memaddr >= p.endaddr)
-	    {
-	      /* This section ends before the transfer starts.  */
-	      continue;
-	    }
-	  else
-	    {
-	      /* This section overlaps the transfer.  Just do half.  */
-	      len = p.endaddr - memaddr;
-	      if (writebuf)
-		res = bfd_set_section_contents (abfd, asect,
-						writebuf, memaddr - p.addr,
-						len);
-	      else
-		res = bfd_get_section_contents (abfd, asect,
-						readbuf, memaddr - p.addr,
-						len);
-	      if (res != 0)
-		{
-		  *xfered_len = len;
-		  return TARGET_XFER_OK;
-		}
-	      else
-		return TARGET_XFER_EOF;
-	    }
-	}
+      if (offset >= p.addr && offset < p.endaddr)
+	return section_xfer_memory_partial (readbuf, writebuf, offset, len,
+					    xfered_len, p);
     }
 
   return TARGET_XFER_EOF;		/* We can't help.  */
@@ -40,6 +40,15 @@ extern std::vector<target_section> build_section_table (struct bfd *);
 
 extern void exec_on_vfork (inferior *vfork_child);
 
+/* Read or write from the single target section P, as
+   section_table_xfer_memory_partial does, starting at address OFFSET,
+   which must be within P.  The transfer stops at the end of P.  */
+
+extern enum target_xfer_status
+  section_xfer_memory_partial (gdb_byte *, const gdb_byte *,
+			       ULONGEST, ULONGEST, ULONGEST *,
+			       const target_section &);
+
 /* Read from mappable read-only sections of BFD executable files.
    Return TARGET_XFER_OK, if read is successful.  Return
    TARGET_XFER_EOF if read is done.  Return TARGET_XFER_E_IO
@@ -1764,6 +1764,10 @@ linux_nat_target::resume (ptid_t scope_ptid, int step, enum gdb_signal signo)
 			  (signo != GDB_SIGNAL_0
 			   ? strsignal (gdb_signal_to_host (signo)) : "0"),
 			  inferior_ptid.to_string ().c_str ());
+  linux_nat_debug_printf ("%u ptrace requests for registers and siginfo "
+			  "since the last resume",
+			  linux_ptrace_stop_requests);
+  linux_ptrace_stop_requests = 0;
 
   /* Mark the lwps we're resuming as resumed and update their
      last_resume_kind to resume_continue.  */
@@ -4652,6 +4656,7 @@ bool
 linux_nat_get_siginfo (ptid_t ptid, siginfo_t *siginfo)
 {
   int pid = get_ptrace_pid (ptid);
+  linux_ptrace_stop_requests++;
   return ptrace (PTRACE_GETSIGINFO, pid, (PTRACE_TYPE_ARG3) 0, siginfo) == 0;
 }
 
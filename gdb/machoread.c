@@ -824,9 +824,6 @@ macho_symfile_read (struct objfile *objfile, symfile_add_flags symfile_flags)
 	  reader.install ();
 	}
 
-      /* Try to read .eh_frame / .debug_frame.  */
-      dwarf2_build_frame_info (objfile);
-
       /* Check for DSYM file.  */
       gdb_bfd_ref_ptr dsym_bfd (macho_check_dsym (objfile, &dsym_filename));
       if (dsym_bfd != NULL)
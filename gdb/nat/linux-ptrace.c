@@ -29,6 +29,10 @@
    of 0 means there are no supported features.  */
 static int supported_ptrace_options = -1;
 
+/* See nat/linux-ptrace.h.  */
+
+unsigned int linux_ptrace_stop_requests;
+
 /* Find all possible reasons we could fail to attach PID and return these
    as a string.  An empty string is returned if we didn't find any reason.  */
 
@@ -171,6 +171,12 @@
 # define TRAP_HWBKPT 4
 #endif
 
+/* The number of ptrace requests made to access the registers, debug
+   registers and signal information of stopped LWPs, since the native
+   target last resumed the inferior.  "set debug linux-nat" shows it
+   at each resume, to tell what handling a stop cost.  */
+extern unsigned int linux_ptrace_stop_requests;
+
 extern std::string linux_ptrace_attach_fail_reason (pid_t pid);
 
 /* Find all possible reasons we could have failed to attach to PTID
@@ -23,6 +23,7 @@
 #include "nat/x86-linux.h"
 #include "nat/x86-dregs.h"
 #include "nat/x86-linux-dregs.h"
+#include "nat/linux-ptrace.h"
 
 /* Return the offset of REGNUM in the u_debugreg field of struct
    user.  */
@@ -46,6 +47,7 @@ x86_linux_dr_get (ptid_t ptid, int regnum)
   tid = ptid.lwp ();
 
   errno = 0;
+  linux_ptrace_stop_requests++;
   value = ptrace (PTRACE_PEEKUSER, tid, u_debugreg_offset (regnum), 0);
   if (errno != 0)
     perror_with_name (_("Couldn't read debug register"));
@@ -64,6 +66,7 @@ x86_linux_dr_set (ptid_t ptid, int regnum, unsigned long value)
   tid = ptid.lwp ();
 
   errno = 0;
+  linux_ptrace_stop_requests++;
   ptrace (PTRACE_POKEUSER, tid, u_debugreg_offset (regnum), value);
   if (errno != 0)
     perror_with_name (_("Couldn't write debug register"));
@@ -71,7 +71,8 @@
 #define DEFAULT_RECORD_FULL_INSN_MAX_NUM	200000
 
 #define RECORD_FULL_IS_REPLAY \
-  (record_full_list->next || ::execution_direction == EXEC_REVERSE)
+  (record_full_list != record_full_last \
+   || ::execution_direction == EXEC_REVERSE)
 
 #define RECORD_FULL_FILE_MAGIC	netorder32(0x20091016)
 
@@ -83,65 +84,68 @@
    that indicates that this is the last struct record_full_entry of this
    instruction.
 
-   Each struct record_full_entry is linked to "record_full_list" by "prev"
-   and "next" pointers.  */
+   The entries are stored one after the other in chunks of memory; see
+   record_full_chunk.  An entry is a header, followed by its data:
+
+     record_full_reg: the value of the register, u.reg.len bytes.
+
+     record_full_mem: the address of the memory, a CORE_ADDR, then its
+     contents, u.mem.len bytes.
+
+     record_full_end: the number of the instruction, a ULONGEST.
+
+   padded to a multiple of RECORD_FULL_ENTRY_ALIGN bytes.  Use
+   record_full_get_loc, record_full_mem_addr and
+   record_full_end_insn_num to get at the data, and record_full_next
+   and record_full_prev to walk the log.  */
 
 struct record_full_mem_entry
 {
-  CORE_ADDR addr;
-  int len;
+  unsigned int len : 31;
   /* Set this flag if target memory for this entry
      can no longer be accessed.  */
-  int mem_entry_not_accessible;
-  union
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[sizeof (gdb_byte *)];
-  } u;
+  unsigned int mem_entry_not_accessible : 1;
 };
 
 struct record_full_reg_entry
 {
   unsigned short num;
   unsigned short len;
-  union 
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[2 * sizeof (gdb_byte *)];
-  } u;
 };
 
 struct record_full_end_entry
 {
   enum gdb_signal sigval;
-  ULONGEST insn_num;
 };
 
-enum record_full_type
+enum record_full_type : uint8_t
 {
   record_full_end = 0,
   record_full_reg,
-  record_full_mem
+  record_full_mem,
+
+  /* Not an entry: the marker that follows the last entry of a chunk.
+     Its data is a pointer to the chunk.  */
+  record_full_chunk_end
 };
 
 /* This is the data structure that makes up the execution log.
 
-   The execution log consists of a single linked list of entries
-   of type "struct record_full_entry".  It is doubly linked so that it
-   can be traversed in either direction.
+   The execution log is a sequence of entries of type "struct
+   record_full_entry", which can be walked in either direction.
 
-   The start of the list is anchored by a struct called
+   The start of the log is anchored by an entry called
    "record_full_first".  The pointer "record_full_list" either points
-   to the last entry that was added to the list (in record mode), or to
-   the next entry in the list that will be executed (in replay mode).
+   to the last entry that was added to the log (in record mode), or to
+   the next entry in the log that will be executed (in replay mode).
 
-   Each list element (struct record_full_entry), in addition to next
-   and prev pointers, consists of a union of three entry types: mem,
-   reg, and end.  A field called "type" determines which entry type is
-   represented by a given list element.
+   Each log element (struct record_full_entry) consists of a union of
+   three entry types: mem, reg, and end.  A field called "type"
+   determines which entry type is represented by a given log
+   element.
 
    Each instruction that is added to the execution log is represented
-   by a variable number of list elements ('entries').  The instruction
+   by a variable number of log elements ('entries').  The instruction
    will have one "reg" entry for each register that is changed by 
    executing the instruction (including the PC in every case).  It 
    will also have one "mem" entry for each memory change.  Finally,
@@ -150,8 +154,9 @@ enum record_full_type
 
 struct record_full_entry
 {
-  struct record_full_entry *prev;
-  struct record_full_entry *next;
+  /* The size of the previous entry of the same chunk, or 0 if this is
+     the first entry of its chunk.  */
+  unsigned short prev_size;
   enum record_full_type type;
   union
   {
@@ -164,6 +169,57 @@ struct record_full_entry
   } u;
 };
 
+/* The alignment of the entries, and of their data.  */
+
+#define RECORD_FULL_ENTRY_ALIGN 8
+
+static_assert (sizeof (struct record_full_entry)
+		   == RECORD_FULL_ENTRY_ALIGN);
+
+/* The log is kept in a doubly linked list of chunks, each holding
+   the entries of a contiguous part of the log, and ending with a
+   record_full_chunk_end marker.  The entries of an instruction may
+   span chunks.  Instructions are added at the end of the last chunk,
+   and, when the log is full, deleted from the start of the first one;
+   a chunk is freed as soon as it holds no entry of the log anymore.  */
+
+struct record_full_chunk
+{
+  struct record_full_chunk *prev;
+  struct record_full_chunk *next;
+
+  /* The size of the chunk's data, the size of the part in use, not
+     counting the marker, and the offset of the last entry.  */
+  size_t size;
+  size_t used;
+  size_t last;
+
+  /* The instruction number of the first end entry in the chunk, and
+     the number of end entries in the chunk.  Since instructions are
+     numbered consecutively, this is the range of instructions that
+     end in this chunk, which lets record_full_find_insn skip whole
+     chunks.  */
+  ULONGEST first_insn;
+  ULONGEST num_insns;
+
+  /* The chunk's data, which follows it.  */
+  gdb_byte *data ()
+  { return (gdb_byte *) (this + 1); }
+};
+
+static_assert (sizeof (struct record_full_chunk)
+		   % RECORD_FULL_ENTRY_ALIGN == 0);
+
+/* The size of the data of a chunk, unless it is made larger to hold a
+   single large entry.  */
+
+#define RECORD_FULL_CHUNK_SIZE (64 * 1024)
+
+/* The size of the marker at the end of a chunk.  */
+
+#define RECORD_FULL_CHUNK_END_SIZE \
+  (sizeof (struct record_full_entry) + sizeof (struct record_full_chunk *))
+
 /* If true, query if PREC cannot record memory
    change of next instruction.  */
 bool record_full_memory_query = false;
@@ -180,27 +236,41 @@ static detached_regcache *record_full_core_regbuf = NULL;
 static std::vector<target_section> record_full_core_sections;
 static struct record_full_core_buf_entry *record_full_core_buf_list = NULL;
 
-/* The following variables are used for managing the linked list that
-   represents the execution log.
+/* The following variables are used for managing the execution log.
 
    record_full_first is the anchor that holds down the beginning of
-   the list.
+   the log.  It is not in any chunk.
 
    record_full_list serves two functions:
-     1) In record mode, it anchors the end of the list.
-     2) In replay mode, it traverses the list and points to
+     1) In record mode, it anchors the end of the log.
+     2) In replay mode, it traverses the log and points to
 	the next instruction that must be emulated.
 
-   record_full_arch_list_head and record_full_arch_list_tail are used
-   to manage a separate list, which is used to build up the change
-   elements of the currently executing instruction during record mode.
-   When this instruction has been completely annotated in the "arch
-   list", it will be appended to the main execution log.  */
+   record_full_last is the last entry of the log.  While an instruction
+   is being recorded, its entries are added after record_full_last;
+   they only become part of the log once they are complete.  See
+   record_full_arch_list_commit.  */
+
+static struct
+{
+  struct record_full_entry entry;
+  ULONGEST insn_num;
+} record_full_first_end;
+
+static struct record_full_entry *const record_full_first
+  = &record_full_first_end.entry;
+static struct record_full_entry *record_full_list = record_full_first;
+static struct record_full_entry *record_full_last = record_full_first;
+
+/* The chunks holding the log, the first entry of the log, and the last
+   entry that was added to the last chunk, complete or not.  */
+static struct record_full_chunk *record_full_chunks_head = NULL;
+static struct record_full_chunk *record_full_chunks_tail = NULL;
+static struct record_full_entry *record_full_log_head = NULL;
+static struct record_full_entry *record_full_log_tail = record_full_first;
 
-static struct record_full_entry record_full_first;
-static struct record_full_entry *record_full_list = &record_full_first;
-static struct record_full_entry *record_full_arch_list_head = NULL;
-static struct record_full_entry *record_full_arch_list_tail = NULL;
+/* The memory used by the chunks, in bytes.  */
+static size_t record_full_chunks_size = 0;
 
 /* true ask user. false auto delete the last struct record_full_entry.  */
 static bool record_full_stop_at_limit = true;
@@ -392,133 +462,333 @@ static struct cmd_list_element *record_full_cmdlist;
 static void record_full_goto_insn (struct record_full_entry *entry,
 				   enum exec_direction_kind dir);
 
-/* Alloc and free functions for record_full_reg, record_full_mem, and
-   record_full_end entries.  */
+/* Return the size of entry REC, data and padding included.  */
 
-/* Alloc a record_full_reg record entry.  */
+static inline size_t
+record_full_entry_size (const struct record_full_entry *rec)
+{
+  size_t size = sizeof (struct record_full_entry);
 
-static inline struct record_full_entry *
-record_full_reg_alloc (struct regcache *regcache, int regnum)
+  switch (rec->type)
+    {
+    case record_full_reg:
+      size += rec->u.reg.len;
+      break;
+    case record_full_mem:
+      size += sizeof (CORE_ADDR) + rec->u.mem.len;
+      break;
+    case record_full_end:
+      size += sizeof (ULONGEST);
+      break;
+    case record_full_chunk_end:
+      size += sizeof (struct record_full_chunk *);
+      break;
+    }
+
+  return align_up (size, RECORD_FULL_ENTRY_ALIGN);
+}
+
+/* Return the value storage location of a record entry.  */
+
+static inline gdb_byte *
+record_full_get_loc (struct record_full_entry *rec)
 {
-  struct record_full_entry *rec;
-  struct gdbarch *gdbarch = regcache->arch ();
+  switch (rec->type) {
+  case record_full_mem:
+    return (gdb_byte *) (rec + 1) + sizeof (CORE_ADDR);
+  case record_full_reg:
+    return (gdb_byte *) (rec + 1);
+  case record_full_end:
+  default:
+    gdb_assert_not_reached ("unexpected record_full_entry type");
+    return NULL;
+  }
+}
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_reg;
-  rec->u.reg.num = regnum;
-  rec->u.reg.len = register_size (gdbarch, regnum);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    rec->u.reg.u.ptr = (gdb_byte *) xmalloc (rec->u.reg.len);
+/* Return the address of record_full_mem entry REC.  */
 
-  return rec;
+static inline CORE_ADDR &
+record_full_mem_addr (struct record_full_entry *rec)
+{
+  gdb_assert (rec->type == record_full_mem);
+  return *(CORE_ADDR *) (rec + 1);
 }
 
-/* Free a record_full_reg record entry.  */
+/* Return the instruction number of record_full_end entry REC.  */
 
-static inline void
-record_full_reg_release (struct record_full_entry *rec)
+static inline ULONGEST &
+record_full_end_insn_num (struct record_full_entry *rec)
 {
-  gdb_assert (rec->type == record_full_reg);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    xfree (rec->u.reg.u.ptr);
-  xfree (rec);
+  gdb_assert (rec->type == record_full_end);
+  return *(ULONGEST *) (rec + 1);
 }
 
-/* Alloc a record_full_mem record entry.  */
+/* Return the chunk of record_full_chunk_end marker REC.  */
+
+static inline struct record_full_chunk *&
+record_full_marker_chunk (struct record_full_entry *rec)
+{
+  gdb_assert (rec->type == record_full_chunk_end);
+  return *(struct record_full_chunk **) (rec + 1);
+}
+
+/* Return the entry that follows REC in its chunk, or the marker at the
+   end of the chunk.  */
 
 static inline struct record_full_entry *
-record_full_mem_alloc (CORE_ADDR addr, int len)
+record_full_next_in_chunk (struct record_full_entry *rec)
 {
-  struct record_full_entry *rec;
+  return ((struct record_full_entry *)
+	  ((gdb_byte *) rec + record_full_entry_size (rec)));
+}
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_mem;
-  rec->u.mem.addr = addr;
-  rec->u.mem.len = len;
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    rec->u.mem.u.ptr = (gdb_byte *) xmalloc (len);
+/* Return the entry that follows REC in the log, or NULL if REC is the
+   last one.  */
+
+static struct record_full_entry *
+record_full_next (struct record_full_entry *rec)
+{
+  if (rec == record_full_last)
+    return NULL;
+  if (rec == record_full_first)
+    return record_full_log_head;
+
+  rec = record_full_next_in_chunk (rec);
+  if (rec->type == record_full_chunk_end)
+    {
+      struct record_full_chunk *next = record_full_marker_chunk (rec)->next;
+
+      if (next == NULL)
+	return NULL;
+      return (struct record_full_entry *) next->data ();
+    }
 
   return rec;
 }
 
-/* Free a record_full_mem record entry.  */
+/* Return the entry that precedes REC in the log, or NULL if REC is
+   record_full_first.  */
 
-static inline void
-record_full_mem_release (struct record_full_entry *rec)
+static struct record_full_entry *
+record_full_prev (struct record_full_entry *rec)
 {
-  gdb_assert (rec->type == record_full_mem);
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    xfree (rec->u.mem.u.ptr);
-  xfree (rec);
+  if (rec == record_full_first)
+    return NULL;
+  if (rec == record_full_log_head)
+    return record_full_first;
+  if (rec->prev_size != 0)
+    return (struct record_full_entry *) ((gdb_byte *) rec - rec->prev_size);
+
+  /* REC is the first entry of its chunk, which follows it.  */
+  struct record_full_chunk *prev = ((struct record_full_chunk *) rec - 1)->prev;
+  return (struct record_full_entry *) (prev->data () + prev->last);
+}
+
+/* Write the marker at the end of CHUNK.  */
+
+static void
+record_full_chunk_set_end (struct record_full_chunk *chunk)
+{
+  struct record_full_entry *marker
+    = (struct record_full_entry *) (chunk->data () + chunk->used);
+
+  marker->prev_size = 0;
+  marker->type = record_full_chunk_end;
+  record_full_marker_chunk (marker) = chunk;
+}
+
+/* Allocate a chunk with SIZE bytes of data, and add it after the last
+   chunk.  */
+
+static struct record_full_chunk *
+record_full_chunk_alloc (size_t size)
+{
+  struct record_full_chunk *chunk
+    = (struct record_full_chunk *) xmalloc (sizeof (*chunk) + size);
+
+  chunk->prev = record_full_chunks_tail;
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->last = 0;
+  chunk->first_insn = 0;
+  chunk->num_insns = 0;
+  record_full_chunk_set_end (chunk);
+
+  if (record_full_chunks_tail != NULL)
+    record_full_chunks_tail->next = chunk;
+  else
+    record_full_chunks_head = chunk;
+  record_full_chunks_tail = chunk;
+  record_full_chunks_size += sizeof (*chunk) + size;
+
+  return chunk;
+}
+
+/* Unlink CHUNK from the list of chunks, and free it.  */
+
+static void
+record_full_chunk_free (struct record_full_chunk *chunk)
+{
+  if (chunk->prev != NULL)
+    chunk->prev->next = chunk->next;
+  else
+    record_full_chunks_head = chunk->next;
+  if (chunk->next != NULL)
+    chunk->next->prev = chunk->prev;
+  else
+    record_full_chunks_tail = chunk->prev;
+
+  record_full_chunks_size -= sizeof (*chunk) + chunk->size;
+  xfree (chunk);
+}
+
+/* Alloc and free functions for record_full_reg, record_full_mem, and
+   record_full_end entries.  */
+
+/* Add an entry of TYPE, with DATA_SIZE bytes of data, after the last
+   entry of the last chunk, and return it.  Its data is cleared.  The
+   caller must set the fields that record_full_entry_size depends on
+   to match DATA_SIZE.  */
+
+static struct record_full_entry *
+record_full_entry_alloc (enum record_full_type type, size_t data_size)
+{
+  size_t size = align_up (sizeof (struct record_full_entry) + data_size,
+			  RECORD_FULL_ENTRY_ALIGN);
+  struct record_full_chunk *chunk = record_full_chunks_tail;
+  size_t prev_size = 0;
+
+  if (chunk != NULL
+      && chunk->size - chunk->used >= size + RECORD_FULL_CHUNK_END_SIZE)
+    prev_size = chunk->used - chunk->last;
+  else
+    chunk = record_full_chunk_alloc
+      (std::max<size_t> (size + RECORD_FULL_CHUNK_END_SIZE,
+			 RECORD_FULL_CHUNK_SIZE));
+
+  /* Only entries that fit in a chunk of the default size can have a
+     successor in their chunk.  */
+  gdb_assert (prev_size <= USHRT_MAX);
+
+  struct record_full_entry *rec
+    = (struct record_full_entry *) (chunk->data () + chunk->used);
+  memset (rec, 0, size);
+  rec->prev_size = prev_size;
+  rec->type = type;
+
+  chunk->last = chunk->used;
+  chunk->used += size;
+  record_full_chunk_set_end (chunk);
+
+  if (record_full_log_head == NULL)
+    record_full_log_head = rec;
+  record_full_log_tail = rec;
+
+  return rec;
 }
 
-/* Alloc a record_full_end record entry.  */
+/* Alloc a record_full_reg record entry.  */
 
 static inline struct record_full_entry *
-record_full_end_alloc (void)
+record_full_reg_alloc (struct regcache *regcache, int regnum)
 {
   struct record_full_entry *rec;
+  struct gdbarch *gdbarch = regcache->arch ();
+  int len = register_size (gdbarch, regnum);
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_end;
+  rec = record_full_entry_alloc (record_full_reg, len);
+  rec->u.reg.num = regnum;
+  rec->u.reg.len = len;
 
   return rec;
 }
 
-/* Free a record_full_end record entry.  */
+/* Alloc a record_full_mem record entry.  */
 
-static inline void
-record_full_end_release (struct record_full_entry *rec)
+static inline struct record_full_entry *
+record_full_mem_alloc (CORE_ADDR addr, int len)
 {
-  xfree (rec);
+  struct record_full_entry *rec;
+
+  rec = record_full_entry_alloc (record_full_mem, sizeof (CORE_ADDR) + len);
+  rec->u.mem.len = len;
+  record_full_mem_addr (rec) = addr;
+
+  return rec;
 }
 
-/* Free one record entry, any type.
-   Return entry->type, in case caller wants to know.  */
+/* Alloc a record_full_end record entry, for instruction number
+   INSN_NUM.  */
 
-static inline enum record_full_type
-record_full_entry_release (struct record_full_entry *rec)
+static inline struct record_full_entry *
+record_full_end_alloc (ULONGEST insn_num)
 {
-  enum record_full_type type = rec->type;
+  struct record_full_entry *rec;
 
-  switch (type) {
-  case record_full_reg:
-    record_full_reg_release (rec);
-    break;
-  case record_full_mem:
-    record_full_mem_release (rec);
-    break;
-  case record_full_end:
-    record_full_end_release (rec);
-    break;
-  }
-  return type;
+  rec = record_full_entry_alloc (record_full_end, sizeof (ULONGEST));
+  record_full_end_insn_num (rec) = insn_num;
+
+  struct record_full_chunk *chunk = record_full_chunks_tail;
+  if (chunk->num_insns++ == 0)
+    chunk->first_insn = insn_num;
+
+  return rec;
 }
 
-/* Free all record entries in list pointed to by REC.  */
+/* Remove all the entries after REC from the chunks, whether they are
+   part of the log or of the instruction being recorded, and free the
+   chunks that become empty.  Return the number of record_full_end
+   entries removed.  The caller must update record_full_last if it was
+   after REC.  */
 
-static void
-record_full_list_release (struct record_full_entry *rec)
+static ULONGEST
+record_full_log_truncate (struct record_full_entry *rec)
 {
-  if (!rec)
-    return;
-
-  while (rec->next)
-    rec = rec->next;
+  struct record_full_chunk *chunk = NULL;
+  ULONGEST removed = 0;
 
-  while (rec->prev)
+  if (rec != record_full_first)
     {
-      rec = rec->prev;
-      record_full_entry_release (rec->next);
+      /* Find the chunk of REC, counting the instructions that end
+	 after REC in it.  */
+      struct record_full_entry *p;
+
+      for (p = record_full_next_in_chunk (rec);
+	   p->type != record_full_chunk_end;
+	   p = record_full_next_in_chunk (p))
+	if (p->type == record_full_end)
+	  removed++;
+
+      chunk = record_full_marker_chunk (p);
+      chunk->num_insns -= removed;
+      chunk->last = (gdb_byte *) rec - chunk->data ();
+      chunk->used = chunk->last + record_full_entry_size (rec);
+      record_full_chunk_set_end (chunk);
     }
+  else
+    record_full_log_head = NULL;
 
-  if (rec == &record_full_first)
+  while (record_full_chunks_tail != chunk)
     {
-      record_full_insn_num = 0;
-      record_full_first.next = NULL;
+      removed += record_full_chunks_tail->num_insns;
+      record_full_chunk_free (record_full_chunks_tail);
     }
-  else
-    record_full_entry_release (rec);
+
+  record_full_log_tail = rec;
+
+  return removed;
+}
+
+/* Free all record entries, and reset the log.  */
+
+static void
+record_full_list_release_all (void)
+{
+  record_full_log_truncate (record_full_first);
+  record_full_last = record_full_first;
+  record_full_list = record_full_first;
+  record_full_insn_num = 0;
 }
 
 /* Free all record entries forward of the given list position.  */
@@ -526,19 +796,11 @@ record_full_list_release (struct record_full_entry *rec)
 static void
 record_full_list_release_following (struct record_full_entry *rec)
 {
-  struct record_full_entry *tmp = rec->next;
+  ULONGEST removed = record_full_log_truncate (rec);
 
-  rec->next = NULL;
-  while (tmp)
-    {
-      rec = tmp->next;
-      if (record_full_entry_release (tmp) == record_full_end)
-	{
-	  record_full_insn_num--;
-	  record_full_insn_count--;
-	}
-      tmp = rec;
-    }
+  record_full_last = rec;
+  record_full_insn_num -= removed;
+  record_full_insn_count -= removed;
 }
 
 /* Delete the first instruction from the beginning of the log, to make
@@ -549,74 +811,116 @@ record_full_list_release_following (struct record_full_entry *rec)
 static void
 record_full_list_release_first (void)
 {
-  struct record_full_entry *tmp;
+  struct record_full_entry *rec = record_full_log_head;
 
-  if (!record_full_first.next)
+  if (rec == NULL)
     return;
 
   /* Loop until a record_full_end.  */
   while (1)
     {
-      /* Cut record_full_first.next out of the linked list.  */
-      tmp = record_full_first.next;
-      record_full_first.next = tmp->next;
-      tmp->next->prev = &record_full_first;
+      struct record_full_chunk *chunk = record_full_chunks_head;
+      enum record_full_type type = rec->type;
+
+      if (type == record_full_end)
+	{
+	  chunk->first_insn++;
+	  chunk->num_insns--;
+	}
+
+      /* Free the first chunk once it holds no entry of the log.  */
+      rec = record_full_next_in_chunk (rec);
+      if (rec->type == record_full_chunk_end)
+	{
+	  struct record_full_chunk *next = chunk->next;
+
+	  record_full_chunk_free (chunk);
+	  rec = (next != NULL
+		 ? (struct record_full_entry *) next->data () : NULL);
+	}
 
-      /* tmp is now isolated, and can be deleted.  */
-      if (record_full_entry_release (tmp) == record_full_end)
+      if (type == record_full_end)
 	break;	/* End loop at first record_full_end.  */
 
-      if (!record_full_first.next)
+      if (rec == NULL)
 	{
 	  gdb_assert (record_full_insn_num == 1);
 	  break;	/* End loop when list is empty.  */
 	}
     }
+
+  record_full_log_head = rec;
+  if (rec == NULL)
+    {
+      record_full_log_tail = record_full_first;
+      record_full_last = record_full_first;
+      record_full_list = record_full_first;
+    }
 }
 
-/* Add a struct record_full_entry to record_full_arch_list.  */
+/* Discard the entries recorded so far for the instruction being
+   recorded.  */
 
 static void
-record_full_arch_list_add (struct record_full_entry *rec)
+record_full_arch_list_discard (void)
 {
-  if (record_debug > 1)
-    gdb_printf (gdb_stdlog,
-		"Process record: record_full_arch_list_add %s.\n",
-		host_address_to_string (rec));
+  record_full_log_truncate (record_full_last);
+}
 
-  if (record_full_arch_list_tail)
-    {
-      record_full_arch_list_tail->next = rec;
-      rec->prev = record_full_arch_list_tail;
-      record_full_arch_list_tail = rec;
-    }
+/* Add the instruction just recorded to the end of the log, deleting
+   the first instruction of the log if it is full.  */
+
+static void
+record_full_arch_list_commit (void)
+{
+  record_full_last = record_full_log_tail;
+  record_full_list = record_full_last;
+
+  if (record_full_insn_num == record_full_insn_max_num)
+    record_full_list_release_first ();
   else
-    {
-      record_full_arch_list_head = rec;
-      record_full_arch_list_tail = rec;
-    }
+    record_full_insn_num++;
 }
 
-/* Return the value storage location of a record entry.  */
-static inline gdb_byte *
-record_full_get_loc (struct record_full_entry *rec)
+/* Return the record_full_end entry of instruction INSN_NUM in the
+   log, or NULL if there is none.  */
+
+static struct record_full_entry *
+record_full_find_insn (ULONGEST insn_num)
 {
-  switch (rec->type) {
-  case record_full_mem:
-    if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-      return rec->u.mem.u.ptr;
-    else
-      return rec->u.mem.u.buf;
-  case record_full_reg:
-    if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-      return rec->u.reg.u.ptr;
-    else
-      return rec->u.reg.u.buf;
-  case record_full_end:
-  default:
-    gdb_assert_not_reached ("unexpected record_full_entry type");
-    return NULL;
-  }
+  struct record_full_entry *p;
+
+  if (insn_num == record_full_end_insn_num (record_full_first))
+    return record_full_first;
+
+  /* Instructions are normally numbered consecutively, so only the
+     chunk whose range of instructions includes INSN_NUM needs to be
+     searched.  */
+  for (struct record_full_chunk *chunk = record_full_chunks_head;
+       chunk != NULL;
+       chunk = chunk->next)
+    if (chunk->num_insns != 0
+	&& insn_num >= chunk->first_insn
+	&& insn_num - chunk->first_insn < chunk->num_insns)
+      {
+	p = (chunk == record_full_chunks_head
+	     ? record_full_log_head
+	     : (struct record_full_entry *) chunk->data ());
+	for (; p->type != record_full_chunk_end;
+	     p = record_full_next_in_chunk (p))
+	  if (p->type == record_full_end
+	      && record_full_end_insn_num (p) == insn_num)
+	    return p;
+	break;
+      }
+
+  /* They may not be in a log restored from a file.  */
+  for (p = record_full_first; p != NULL; p = record_full_next (p))
+    if (p->type == record_full_end
+	&& record_full_end_insn_num (p) == insn_num)
+      return p;
+
+  return NULL;
 }
 
 /* Record the value of a register NUM to record_full_arch_list.  */
@@ -636,8 +940,6 @@ record_full_arch_list_add_reg (struct regcache *regcache, int regnum)
 
   regcache->cooked_read (regnum, record_full_get_loc (rec));
 
-  record_full_arch_list_add (rec);
-
   return 0;
 }
 
@@ -663,12 +965,10 @@ record_full_arch_list_add_mem (CORE_ADDR addr, int len)
   if (record_read_memory (current_inferior ()->arch (), addr,
 			  record_full_get_loc (rec), len))
     {
-      record_full_mem_release (rec);
+      record_full_log_truncate (record_full_prev (rec));
       return -1;
     }
 
-  record_full_arch_list_add (rec);
-
   return 0;
 }
 
@@ -678,17 +978,11 @@ record_full_arch_list_add_mem (CORE_ADDR addr, int len)
 int
 record_full_arch_list_add_end (void)
 {
-  struct record_full_entry *rec;
-
   if (record_debug > 1)
     gdb_printf (gdb_stdlog,
 		"Process record: add end to arch list.\n");
 
-  rec = record_full_end_alloc ();
-  rec->u.end.sigval = GDB_SIGNAL_0;
-  rec->u.end.insn_num = ++record_full_insn_count;
-
-  record_full_arch_list_add (rec);
+  record_full_end_alloc (++record_full_insn_count);
 
   return 0;
 }
@@ -724,9 +1018,6 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
 
   try
     {
-      record_full_arch_list_head = NULL;
-      record_full_arch_list_tail = NULL;
-
       /* Check record_full_insn_num.  */
       record_full_check_insn_num ();
 
@@ -753,7 +1044,7 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
 	 if we delivered it during the recording.  Therefore we should
 	 record the signal during record_full_wait, not
 	 record_full_resume.  */
-      if (record_full_list != &record_full_first)  /* FIXME better way
+      if (record_full_list != record_full_first)  /* FIXME better way
 						      to check */
 	{
 	  gdb_assert (record_full_list->type == record_full_end);
@@ -777,18 +1068,11 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
     }
   catch (const gdb_exception &ex)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_discard ();
       throw;
     }
 
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
-  record_full_list = record_full_arch_list_tail;
-
-  if (record_full_insn_num == record_full_insn_max_num)
-    record_full_list_release_first ();
-  else
-    record_full_insn_num++;
+  record_full_arch_list_commit ();
 }
 
 static bool
@@ -823,6 +1107,10 @@ record_full_gdb_operation_disable_set (void)
 static enum target_stop_reason record_full_stop_reason
   = TARGET_STOPPED_BY_NO_REASON;
 
+/* The buffer record_full_exec_insn swaps values through, kept from
+   one entry to the next.  */
+static gdb::byte_vector record_full_exec_buf;
+
 /* Execute one instruction from the record log.  Each instruction in
    the log will be represented by an arbitrary sequence of register
    entries and memory entries, followed by an 'end' entry.  */
@@ -836,7 +1124,8 @@ record_full_exec_insn (struct regcache *regcache,
     {
     case record_full_reg: /* reg */
       {
-	gdb::byte_vector reg (entry->u.reg.len);
+	gdb::byte_vector &reg = record_full_exec_buf;
+	reg.resize (entry->u.reg.len);
 
 	if (record_debug > 1)
 	  gdb_printf (gdb_stdlog,
@@ -856,23 +1145,24 @@ record_full_exec_insn (struct regcache *regcache,
 	/* Nothing to do if the entry is flagged not_accessible.  */
 	if (!entry->u.mem.mem_entry_not_accessible)
 	  {
-	    gdb::byte_vector mem (entry->u.mem.len);
+	    gdb::byte_vector &mem = record_full_exec_buf;
+	    mem.resize (entry->u.mem.len);
 
 	    if (record_debug > 1)
 	      gdb_printf (gdb_stdlog,
 			  "Process record: record_full_mem %s to "
 			  "inferior addr = %s len = %d.\n",
 			  host_address_to_string (entry),
-			  paddress (gdbarch, entry->u.mem.addr),
+			  paddress (gdbarch, record_full_mem_addr (entry)),
 			  entry->u.mem.len);
 
 	    if (record_read_memory (gdbarch,
-				    entry->u.mem.addr, mem.data (),
+				    record_full_mem_addr (entry), mem.data (),
 				    entry->u.mem.len))
 	      entry->u.mem.mem_entry_not_accessible = 1;
 	    else
 	      {
-		if (target_write_memory (entry->u.mem.addr, 
+		if (target_write_memory (record_full_mem_addr (entry), 
 					 record_full_get_loc (entry),
 					 entry->u.mem.len))
 		  {
@@ -880,7 +1170,7 @@ record_full_exec_insn (struct regcache *regcache,
 		    if (record_debug)
 		      warning (_("Process record: error writing memory at "
 				 "addr = %s len = %d."),
-			       paddress (gdbarch, entry->u.mem.addr),
+			       paddress (gdbarch, record_full_mem_addr (entry)),
 			       entry->u.mem.len);
 		  }
 		else
@@ -898,7 +1188,7 @@ record_full_exec_insn (struct regcache *regcache,
 		       traps.  */
 		    if (hardware_watchpoint_inserted_in_range
 			(current_inferior ()->aspace.get (),
-			 entry->u.mem.addr, entry->u.mem.len))
+			 record_full_mem_addr (entry), entry->u.mem.len))
 		      record_full_stop_reason = TARGET_STOPPED_BY_WATCHPOINT;
 		  }
 	      }
@@ -984,8 +1274,7 @@ record_full_open (const char *args, int from_tty)
   /* Reset */
   record_full_insn_num = 0;
   record_full_insn_count = 0;
-  record_full_list = &record_full_first;
-  record_full_list->next = NULL;
+  record_full_list_release_all ();
 
   if (current_program_space->core_bfd ())
     record_full_core_open_1 ();
@@ -1012,7 +1301,7 @@ record_full_base_target::close ()
   if (record_debug)
     gdb_printf (gdb_stdlog, "Process record: record_full_close\n");
 
-  record_full_list_release (record_full_list);
+  record_full_list_release_all ();
 
   /* Release record_full_core_regbuf.  */
   if (record_full_core_regbuf)
@@ -1341,8 +1630,9 @@ record_full_wait_1 (struct target_ops *ops,
 
 	  /* In EXEC_FORWARD mode, record_full_list points to the tail of prev
 	     instruction.  */
-	  if (execution_direction == EXEC_FORWARD && record_full_list->next)
-	    record_full_list = record_full_list->next;
+	  if (execution_direction == EXEC_FORWARD
+	      && record_full_next (record_full_list) != nullptr)
+	    record_full_list = record_full_next (record_full_list);
 
 	  /* Loop over the record_full_list, looking for the next place to
 	     stop.  */
@@ -1350,14 +1640,14 @@ record_full_wait_1 (struct target_ops *ops,
 	    {
 	      /* Check for beginning and end of log.  */
 	      if (execution_direction == EXEC_REVERSE
-		  && record_full_list == &record_full_first)
+		  && record_full_list == record_full_first)
 		{
 		  /* Hit beginning of record log in reverse.  */
 		  status->set_no_history ();
 		  break;
 		}
 	      if (execution_direction != EXEC_REVERSE
-		  && !record_full_list->next)
+		  && !record_full_next (record_full_list))
 		{
 		  /* Hit end of record log going forward.  */
 		  status->set_no_history ();
@@ -1432,13 +1722,13 @@ record_full_wait_1 (struct target_ops *ops,
 		{
 		  if (execution_direction == EXEC_REVERSE)
 		    {
-		      if (record_full_list->prev)
-			record_full_list = record_full_list->prev;
+		      if (record_full_prev (record_full_list))
+			record_full_list = record_full_prev (record_full_list);
 		    }
 		  else
 		    {
-		      if (record_full_list->next)
-			record_full_list = record_full_list->next;
+		      if (record_full_next (record_full_list))
+			record_full_list = record_full_next (record_full_list);
 		    }
 		}
 	    }
@@ -1460,11 +1750,11 @@ record_full_wait_1 (struct target_ops *ops,
 	{
 	  if (execution_direction == EXEC_REVERSE)
 	    {
-	      if (record_full_list->next)
-		record_full_list = record_full_list->next;
+	      if (record_full_next (record_full_list))
+		record_full_list = record_full_next (record_full_list);
 	    }
 	  else
-	    record_full_list = record_full_list->prev;
+	    record_full_list = record_full_prev (record_full_list);
 
 	  throw;
 	}
@@ -1552,9 +1842,6 @@ record_full_registers_change (struct regcache *regcache, int regnum)
   /* Check record_full_insn_num.  */
   record_full_check_insn_num ();
 
-  record_full_arch_list_head = NULL;
-  record_full_arch_list_tail = NULL;
-
   if (regnum < 0)
     {
       int i;
@@ -1563,7 +1850,7 @@ record_full_registers_change (struct regcache *regcache, int regnum)
 	{
 	  if (record_full_arch_list_add_reg (regcache, i))
 	    {
-	      record_full_list_release (record_full_arch_list_tail);
+	      record_full_arch_list_discard ();
 	      error (_("Process record: failed to record execution log."));
 	    }
 	}
@@ -1572,23 +1859,16 @@ record_full_registers_change (struct regcache *regcache, int regnum)
     {
       if (record_full_arch_list_add_reg (regcache, regnum))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_discard ();
 	  error (_("Process record: failed to record execution log."));
 	}
     }
   if (record_full_arch_list_add_end ())
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_discard ();
       error (_("Process record: failed to record execution log."));
     }
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
-  record_full_list = record_full_arch_list_tail;
-
-  if (record_full_insn_num == record_full_insn_max_num)
-    record_full_list_release_first ();
-  else
-    record_full_insn_num++;
+  record_full_arch_list_commit ();
 }
 
 /* "store_registers" method for process record target.  */
@@ -1677,11 +1957,9 @@ record_full_target::xfer_partial (enum target_object object,
       record_full_check_insn_num ();
 
       /* Record registers change to list as an instruction.  */
-      record_full_arch_list_head = NULL;
-      record_full_arch_list_tail = NULL;
       if (record_full_arch_list_add_mem (offset, len))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_discard ();
 	  if (record_debug)
 	    gdb_printf (gdb_stdlog,
 			"Process record: failed to record "
@@ -1690,21 +1968,14 @@ record_full_target::xfer_partial (enum target_object object,
 	}
       if (record_full_arch_list_add_end ())
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_discard ();
 	  if (record_debug)
 	    gdb_printf (gdb_stdlog,
 			"Process record: failed to record "
 			"execution log.");
 	  return TARGET_XFER_E_IO;
 	}
-      record_full_list->next = record_full_arch_list_head;
-      record_full_arch_list_head->prev = record_full_list;
-      record_full_list = record_full_arch_list_tail;
-
-      if (record_full_insn_num == record_full_insn_max_num)
-	record_full_list_release_first ();
-      else
-	record_full_insn_num++;
+      record_full_arch_list_commit ();
     }
 
   return this->beneath ()->xfer_partial (object, annex, readbuf, writebuf,
@@ -1862,7 +2133,7 @@ record_full_base_target::get_bookmark (const char *args, int from_tty)
 
   /* Return stringified form of instruction count.  */
   if (record_full_list && record_full_list->type == record_full_end)
-    ret = xstrdup (pulongest (record_full_list->u.end.insn_num));
+    ret = xstrdup (pulongest (record_full_end_insn_num (record_full_list)));
 
   if (record_debug)
     {
@@ -1926,9 +2197,9 @@ record_full_base_target::info_record ()
     gdb_printf (_("Record mode:\n"));
 
   /* Find entry for first actual instruction in the log.  */
-  for (p = record_full_first.next;
+  for (p = record_full_next (record_full_first);
        p != NULL && p->type != record_full_end;
-       p = p->next)
+       p = record_full_next (p))
     ;
 
   /* Do we have a log at all?  */
@@ -1936,12 +2207,12 @@ record_full_base_target::info_record ()
     {
       /* Display instruction number for first instruction in the log.  */
       gdb_printf (_("Lowest recorded instruction number is %s.\n"),
-		  pulongest (p->u.end.insn_num));
+		  pulongest (record_full_end_insn_num (p)));
 
       /* If in replay mode, display where we are in the log.  */
       if (RECORD_FULL_IS_REPLAY)
 	gdb_printf (_("Current instruction number is %s.\n"),
-		    pulongest (record_full_list->u.end.insn_num));
+		    pulongest (record_full_end_insn_num (record_full_list)));
 
       /* Display instruction number for last instruction in the log.  */
       gdb_printf (_("Highest recorded instruction number is %s.\n"),
@@ -1950,6 +2221,10 @@ record_full_base_target::info_record ()
       /* Display log count.  */
       gdb_printf (_("Log contains %u instructions.\n"),
 		  record_full_insn_num);
+
+      /* Display the memory used by the log.  */
+      gdb_printf (_("Log uses %s bytes of memory.\n"),
+		  pulongest (record_full_chunks_size));
     }
   else
     gdb_printf (_("No instructions have been logged.\n"));
@@ -2002,16 +2277,17 @@ record_full_goto_entry (struct record_full_entry *p)
     error (_("Target insn not found."));
   else if (p == record_full_list)
     error (_("Already at target insn."));
-  else if (p->u.end.insn_num > record_full_list->u.end.insn_num)
+  else if (record_full_end_insn_num (p)
+	   > record_full_end_insn_num (record_full_list))
     {
       gdb_printf (_("Go forward to insn number %s\n"),
-		  pulongest (p->u.end.insn_num));
+		  pulongest (record_full_end_insn_num (p)));
       record_full_goto_insn (p, EXEC_FORWARD);
     }
   else
     {
       gdb_printf (_("Go backward to insn number %s\n"),
-		  pulongest (p->u.end.insn_num));
+		  pulongest (record_full_end_insn_num (p)));
       record_full_goto_insn (p, EXEC_REVERSE);
     }
 
@@ -2030,7 +2306,7 @@ record_full_base_target::goto_record_begin ()
 {
   struct record_full_entry *p = NULL;
 
-  for (p = &record_full_first; p != NULL; p = p->next)
+  for (p = record_full_first; p != NULL; p = record_full_next (p))
     if (p->type == record_full_end)
       break;
 
@@ -2044,9 +2320,7 @@ record_full_base_target::goto_record_end ()
 {
   struct record_full_entry *p = NULL;
 
-  for (p = record_full_list; p->next != NULL; p = p->next)
-    ;
-  for (; p!= NULL; p = p->prev)
+  for (p = record_full_last; p != NULL; p = record_full_prev (p))
     if (p->type == record_full_end)
       break;
 
@@ -2058,13 +2332,7 @@ record_full_base_target::goto_record_end ()
 void
 record_full_base_target::goto_record (ULONGEST target_insn)
 {
-  struct record_full_entry *p = NULL;
-
-  for (p = &record_full_first; p != NULL; p = p->next)
-    if (p->type == record_full_end && p->u.end.insn_num == target_insn)
-      break;
-
-  record_full_goto_entry (p);
+  record_full_goto_entry (record_full_find_insn (target_insn));
 }
 
 /* The "record_stop_replaying" target method.  */
@@ -2348,7 +2616,7 @@ record_full_restore (void)
     return;
 
   /* "record_full_restore" can only be called when record list is empty.  */
-  gdb_assert (record_full_first.next == NULL);
+  gdb_assert (record_full_log_head == NULL);
  
   if (record_debug)
     gdb_printf (gdb_stdlog, "Restoring recording from core file.\n");
@@ -2376,10 +2644,7 @@ record_full_restore (void)
 		"RECORD_FULL_FILE_MAGIC (0x%s)\n",
 		phex_nz (netorder32 (magic), 4));
 
-  /* Restore the entries in recfd into record_full_arch_list_head and
-     record_full_arch_list_tail.  */
-  record_full_arch_list_head = NULL;
-  record_full_arch_list_tail = NULL;
+  /* Restore the entries in recfd after record_full_first.  */
   record_full_insn_num = 0;
 
   try
@@ -2445,27 +2710,26 @@ record_full_restore (void)
 			    "  Reading memory %s (1 plus "
 			    "%lu plus %lu plus %d bytes)\n",
 			    paddress (get_current_arch (),
-				      rec->u.mem.addr),
+				      record_full_mem_addr (rec)),
 			    (unsigned long) sizeof (addr),
 			    (unsigned long) sizeof (len),
 			    rec->u.mem.len);
 	      break;
 
 	    case record_full_end: /* end */
-	      rec = record_full_end_alloc ();
-	      record_full_insn_num ++;
-
 	      /* Get signal value.  */
 	      bfdcore_read (current_program_space->core_bfd (), osec, &signal,
 			    sizeof (signal), &bfd_offset);
 	      signal = netorder32 (signal);
-	      rec->u.end.sigval = (enum gdb_signal) signal;
 
 	      /* Get insn count.  */
 	      bfdcore_read (current_program_space->core_bfd (), osec, &count,
 			    sizeof (count), &bfd_offset);
 	      count = netorder32 (count);
-	      rec->u.end.insn_num = count;
+
+	      rec = record_full_end_alloc (count);
+	      record_full_insn_num ++;
+	      rec->u.end.sigval = (enum gdb_signal) signal;
 	      record_full_insn_count = count + 1;
 	      if (record_debug)
 		gdb_printf (gdb_stdlog,
@@ -2483,21 +2747,17 @@ record_full_restore (void)
 	      break;
 	    }
 
-	  /* Add rec to record arch list.  */
-	  record_full_arch_list_add (rec);
 	}
     }
   catch (const gdb_exception &ex)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_discard ();
       throw;
     }
 
-  /* Add record_full_arch_list_head to the end of record list.  */
-  record_full_first.next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = &record_full_first;
-  record_full_arch_list_tail->next = NULL;
-  record_full_list = &record_full_first;
+  /* Add the restored entries to the log.  */
+  record_full_last = record_full_log_tail;
+  record_full_list = record_full_first;
 
   /* Update record_full_insn_max_num.  */
   if (record_full_insn_num > record_full_insn_max_num)
@@ -2578,19 +2838,20 @@ record_full_base_target::save_record (const char *recfilename)
   while (1)
     {
       /* Check for beginning and end of log.  */
-      if (record_full_list == &record_full_first)
+      if (record_full_list == record_full_first)
 	break;
 
       record_full_exec_insn (regcache, gdbarch, record_full_list);
 
-      if (record_full_list->prev)
-	record_full_list = record_full_list->prev;
+      if (record_full_prev (record_full_list))
+	record_full_list = record_full_prev (record_full_list);
     }
 
   /* Compute the size needed for the extra bfd section.  */
   save_size = 4;	/* magic cookie */
-  for (record_full_list = record_full_first.next; record_full_list;
-       record_full_list = record_full_list->next)
+  for (record_full_list = record_full_next (record_full_first);
+       record_full_list != nullptr;
+       record_full_list = record_full_next (record_full_list))
     switch (record_full_list->type)
       {
       case record_full_end:
@@ -2631,11 +2892,11 @@ record_full_base_target::save_record (const char *recfilename)
 
   /* Save the entries to recfd and forward execute to the end of
      record list.  */
-  record_full_list = &record_full_first;
+  record_full_list = record_full_first;
   while (1)
     {
       /* Save entry.  */
-      if (record_full_list != &record_full_first)
+      if (record_full_list != record_full_first)
 	{
 	  uint8_t type;
 	  uint32_t regnum, len, signal, count;
@@ -2672,7 +2933,7 @@ record_full_base_target::save_record (const char *recfilename)
 			    "  Writing memory %s (1 plus "
 			    "%lu plus %lu plus %d bytes)\n",
 			    paddress (gdbarch,
-				      record_full_list->u.mem.addr),
+				      record_full_mem_addr (record_full_list)),
 			    (unsigned long) sizeof (addr),
 			    (unsigned long) sizeof (len),
 			    record_full_list->u.mem.len);
@@ -2683,7 +2944,7 @@ record_full_base_target::save_record (const char *recfilename)
 			     &bfd_offset);
 
 	      /* Write memaddr.  */
-	      addr = netorder64 (record_full_list->u.mem.addr);
+	      addr = netorder64 (record_full_mem_addr (record_full_list));
 	      bfdcore_write (obfd.get (), osec, &addr, 
 			     sizeof (addr), &bfd_offset);
 
@@ -2706,7 +2967,8 @@ record_full_base_target::save_record (const char *recfilename)
 			       sizeof (signal), &bfd_offset);
 
 		/* Write insn count.  */
-		count = netorder32 (record_full_list->u.end.insn_num);
+		count
+		  = netorder32 (record_full_end_insn_num (record_full_list));
 		bfdcore_write (obfd.get (), osec, &count,
 			       sizeof (count), &bfd_offset);
 		break;
@@ -2716,8 +2978,8 @@ record_full_base_target::save_record (const char *recfilename)
       /* Execute entry.  */
       record_full_exec_insn (regcache, gdbarch, record_full_list);
 
-      if (record_full_list->next)
-	record_full_list = record_full_list->next;
+      if (record_full_next (record_full_list))
+	record_full_list = record_full_next (record_full_list);
       else
 	break;
     }
@@ -2731,8 +2993,8 @@ record_full_base_target::save_record (const char *recfilename)
 
       record_full_exec_insn (regcache, gdbarch, record_full_list);
 
-      if (record_full_list->prev)
-	record_full_list = record_full_list->prev;
+      if (record_full_prev (record_full_list))
+	record_full_list = record_full_prev (record_full_list);
     }
 
   unlink_file.keep ();
@@ -2759,15 +3021,15 @@ record_full_goto_insn (struct record_full_entry *entry,
      and we will not hit the end of the recording.  */
 
   if (dir == EXEC_FORWARD)
-    record_full_list = record_full_list->next;
+    record_full_list = record_full_next (record_full_list);
 
   do
     {
       record_full_exec_insn (regcache, gdbarch, record_full_list);
       if (dir == EXEC_REVERSE)
-	record_full_list = record_full_list->prev;
+	record_full_list = record_full_prev (record_full_list);
       else
-	record_full_list = record_full_list->next;
+	record_full_list = record_full_next (record_full_list);
     } while (record_full_list != entry);
 }
 
@@ -2808,9 +3070,9 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	{
 	  /* Move forward OFFSET instructions.  We know we found the
 	     end of an instruction when to_print->type is record_full_end.  */
-	  while (to_print->next != nullptr && offset > 0)
+	  while (record_full_next (to_print) != nullptr && offset > 0)
 	    {
-	      to_print = to_print->next;
+	      to_print = record_full_next (to_print);
 	      if (to_print->type == record_full_end)
 		offset--;
 	    }
@@ -2819,9 +3081,9 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	}
       else
 	{
-	  while (to_print->prev != nullptr && offset < 0)
+	  while (record_full_prev (to_print) != nullptr && offset < 0)
 	    {
-	      to_print = to_print->prev;
+	      to_print = record_full_prev (to_print);
 	      if (to_print->type == record_full_end)
 		offset++;
 	    }
@@ -2834,12 +3096,13 @@ maintenance_print_record_instruction (const char *args, int from_tty)
   gdbarch *arch = current_inferior ()->arch ();
 
   /* Go back to the start of the instruction.  */
-  while (to_print->prev != nullptr && to_print->prev->type != record_full_end)
-    to_print = to_print->prev;
+  while (record_full_prev (to_print) != nullptr
+	 && record_full_prev (to_print)->type != record_full_end)
+    to_print = record_full_prev (to_print);
 
   /* if we're in the first record, there are no actual instructions
      recorded.  Warn the user and leave.  */
-  if (to_print == &record_full_first)
+  if (to_print == record_full_first)
     error (_("Not enough recorded history"));
 
   while (to_print->type != record_full_end)
@@ -2866,14 +3129,15 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	      gdb_byte *b = record_full_get_loc (to_print);
 	      gdb_printf ("%d bytes of memory at address %s changed from:",
 			  to_print->u.mem.len,
-			  print_core_address (arch, to_print->u.mem.addr));
+			  print_core_address (arch,
+					      record_full_mem_addr (to_print)));
 	      for (int i = 0; i < to_print->u.mem.len; i++)
 		gdb_printf (" %02x", b[i]);
 	      gdb_printf ("\n");
 	      break;
 	    }
 	}
-      to_print = to_print->next;
+      to_print = record_full_next (to_print);
     }
 }
 
@@ -2883,11 +3147,6 @@ _initialize_record_full ()
 {
   struct cmd_list_element *c;
 
-  /* Init record_full_first.  */
-  record_full_first.prev = NULL;
-  record_full_first.next = NULL;
-  record_full_first.type = record_full_end;
-
   add_target (record_full_target_info, record_full_open);
   add_deprecated_target_alias (record_full_target_info, "record");
   add_target (record_full_core_target_info, record_full_open);
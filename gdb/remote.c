@@ -44,6 +44,8 @@
 #include "gdb_bfd.h"
 #include "gdbsupport/filestuff.h"
 #include "gdbsupport/rsp-low.h"
+#include "gdbsupport/rsp-compress.h"
+#include "gdbsupport/gdb_vecs.h"
 #include "disasm.h"
 #include "location.h"
 
@@ -325,6 +327,12 @@ enum {
   /* Support for the QThreadOptions packet.  */
   PACKET_QThreadOptions,
 
+  /* Support for the qThreadRegisters packet.  */
+  PACKET_qThreadRegisters,
+
+  /* Support for the QCompress packet.  */
+  PACKET_QCompress,
+
   /* Support for multi-process extensions.  */
   PACKET_multiprocess_feature,
 
@@ -579,6 +587,12 @@ class remote_state
      reliable.  */
   bool noack_mode = false;
 
+  /* True if the compression of packets has been enabled with the
+     QCompress packet.  Either side may then compress the data of the
+     packets it sends, with COMPRESSOR.  */
+  bool compress_mode = false;
+  rsp_compressor compressor;
+
   /* True if we're connected in extended remote mode.  */
   bool extended = false;
 
@@ -619,6 +633,12 @@ class remote_state
      It will be -1 if no traceframe is selected.  */
   int remote_traceframe_number = -1;
 
+  /* The thread whose registers we fetched first since the target was
+     last resumed in all-stop mode, or null_ptid.  Once the registers
+     of another thread are needed, those of all the stopped threads
+     are fetched in batches with the qThreadRegisters packet.  */
+  ptid_t first_fetched_regs_ptid = null_ptid;
+
   char *last_pass_packet = nullptr;
 
   /* The last QProgramSignals packet sent to the target.  We bypass
@@ -1302,6 +1322,9 @@ class remote_target : public process_stratum_target
   void remote_supported_thread_options (const protocol_feature *feature,
 					enum packet_support support,
 					const char *value);
+  void remote_supported_compress (const protocol_feature *feature,
+				  enum packet_support support,
+				  const char *value);
 
   void remote_serial_quit_handler ();
 
@@ -1322,6 +1345,8 @@ class remote_target : public process_stratum_target
   int send_g_packet ();
   void process_g_packet (struct regcache *regcache);
   void fetch_registers_using_g (struct regcache *regcache);
+  bool fetch_registers_using_qthreadregisters (struct regcache *regcache,
+					       int regnum);
   int store_register_using_P (const struct regcache *regcache,
 			      packet_reg *reg);
   void store_registers_using_G (const struct regcache *regcache);
@@ -5186,6 +5211,20 @@ remote_target::start_remote_1 (int from_tty, int extended_p)
 	rs->noack_mode = 1;
     }
 
+  /* Next, we possibly enable the compression of packets.  This is
+     driven by the QCompress packet configuration, like noack mode
+     above.  The stub starts compressing its replies once it has
+     acknowledged the packet.  */
+
+  if (m_features.packet_support (PACKET_QCompress) != PACKET_DISABLE)
+    {
+      putpkt (string_printf ("QCompress:%s", rsp_compress_method).c_str ());
+      getpkt (&rs->buf);
+      if ((m_features.packet_ok (rs->buf, PACKET_QCompress)).status ()
+	  == PACKET_OK)
+	rs->compress_mode = true;
+    }
+
   if (extended_p)
     {
       /* Tell the remote that we are using the extended protocol.  */
@@ -5734,6 +5773,34 @@ remote_supported_thread_options (remote_target *remote,
   remote->remote_supported_thread_options (feature, support, value);
 }
 
+void
+remote_target::remote_supported_compress (const protocol_feature *feature,
+					  enum packet_support support,
+					  const char *value)
+{
+  /* The stub reports the compression methods it supports as a
+     comma-separated list.  Only enable the packet if ours is one of
+     them.  */
+  if (support == PACKET_ENABLE)
+    {
+      support = PACKET_DISABLE;
+      if (value != nullptr)
+	for (const auto &method : delim_string_to_char_ptr_vec (value, ','))
+	  if (strcmp (method.get (), rsp_compress_method) == 0)
+	    support = PACKET_ENABLE;
+    }
+
+  m_features.m_protocol_packets[feature->packet].support = support;
+}
+
+static void
+remote_supported_compress (remote_target *remote,
+			   const protocol_feature *feature,
+			   enum packet_support support, const char *value)
+{
+  remote->remote_supported_compress (feature, support, value);
+}
+
 static const struct protocol_feature remote_protocol_features[] = {
   { "PacketSize", PACKET_DISABLE, remote_packet_size, -1 },
   { "qXfer:auxv:read", PACKET_DISABLE, remote_supported_packet,
@@ -5842,6 +5909,10 @@ static const struct protocol_feature remote_protocol_features[] = {
   { "QThreadEvents", PACKET_DISABLE, remote_supported_packet, PACKET_QThreadEvents },
   { "QThreadOptions", PACKET_DISABLE, remote_supported_thread_options,
     PACKET_QThreadOptions },
+  { "qThreadRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qThreadRegisters },
+  { "QCompress", PACKET_DISABLE, remote_supported_compress,
+    PACKET_QCompress },
   { "no-resumed", PACKET_DISABLE, remote_supported_packet, PACKET_no_resumed },
   { "memory-tagging", PACKET_DISABLE, remote_supported_packet,
     PACKET_memory_tagging_feature },
@@ -7056,6 +7127,8 @@ remote_target::resume (ptid_t scope_ptid, int step, enum gdb_signal siggnal)
 
   commit_requested_thread_options ();
 
+  rs->first_fetched_regs_ptid = null_ptid;
+
   /* In all-stop, we can't mark REMOTE_ASYNC_GET_PENDING_EVENTS_TOKEN
      (explained in remote-notif.c:handle_notification) so
      remote_notif_process is not called.  We need find a place where
@@ -9067,6 +9140,161 @@ remote_target::fetch_registers_using_g (struct regcache *regcache)
   process_g_packet (regcache);
 }
 
+/* Fetch the registers of REGCACHE's thread, together with those of the
+   other stopped threads of the same inferior that we have not fetched
+   yet, with a single qThreadRegisters packet.  This is only done once
+   the registers of a second thread are needed after an all-stop stop,
+   as when listing or backtracing all threads; while a single thread is
+   being stepped, its registers are fetched on their own.  Return true
+   if REGNUM, or all the registers if REGNUM is -1, were supplied to
+   REGCACHE.  */
+
+bool
+remote_target::fetch_registers_using_qthreadregisters
+  (struct regcache *regcache, int regnum)
+{
+  struct gdbarch *gdbarch = regcache->arch ();
+  struct remote_state *rs = get_remote_state ();
+  remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
+  ptid_t ptid = regcache->ptid ();
+
+  if (m_features.packet_support (PACKET_qThreadRegisters) == PACKET_DISABLE
+      || target_is_non_stop_p ()
+      || get_traceframe_number () != -1)
+    return false;
+
+  if (rs->first_fetched_regs_ptid == null_ptid
+      || rs->first_fetched_regs_ptid == ptid)
+    {
+      rs->first_fetched_regs_ptid = ptid;
+      return false;
+    }
+
+  /* Limit the batch to about as many threads as the stub can fit in
+     its reply; the others are fetched by the following batches.  */
+  long per_thread = (2 * rsa->sizeof_g_packet
+		     + 8 * gdbarch_num_regs (gdbarch) + 64);
+  long max_threads = std::max (1L, get_remote_packet_size () / per_thread);
+  int check_regnum = regnum >= 0 ? regnum : 0;
+
+  std::vector<std::pair<ptid_t, struct regcache *>> batch;
+  batch.emplace_back (ptid, regcache);
+  for (thread_info *tp : all_non_exited_threads (this, ptid_t (ptid.pid ())))
+    {
+      if ((long) batch.size () >= max_threads)
+	break;
+      if (tp->ptid == ptid || tp->executing ())
+	continue;
+
+      struct regcache *tp_regcache = get_thread_regcache (tp);
+      if (tp_regcache->arch () == gdbarch
+	  && tp_regcache->get_register_status (check_regnum) == REG_UNKNOWN)
+	batch.emplace_back (tp->ptid, tp_regcache);
+    }
+
+  char *p = rs->buf.data ();
+  char *endp = p + get_remote_packet_size ();
+  char sep = ':';
+
+  p += xsnprintf (p, endp - p, "qThreadRegisters:all");
+  for (const auto &entry : batch)
+    {
+      /* Room for a separator and the longest thread-id.  */
+      if (endp - p < 40)
+	break;
+      *p++ = sep;
+      sep = ';';
+      p = write_ptid (p, endp, entry.first);
+    }
+  *p = '\0';
+
+  putpkt (rs->buf);
+  getpkt (&rs->buf);
+
+  packet_result result = m_features.packet_ok (rs->buf,
+					       PACKET_qThreadRegisters);
+  if (result.status () != PACKET_OK)
+    return false;
+
+  /* The reply is a "thread:THREAD-ID;" for each thread, followed by an
+     "N:VALUE;" for each of its registers.  */
+  struct regcache *thread_regcache = nullptr;
+  const char *buf = rs->buf.data ();
+  const char *q = buf;
+  bool supplied = false;
+
+  while (*q != '\0')
+    {
+      if (startswith (q, "thread:"))
+	{
+	  ptid_t thread_ptid = read_ptid (q + strlen ("thread:"), &q);
+
+	  thread_regcache = nullptr;
+	  for (const auto &entry : batch)
+	    if (entry.first == thread_ptid)
+	      thread_regcache = entry.second;
+	}
+      else
+	{
+	  ULONGEST pnum;
+	  const char *value = unpack_varlen_hex (q, &pnum);
+
+	  if (*value != ':')
+	    error (_("Remote register badly formatted: %s\nhere: %s"),
+		   buf, q);
+
+	  /* Skip the registers we do not know about.  */
+	  packet_reg *reg = packet_reg_from_pnum (gdbarch, rsa, pnum);
+
+	  value++;
+	  q = strchrnul (value, ';');
+	  if (thread_regcache != nullptr && reg != nullptr)
+	    {
+	      int reg_size = register_size (gdbarch, reg->regnum);
+
+	      if (*value == 'x')
+		thread_regcache->raw_supply (reg->regnum, nullptr);
+	      else
+		{
+		  gdb::byte_vector data (reg_size);
+
+		  if (q - value != 2 * reg_size
+		      || hex2bin (value, data.data (), reg_size) != reg_size)
+		    error (_("Remote register badly formatted: %s\nhere: %s"),
+			   buf, value);
+		  thread_regcache->raw_supply (reg->regnum, data.data ());
+		}
+
+	      if (thread_regcache == regcache
+		  && (regnum == -1 || reg->regnum == regnum))
+		supplied = true;
+	    }
+	}
+
+      if (*q != ';')
+	error (_("Remote register badly formatted: %s\nhere: %s"), buf, q);
+      q++;
+    }
+
+  if (!supplied)
+    return false;
+
+  if (regnum == -1)
+    {
+      /* Registers the stub does not know about are not available;
+	 anything else missing must be fetched the usual way.  */
+      for (int i = 0; i < gdbarch_num_regs (gdbarch); i++)
+	if (regcache->get_register_status (i) == REG_UNKNOWN)
+	  {
+	    if (rsa->regs[i].pnum != -1)
+	      return false;
+	    regcache->raw_supply (i, nullptr);
+	  }
+    }
+
+  return true;
+}
+
 /* Make the remote selected traceframe match GDB's selected
    traceframe.  */
 
@@ -9099,6 +9327,10 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
   int i;
 
   set_remote_traceframe ();
+
+  if (fetch_registers_using_qthreadregisters (regcache, regnum))
+    return;
+
   set_general_thread (regcache->ptid ());
 
   if (regnum >= 0)
@@ -10107,6 +10339,30 @@ remote_target::putpkt_binary (const char *buf, int cnt)
   struct remote_state *rs = get_remote_state ();
   int i;
   unsigned char csum = 0;
+  std::string compressed;
+
+  if (rs->compress_mode && cnt >= rsp_compress_threshold
+      && rs->compressor.compress (buf, cnt, compressed))
+    {
+      if (remote_debug)
+	{
+	  int max_chars;
+
+	  if (remote_packet_max_chars < 0)
+	    max_chars = cnt;
+	  else
+	    max_chars = remote_packet_max_chars;
+
+	  remote_debug_printf_nofunc
+	    ("Compressing packet: %s [%d bytes compressed to %zu]",
+	     escape_buffer (buf, std::min (cnt, max_chars)).c_str (), cnt,
+	     compressed.size ());
+	}
+
+      buf = compressed.data ();
+      cnt = compressed.size ();
+    }
+
   gdb::def_vector<char> data (cnt + 6);
   char *buf2 = data.data ();
 
@@ -10524,6 +10780,32 @@ remote_target::getpkt (gdb::char_vector *buf, bool forever, bool *is_notif)
       /* If we got an ordinary packet, return that to our caller.  */
       if (c == '$')
 	{
+	  if (rs->compress_mode && val > 0
+	      && buf->data ()[0] == rsp_compress_marker)
+	    {
+	      std::string data;
+	      size_t max = std::max<size_t> (get_remote_packet_size (),
+					     buf->size ());
+
+	      remote_debug_printf_nofunc
+		("Compressed packet received, %d bytes", val);
+
+	      if (!rs->compressor.uncompress (buf->data (), val, data, max))
+		{
+		  /* The packet itself arrived intact, so acknowledge
+		     it before giving up.  */
+		  if (!rs->noack_mode)
+		    remote_serial_write ("+", 1);
+		  error (_("Remote sent a malformed compressed packet."));
+		}
+
+	      val = data.size ();
+	      if (data.size () >= buf->size ())
+		buf->resize (data.size () + 1);
+	      memcpy (buf->data (), data.data (), val);
+	      buf->data ()[val] = '\0';
+	    }
+
 	  if (remote_debug)
 	    {
 	      int max_chars;
@@ -16506,6 +16788,11 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (PACKET_QThreadOptions, "QThreadOptions",
 			 "thread-options", 0);
 
+  add_packet_config_cmd (PACKET_qThreadRegisters, "qThreadRegisters",
+			 "thread-registers", 0);
+
+  add_packet_config_cmd (PACKET_QCompress, "QCompress", "compress", 0);
+
   add_packet_config_cmd (PACKET_no_resumed, "N stop reply",
 			 "no-resumed-stop-reply", 0);
 
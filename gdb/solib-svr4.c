@@ -45,6 +45,7 @@
 #include "auxv.h"
 #include "gdb_bfd.h"
 #include "probe.h"
+#include "gdbsupport/unordered_map.h"
 
 #include <map>
 
@@ -405,6 +406,13 @@ struct svr4_info
      The special entry zero is reserved for a linear list to support
      gdbstubs that do not support namespaces.  */
   std::map<CORE_ADDR, std::vector<svr4_so>> solib_lists;
+
+  /* The namespace of each objfile that belongs to a DSO, as computed
+     by find_debug_bases_for_objfiles, or NULL if it must be computed
+     again.  It is reset whenever a DSO or an objfile is added or
+     removed.  */
+  std::shared_ptr<const gdb::unordered_map<const objfile *, CORE_ADDR>>
+    objfile_debug_bases;
 };
 
 /* Per-program-space data key.  */
@@ -440,6 +448,17 @@ get_svr4_info (program_space *pspace)
   return info;
 }
 
+/* Forget the namespaces of the objfiles of PSPACE.  */
+
+static void
+svr4_reset_objfile_debug_bases (program_space *pspace)
+{
+  svr4_info *info = solib_svr4_pspace_data.get (pspace);
+
+  if (info != nullptr)
+    info->objfile_debug_bases.reset ();
+}
+
 /* Local function prototypes */
 
 static int match_main (const char *);
@@ -976,6 +995,31 @@ static void
 svr4_free_objfile_observer (struct objfile *objfile)
 {
   probes_table_remove_objfile_probes (objfile);
+  svr4_reset_objfile_debug_bases (objfile->pspace ());
+}
+
+/* Implement the "new_objfile" observer.  */
+
+static void
+svr4_new_objfile_observer (struct objfile *objfile)
+{
+  svr4_reset_objfile_debug_bases (objfile->pspace ());
+}
+
+/* Implement the "solib_loaded" observer.  */
+
+static void
+svr4_solib_loaded_observer (solib &so)
+{
+  svr4_reset_objfile_debug_bases (current_program_space);
+}
+
+/* Implement the "solib_unloaded" observer.  */
+
+static void
+svr4_solib_unloaded_observer (program_space *pspace, const solib &so)
+{
+  svr4_reset_objfile_debug_bases (pspace);
 }
 
 /* Implement solib_ops.clear_so.  */
@@ -3234,26 +3278,6 @@ svr4_lp64_fetch_link_map_offsets (void)
 }
 
 
-/* Return the DSO matching OBJFILE or nullptr if none can be found.  */
-
-static const solib *
-find_solib_for_objfile (struct objfile *objfile)
-{
-  if (objfile == nullptr)
-    return nullptr;
-
-  /* If OBJFILE is a separate debug object file, look for the original
-     object file.  */
-  if (objfile->separate_debug_objfile_backlink != nullptr)
-    objfile = objfile->separate_debug_objfile_backlink;
-
-  for (const solib &so : current_program_space->solibs ())
-    if (so.objfile == objfile)
-      return &so;
-
-  return nullptr;
-}
-
 /* Return the address of the r_debug object for the namespace containing
    SOLIB or zero if it cannot be found.  This may happen when symbol files
    are added manually, for example, or with the main executable.
@@ -3287,6 +3311,69 @@ find_debug_base_for_solib (const solib *solib)
   return 0;
 }
 
+/* Return the address of the r_debug object for the namespace of each
+   objfile of the current program space that belongs to a DSO, as
+   find_debug_base_for_solib would, with zero meaning the initial
+   namespace.  Symbol lookups go through all the objfiles, so finding
+   the namespace of each of them in turn would take time quadratic in
+   the number of DSOs, for every lookup.  The result is kept until a
+   DSO or an objfile is added or removed; the caller's reference keeps
+   it alive past that.  */
+
+static std::shared_ptr<const gdb::unordered_map<const objfile *, CORE_ADDR>>
+find_debug_bases_for_objfiles ()
+{
+  svr4_info *info = get_svr4_info (current_program_space);
+  gdb_assert (info != nullptr);
+
+  if (info->objfile_debug_bases != nullptr)
+    return info->objfile_debug_bases;
+
+  /* The lists of the inferior's DSOs, indexed by name, and each giving
+     the relocation offset and the namespace of the DSO.  The first list
+     with a DSO wins, as in find_debug_base_for_solib.  */
+  gdb::unordered_map<std::string_view,
+		     std::vector<std::pair<CORE_ADDR, CORE_ADDR>>> inferior_sos;
+  for (const auto &tuple : info->solib_lists)
+    for (const svr4_so &so : tuple.second)
+      inferior_sos[so.name].emplace_back (so.lm_info->l_addr_inferior,
+					  tuple.first);
+
+  auto bases
+    = std::make_shared<gdb::unordered_map<const objfile *, CORE_ADDR>> ();
+  for (const solib &so : current_program_space->solibs ())
+    {
+      /* The first DSO with an objfile wins.  */
+      if (so.objfile == nullptr || bases->find (so.objfile) != bases->end ())
+	continue;
+
+      auto *lm_info
+	= gdb::checked_static_cast<const lm_info_svr4 *> (so.lm_info.get ());
+      CORE_ADDR debug_base = 0;
+      bool found = false;
+
+      auto it = inferior_sos.find (so.so_original_name);
+      if (it != inferior_sos.end ())
+	for (const auto &[l_addr_inferior, base] : it->second)
+	  if (l_addr_inferior == lm_info->l_addr_inferior)
+	    {
+	      debug_base = base;
+	      found = true;
+	      break;
+	    }
+
+      /* svr4_same also matches some dynamic linkers under another
+	 name.  */
+      if (!found)
+	debug_base = find_debug_base_for_solib (&so);
+
+      bases->emplace (so.objfile, debug_base);
+    }
+
+  info->objfile_debug_bases = bases;
+  return bases;
+}
+
 /* Search order for ELF DSOs linked with -Bsymbolic.  Those DSOs have a
    different rule for symbol lookup.  The lookup begins here in the DSO,
    not in the main executable.  When starting from CURRENT_OBJFILE, we
@@ -3320,31 +3407,40 @@ svr4_iterate_over_objfiles_in_search_order
 	}
     }
 
+  std::shared_ptr<const gdb::unordered_map<const objfile *, CORE_ADDR>> bases
+    = find_debug_bases_for_objfiles ();
+
+  /* Return the namespace into which OBJFILE was loaded.
+
+     If we fail to determine it, e.g. for manually added symbol files or
+     for the main executable, we assume that OBJFILE was added to the
+     initial namespace.  */
+  CORE_ADDR initial = elf_locate_base ();
+  auto find_debug_base = [&] (const objfile *objfile)
+    {
+      if (objfile == nullptr)
+	return initial;
+
+      if (objfile->separate_debug_objfile_backlink != nullptr)
+	objfile = objfile->separate_debug_objfile_backlink;
+
+      auto it = bases->find (objfile);
+      if (it == bases->end () || it->second == 0)
+	return initial;
+      return it->second;
+    };
+
   /* The linker namespace to iterate identified by the address of its
      r_debug object, defaulting to the initial namespace.  */
-  CORE_ADDR initial = elf_locate_base ();
-  const solib *curr_solib = find_solib_for_objfile (current_objfile);
-  CORE_ADDR debug_base = find_debug_base_for_solib (curr_solib);
-  if (debug_base == 0)
-    debug_base = initial;
+  CORE_ADDR debug_base = find_debug_base (current_objfile);
 
   for (objfile *objfile : current_program_space->objfiles ())
     {
       if (checked_current_objfile && objfile == current_objfile)
 	continue;
 
-      /* Try to determine the namespace into which objfile was loaded.
-
-	 If we fail, e.g. for manually added symbol files or for the main
-	 executable, we assume that they were added to the initial
-	 namespace.  */
-      const solib *solib = find_solib_for_objfile (objfile);
-      CORE_ADDR solib_base = find_debug_base_for_solib (solib);
-      if (solib_base == 0)
-	solib_base = initial;
-
       /* Ignore objfiles that were added to a different namespace.  */
-      if (solib_base != debug_base)
+      if (find_debug_base (objfile) != debug_base)
 	continue;
 
       if (cb (objfile))
@@ -3384,4 +3480,10 @@ _initialize_svr4_solib ()
 {
   gdb::observers::free_objfile.attach (svr4_free_objfile_observer,
 				       "solib-svr4");
+  gdb::observers::new_objfile.attach (svr4_new_objfile_observer,
+				      "solib-svr4");
+  gdb::observers::solib_loaded.attach (svr4_solib_loaded_observer,
+				       "solib-svr4");
+  gdb::observers::solib_unloaded.attach (svr4_solib_unloaded_observer,
+					 "solib-svr4");
 }
@@ -0,0 +1,67 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+
+#define NTHREADS 4
+
+__thread int tls_var = -1;
+
+static pthread_barrier_t barrier;
+
+volatile int result;
+
+void
+hbreak_here (void)
+{
+  result++;
+}
+
+void
+all_threads_ready (void)
+{
+}
+
+static void *
+thread_func (void *arg)
+{
+  tls_var = (int) (long) arg;
+  pthread_barrier_wait (&barrier);
+  pthread_barrier_wait (&barrier);
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  int i;
+
+  tls_var = 0;
+  pthread_barrier_init (&barrier, NULL, NTHREADS + 1);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, thread_func, (void *) (long) (i + 1));
+  pthread_barrier_wait (&barrier);
+  all_threads_ready ();
+  pthread_barrier_wait (&barrier);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  result = 0;
+  hbreak_here ();		/* call hbreak_here */
+  return result;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2025 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Write a data file, whose name is the first argument, and map it
+   read-only.  The data file has no build-id, and its mapping is not
+   dumped to the core file, so that GDB reads its contents from the
+   file, which it only opens when they are first needed.  */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define MAPPED_SIZE (4 * 4096)
+
+const char *mapped;
+
+/* Written by the program, so dumped to the core file.  */
+char core_data[4 * 4096];
+
+int
+main (int argc, char **argv)
+{
+  int fd, i;
+
+  if (argc < 2)
+    return 1;
+
+  for (i = 0; i < sizeof (core_data); i++)
+    core_data[i] = 'A' + i % 26;
+
+  fd = open (argv[1], O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 1;
+  if (write (fd, core_data, MAPPED_SIZE) != MAPPED_SIZE)
+    return 1;
+  for (i = 0; i < sizeof (core_data); i++)
+    core_data[i] = 'a' + i % 26;
+
+  mapped = mmap (NULL, MAPPED_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED)
+    return 1;
+  close (fd);
+
+  return 0; /* break here */
+}
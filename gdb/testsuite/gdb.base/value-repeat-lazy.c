@@ -0,0 +1,46 @@
+/* Copyright 2025 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define BIG_SIZE 100000
+
+/* Larger than the default max-value-size.  */
+int big[BIG_SIZE];
+
+int small[4] = { 1, 2, 3, 4 };
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < BIG_SIZE; i++)
+    big[i] = i;
+
+  marker ();
+
+  small[0] = 10;
+  big[1] = 11;
+
+  marker ();
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+/* Copyright 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* An FDE whose CIE pointer is past the end of .debug_frame.  This file
+   is linked last, so the FDE follows any other entries of the
+   section.  */
+
+asm (".pushsection .debug_frame, \"\", %progbits\n"
+     ".balign 8\n"
+     ".4byte 12\n"		/* Length.  */
+     ".4byte 0xfffffff0\n"	/* CIE pointer.  */
+     ".8byte 0\n"		/* Initial location and range.  */
+     ".popsection");
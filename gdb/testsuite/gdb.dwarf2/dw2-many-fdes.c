@@ -0,0 +1,62 @@
+/* Copyright 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* 200 functions, func_10 to func_209, each with its own FDE.  main
+   calls func_10, which calls func_11, and so on up to func_209, which
+   calls stop.  */
+
+#define N_FUNCS 200
+
+#define DECADE(X, d) \
+  X (d##0) X (d##1) X (d##2) X (d##3) X (d##4) \
+  X (d##5) X (d##6) X (d##7) X (d##8) X (d##9)
+
+#define ALL_FUNCS(X) \
+  DECADE (X, 1) DECADE (X, 2) DECADE (X, 3) DECADE (X, 4) \
+  DECADE (X, 5) DECADE (X, 6) DECADE (X, 7) DECADE (X, 8) \
+  DECADE (X, 9) DECADE (X, 10) DECADE (X, 11) DECADE (X, 12) \
+  DECADE (X, 13) DECADE (X, 14) DECADE (X, 15) DECADE (X, 16) \
+  DECADE (X, 17) DECADE (X, 18) DECADE (X, 19) DECADE (X, 20)
+
+#define DECLARE(n) int func_##n (int);
+#define ENTRY(n) func_##n,
+#define DEFINE(n)				\
+  int __attribute__ ((noinline))		\
+  func_##n (int depth)				\
+  {						\
+    if (depth < N_FUNCS)			\
+      return funcs[depth] (depth + 1) + 1;	\
+    return stop ();				\
+  }
+
+volatile int counter;
+
+int __attribute__ ((noinline))
+stop (void)
+{
+  return counter;
+}
+
+ALL_FUNCS (DECLARE)
+
+static int (*const funcs[]) (int) = { ALL_FUNCS (ENTRY) };
+
+ALL_FUNCS (DEFINE)
+
+int
+main (void)
+{
+  return funcs[0] (1);
+}
@@ -0,0 +1,69 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Larger than a chunk of the log, so that reading into it logs a
+   memory entry that needs a chunk of its own.  */
+#define BUF_SIZE (100 * 1024)
+
+/* Enough iterations to fill several chunks of the log.  */
+#define LOOP_COUNT 3000
+
+char buf[BUF_SIZE] = { 1 };
+
+volatile int counter;
+
+void
+marker1 (void)
+{
+}
+
+void
+marker2 (void)
+{
+}
+
+void
+marker3 (void)
+{
+}
+
+int
+main (void)
+{
+  int fd, i;
+
+  buf[BUF_SIZE - 1] = 2;
+  fd = open ("/dev/zero", O_RDONLY);
+
+  /* Start recording here.  */
+  marker1 ();
+
+  read (fd, buf, BUF_SIZE);
+
+  marker2 ();
+
+  for (i = 0; i < LOOP_COUNT; i++)
+    counter += 1;
+
+  marker3 ();
+
+  close (fd);
+  return 0;
+}
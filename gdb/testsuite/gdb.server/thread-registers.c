@@ -0,0 +1,85 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* The number of threads to create.  */
+#define THREAD_COUNT 8
+
+/* Held by main, so that the threads block on it for good.  */
+static pthread_mutex_t block_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* The number of threads that have reached the bottom of their
+   recursion, and the lock guarding it.  */
+static int started;
+static pthread_mutex_t started_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Each thread recurses this deep, so that backtraces need more than
+   the registers of the innermost frame.  */
+static int depth = 3;
+
+/* Just somewhere to put a breakpoint.  */
+static void
+breakpt (void)
+{
+}
+
+static void
+recurse (int n)
+{
+  if (n > 0)
+    recurse (n - 1);
+  else
+    {
+      pthread_mutex_lock (&started_mutex);
+      started++;
+      pthread_mutex_unlock (&started_mutex);
+      pthread_mutex_lock (&block_mutex);
+    }
+}
+
+static void *
+thread_func (void *arg)
+{
+  recurse (depth);
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[THREAD_COUNT];
+  int i, n;
+
+  pthread_mutex_lock (&block_mutex);
+  for (i = 0; i < THREAD_COUNT; i++)
+    pthread_create (&threads[i], NULL, thread_func, NULL);
+
+  do
+    {
+      usleep (1000);
+      pthread_mutex_lock (&started_mutex);
+      n = started;
+      pthread_mutex_unlock (&started_mutex);
+    }
+  while (n < THREAD_COUNT);
+
+  breakpt ();
+
+  return 0;
+}
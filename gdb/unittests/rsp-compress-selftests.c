@@ -0,0 +1,89 @@
+/* Unit tests for the rsp-compress.cc file.
+
+   Copyright (C) 2025 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "gdbsupport/selftest.h"
+#include "gdbsupport/rsp-compress.h"
+
+namespace selftests {
+namespace rsp_compress {
+
+/* Test that packets survive compression, and that the compressed
+   data is safe to put in a packet.  */
+
+static void test_round_trip ()
+{
+  rsp_compressor sender, receiver;
+  std::string packet, compressed, uncompressed;
+
+  /* A short packet that does not compress is sent as it is.  */
+  SELF_CHECK (!sender.compress ("OK", 2, compressed));
+
+  /* A typical qXfer reply.  */
+  packet = "l<?xml version=\"1.0\"?>\n<threads>\n";
+  for (int i = 0; i < 100; i++)
+    packet += string_printf ("<thread id=\"p1f2a.%x\" core=\"%d\""
+			     " name=\"a.out\"/>\n", 0x1f2a + i, i % 4);
+  packet += "</threads>\n";
+
+  SELF_CHECK (sender.compress (packet.data (), packet.size (), compressed));
+  SELF_CHECK (compressed.size () < packet.size () / 4);
+  SELF_CHECK (compressed[0] == rsp_compress_marker);
+  SELF_CHECK (compressed.find_first_of ("$#*") == std::string::npos);
+  SELF_CHECK (receiver.uncompress (compressed.data (), compressed.size (),
+				   uncompressed, packet.size ()));
+  SELF_CHECK (uncompressed == packet);
+
+  /* Binary data with every byte value, repeated so that it
+     compresses.  The streams are reused for the second packet.  */
+  packet.clear ();
+  for (int i = 0; i < 4096; i++)
+    packet += (char) (i % 256);
+
+  SELF_CHECK (sender.compress (packet.data (), packet.size (), compressed));
+  SELF_CHECK (compressed.find_first_of ("$#*") == std::string::npos);
+  SELF_CHECK (receiver.uncompress (compressed.data (), compressed.size (),
+				   uncompressed, packet.size ()));
+  SELF_CHECK (uncompressed == packet);
+
+  /* A packet that uncompresses to more than the maximum is
+     rejected.  */
+  SELF_CHECK (!receiver.uncompress (compressed.data (), compressed.size (),
+				    uncompressed, packet.size () - 1));
+
+  /* So is a truncated one.  */
+  SELF_CHECK (!receiver.uncompress (compressed.data (),
+				    compressed.size () / 2,
+				    uncompressed, packet.size ()));
+
+  /* And so is one that ends in an unmatched escape character.  */
+  compressed = std::string (1, rsp_compress_marker) + "}";
+  SELF_CHECK (!receiver.uncompress (compressed.data (), compressed.size (),
+				    uncompressed, packet.size ()));
+}
+
+} /* namespace rsp_compress */
+} /* namespace selftests */
+
+void _initialize_rsp_compress_selftests ();
+void
+_initialize_rsp_compress_selftests ()
+{
+  selftests::register_test ("rsp_compress_round_trip",
+			    selftests::rsp_compress::test_round_trip);
+}
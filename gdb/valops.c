@@ -1364,15 +1364,16 @@ value_repeat (struct value *arg1, int count)
   if (count < 1)
     error (_("Invalid number %d of repetitions."), count);
 
-  val = allocate_repeat_value (arg1->enclosing_type (), count);
+  /* Like any other value in memory, the result is lazy, so that only
+     the parts of a large array that are actually used are read, e.g.
+     by subscripting it, or when printing a limited number of its
+     elements.  */
+  val = value::allocate_lazy (repeat_value_type (arg1->enclosing_type (),
+						 count));
 
   val->set_lval (lval_memory);
   val->set_address (arg1->address ());
 
-  read_value_memory (val, 0, val->stack (), val->address (),
-		     val->contents_all_raw ().data (),
-		     type_length_units (val->enclosing_type ()));
-
   return val;
 }
 
@@ -934,7 +934,26 @@ value::allocate_contents (bool check_size)
 	    check_type_length_before_alloc (enc_type);
 	}
 
-      m_contents.reset ((gdb_byte *) xzalloc (len));
+      m_contents.reset ((gdb_byte *) xzalloc (len),
+		        gdb::xfree_deleter<gdb_byte> ());
+    }
+}
+
+/* See value.h.  */
+
+void
+value::unshare_contents ()
+{
+  if (m_contents.use_count () > 1)
+    {
+      ULONGEST length = m_limited_length;
+      if (length == 0)
+	length = enclosing_type ()->length ();
+
+      gdb::unique_xmalloc_ptr<gdb_byte> contents
+	((gdb_byte *) xmalloc (length));
+      memcpy (contents.get (), m_contents.get (), length);
+      m_contents = std::move (contents);
     }
 }
 
@@ -1001,11 +1020,10 @@ value::allocate_register (const frame_info_ptr &next_frame, int regnum,
   return result;
 }
 
-/* Allocate a  value  that has the correct length
-   for COUNT repetitions of type TYPE.  */
+/* See value.h.  */
 
-struct value *
-allocate_repeat_value (struct type *type, int count)
+struct type *
+repeat_value_type (struct type *type, int count)
 {
   /* Despite the fact that we are really creating an array of TYPE here, we
      use the string lower bound as the array lower bound.  This seems to
@@ -1013,10 +1031,16 @@ allocate_repeat_value (struct type *type, int count)
   int low_bound = current_language->string_lower_bound ();
   /* FIXME-type-allocation: need a way to free this type when we are
      done with it.  */
-  struct type *array_type
-    = lookup_array_range_type (type, low_bound, count + low_bound - 1);
+  return lookup_array_range_type (type, low_bound, count + low_bound - 1);
+}
 
-  return value::allocate (array_type);
+/* Allocate a  value  that has the correct length
+   for COUNT repetitions of type TYPE.  */
+
+struct value *
+allocate_repeat_value (struct type *type, int count)
+{
+  return value::allocate (repeat_value_type (type, count));
 }
 
 struct value *
@@ -1053,6 +1077,7 @@ value::contents_raw ()
   int unit_size = gdbarch_addressable_memory_unit_size (arch ());
 
   allocate_contents (true);
+  unshare_contents ();
 
   ULONGEST length = type ()->length ();
   return gdb::make_array_view
@@ -1063,6 +1088,7 @@ gdb::array_view<gdb_byte>
 value::contents_all_raw ()
 {
   allocate_contents (true);
+  unshare_contents ();
 
   ULONGEST length = enclosing_type ()->length ();
   return gdb::make_array_view (m_contents.get (), length);
@@ -1550,19 +1576,11 @@ value::copy () const
       && !(val->entirely_optimized_out ()
 	   || val->entirely_unavailable ()))
     {
-      ULONGEST length = val->m_limited_length;
-      if (length == 0)
-	length = val->enclosing_type ()->length ();
-
+      /* Share the contents rather than copying them now; whichever
+	 value is modified first makes its own copy.  Copying a large
+	 value, e.g. from the value history, is then cheap.  */
       gdb_assert (m_contents != nullptr);
-      const auto &arg_view
-	= gdb::make_array_view (m_contents.get (), length);
-
-      val->allocate_contents (false);
-      gdb::array_view<gdb_byte> val_contents
-	= val->contents_all_raw ().slice (0, length);
-
-      gdb::copy (arg_view, val_contents);
+      val->m_contents = m_contents;
     }
 
   if (val->lval () == lval_computed)
@@ -3006,8 +3024,17 @@ value::set_enclosing_type (struct type *new_encl_type)
   if (new_encl_type->length () > enclosing_type ()->length ())
     {
       check_type_length_before_alloc (new_encl_type);
-      m_contents.reset ((gdb_byte *) xrealloc (m_contents.release (),
-					       new_encl_type->length ()));
+      if (m_contents != nullptr)
+	{
+	  ULONGEST length = m_limited_length;
+	  if (length == 0)
+	    length = enclosing_type ()->length ();
+
+	  gdb::unique_xmalloc_ptr<gdb_byte> contents
+	    ((gdb_byte *) xmalloc (new_encl_type->length ()));
+	  memcpy (contents.get (), m_contents.get (), length);
+	  m_contents = std::move (contents);
+	}
     }
 
   m_enclosing_type = new_encl_type;
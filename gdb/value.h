@@ -792,8 +792,12 @@ struct value
   /* Actual contents of the value.  Target byte-order.
 
      May be nullptr if the value is lazy or is entirely optimized out.
-     Guaranteed to be non-nullptr otherwise.  */
-  gdb::unique_xmalloc_ptr<gdb_byte> m_contents;
+     Guaranteed to be non-nullptr otherwise.
+
+     The contents are shared between a value and its copies (see
+     value::copy), until one of them needs to modify them; see
+     unshare_contents.  */
+  std::shared_ptr<gdb_byte> m_contents;
 
   /* Unavailable ranges in CONTENTS.  We mark unavailable ranges,
      rather than available, since the common and default case is for a
@@ -844,6 +848,10 @@ struct value
      checks.  */
   void allocate_contents (bool check_size);
 
+  /* If the contents of this value are shared with other values, give
+     this value its own copy of them, so that they can be modified.  */
+  void unshare_contents ();
+
   /* Helper function for value_contents_eq.  The only difference is that
      this function is bit rather than byte based.
 
@@ -1164,6 +1172,11 @@ extern struct value *read_var_value (struct symbol *var,
 				     const struct block *var_block,
 				     const frame_info_ptr &frame);
 
+/* Return the type of an array of COUNT repetitions of type TYPE, as
+   created by the "@" operator.  */
+
+extern struct type *repeat_value_type (struct type *type, int count);
+
 extern struct value *allocate_repeat_value (struct type *type, int count);
 
 extern struct value *value_mark (void);
@@ -55,6 +55,12 @@ struct x86_linux_nat_target : public x86_nat_target<linux_nat_target>
   bool stopped_data_address (CORE_ADDR *addr_p) override
   { return linux_nat_target::stopped_data_address (addr_p); }
 
+  /* Likewise, linux-nat.c records whether an lwp stopped for a
+     hardware breakpoint, from its siginfo, so there is no need to read
+     the debug status register again.  */
+  bool stopped_by_hw_breakpoint () override
+  { return linux_nat_target::stopped_by_hw_breakpoint (); }
+
   bool low_stopped_by_watchpoint () override
   { return x86_nat_target::stopped_by_watchpoint (); }
 
@@ -26,6 +26,7 @@
 #include "dll.h"
 #include "gdbsupport/common-gdbthread.h"
 #include "gdbsupport/rsp-low.h"
+#include "gdbsupport/rsp-compress.h"
 #include "gdbsupport/scope-exit.h"
 #include "gdbsupport/netstuff.h"
 #include "gdbsupport/filestuff.h"
@@ -625,6 +626,11 @@ read_prim (void *buf, int count)
     return read (remote_desc, buf, count);
 }
 
+/* The state of the compression of packets, once GDB has enabled it
+   with the QCompress packet.  */
+
+static rsp_compressor compressor;
+
 /* Send a packet to the remote machine, with error checking.
    The data of the packet is in BUF, and the length of the
    packet is in CNT.  Returns >= 0 on success, -1 otherwise.  */
@@ -638,9 +644,21 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
   char *buf2;
   char *p;
   int cc;
+  std::string compressed;
 
   SCOPE_EXIT { suppressed_remote_debug = false; };
 
+  /* Notifications are never compressed, as GDB may read them while
+     it waits for an ack.  */
+  if (cs.compress_mode && !is_notif && cnt >= rsp_compress_threshold
+      && compressor.compress (buf, cnt, compressed))
+    {
+      remote_debug_printf ("putpkt: compressed %d bytes to %d", cnt,
+			   (int) compressed.size ());
+      buf = compressed.data ();
+      cnt = compressed.size ();
+    }
+
   buf2 = (char *) xmalloc (strlen ("$") + cnt + strlen ("#nn") + 1);
 
   /* Copy the packet into buffer BUF2, encapsulating it
@@ -997,6 +1015,25 @@ getpkt (char *buf)
   else
     remote_debug_printf ("getpkt (\"%s\");  [no ack sent]", buf);
 
+  int len = bp - buf;
+
+  if (cs.compress_mode && len > 0 && buf[0] == rsp_compress_marker)
+    {
+      std::string data;
+
+      if (!compressor.uncompress (buf, len, data, PBUFSIZ))
+	{
+	  fprintf (stderr, "Malformed compressed packet\n");
+	  return -1;
+	}
+
+      len = data.size ();
+      memcpy (buf, data.data (), len);
+      buf[len] = '\0';
+
+      remote_debug_printf ("getpkt: uncompressed (\"%s\")", buf);
+    }
+
   /* The readchar above may have already read a '\003' out of the socket
      and moved it to the local buffer.  For example, when GDB sends
      vCont;c immediately followed by interrupt (see
@@ -1013,7 +1050,7 @@ getpkt (char *buf)
       the_target->request_interrupt ();
     }
 
-  return bp - buf;
+  return len;
 }
 
 void
@@ -1038,7 +1075,9 @@ write_enn (char *buf)
 
 #ifndef IN_PROCESS_AGENT
 
-static char *
+/* See remote-utils.h.  */
+
+char *
 outreg (struct regcache *regcache, int regno, char *buf)
 {
   if ((regno >> 12) != 0)
@@ -43,6 +43,11 @@ void check_remote_input_interrupt_request (void);
 void prepare_resume_reply (char *buf, ptid_t ptid,
 			   const target_waitstatus &status);
 
+/* Write register REGNO of REGCACHE to BUF as "REGNO:VALUE;", the way
+   registers are expedited in stop replies.  Return the end of what was
+   written.  */
+char *outreg (struct regcache *regcache, int regno, char *buf);
+
 const char *decode_address_to_semicolon (CORE_ADDR *addrp, const char *start);
 void decode_address (CORE_ADDR *addrp, const char *start, int len);
 
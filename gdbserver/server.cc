@@ -21,6 +21,7 @@
 #include "notif.h"
 #include "tdesc.h"
 #include "gdbsupport/rsp-low.h"
+#include "gdbsupport/rsp-compress.h"
 #include "gdbsupport/signals-state-save-restore.h"
 #include <ctype.h>
 #include <unistd.h>
@@ -815,6 +816,26 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (startswith (own_buf, "QCompress:"))
+    {
+      const char *method = own_buf + strlen ("QCompress:");
+
+      if (strcmp (method, rsp_compress_method) != 0)
+	{
+	  /* We don't know this method, so complain to GDB.  */
+	  fprintf (stderr, "Unknown compression method requested: %s\n",
+		   own_buf);
+	  write_enn (own_buf);
+	  return;
+	}
+
+      remote_debug_printf ("[packet compression enabled]");
+
+      cs.compress_mode = true;
+      write_ok (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "QNonStop:"))
     {
       char *mode = own_buf + 9;
@@ -2472,6 +2493,92 @@ parse_fetch_memtags_request (char *request, CORE_ADDR *addr, size_t *len,
   *type = (int) tag_type;
 }
 
+/* Handle "qThreadRegisters:KIND:THREAD-ID[;THREAD-ID]...".  Reply with
+   "thread:THREAD-ID;" followed by "REGNO:VALUE;" for each register, for
+   as many of the requested threads as fit in OWN_BUF, in the order they
+   were requested.  KIND is "all" for all the registers, or "expedited"
+   for those sent in stop replies.  Threads that are gone or running are
+   left out.  */
+
+static void
+handle_qthreadregisters (char *own_buf)
+{
+  const char *p = own_buf + strlen ("qThreadRegisters:");
+  bool expedited;
+
+  if (startswith (p, "all:"))
+    expedited = false;
+  else if (startswith (p, "expedited:"))
+    expedited = true;
+  else
+    {
+      write_enn (own_buf);
+      return;
+    }
+  p = strchr (p, ':') + 1;
+
+  /* The reply is written over the request, so parse it all first.  */
+  std::vector<ptid_t> ptids;
+  while (true)
+    {
+      ptids.push_back (read_ptid (p, &p));
+      if (*p == '\0')
+	break;
+      if (*p != ';')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p++;
+    }
+
+  char *buf = own_buf;
+  char *end = own_buf + PBUFSIZ - 1;
+
+  for (ptid_t ptid : ptids)
+    {
+      thread_info *thread = find_thread_ptid (ptid);
+
+      if (thread == nullptr
+	  || (the_target->supports_thread_stopped ()
+	      && !target_thread_stopped (thread)))
+	continue;
+
+      /* The regcache is filled from the target once per stop, and is
+	 reused by later 'g' and 'p' packets for the same thread.  */
+      regcache *regcache = get_thread_regcache (thread);
+      const target_desc *tdesc = regcache->tdesc;
+      std::vector<int> regnos;
+
+      if (expedited)
+	for (const std::string &expedited_reg : tdesc->expedite_regs)
+	  regnos.push_back (find_regno (tdesc, expedited_reg.c_str ()));
+      else
+	for (int i = 0; i < tdesc->reg_defs.size (); i++)
+	  if (register_size (tdesc, i) > 0)
+	    regnos.push_back (i);
+
+      /* Room for "thread:THREAD-ID;", and for each register its number,
+	 value and separators.  */
+      long needed = 64;
+      for (int regno : regnos)
+	needed += 2 * register_size (tdesc, regno) + 6;
+      if (end - buf < needed)
+	break;
+
+      buf += sprintf (buf, "thread:");
+      buf = write_ptid (buf, ptid);
+      *buf++ = ';';
+      for (int regno : regnos)
+	buf = outreg (regcache, regno, buf);
+    }
+
+  if (buf == own_buf)
+    write_enn (own_buf);
+  else
+    *buf = '\0';
+}
+
 /* Add supported btrace packets to BUF.  */
 
 static void
@@ -2792,6 +2899,11 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (cs.transport_is_reliable)
 	strcat (own_buf, ";QStartNoAckMode+");
 
+      {
+	char *end_buf = own_buf + strlen (own_buf);
+	sprintf (end_buf, ";QCompress=%s", rsp_compress_method);
+      }
+
       if (the_target->supports_qxfer_osdata ())
 	strcat (own_buf, ";qXfer:osdata:read+");
 
@@ -2864,6 +2976,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 
       strcat (own_buf, ";QThreadEvents+");
 
+      strcat (own_buf, ";qThreadRegisters+");
+
       strcat (own_buf, ";no-resumed+");
 
       if (target_supports_memory_tagging ())
@@ -2876,6 +2990,16 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (startswith (own_buf, "qThreadRegisters:"))
+    {
+      require_running_or_return (own_buf);
+      if (cs.current_traceframe >= 0)
+	write_enn (own_buf);
+      else
+	handle_qthreadregisters (own_buf);
+      return;
+    }
+
   /* Thread-local storage support.  */
   if (the_target->supports_get_tls_address ()
       && startswith (own_buf, "qGetTLSAddr:"))
@@ -4393,6 +4517,7 @@ captured_main (int argc, char *argv[])
   while (1)
     {
       cs.noack_mode = 0;
+      cs.compress_mode = false;
       cs.multi_process = 0;
       cs.report_fork_events = 0;
       cs.report_vfork_events = 0;
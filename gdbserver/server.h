@@ -180,6 +180,9 @@ struct client_state
 
   /* If true, then GDB has requested noack mode.  */
   int noack_mode = 0;
+  /* If true, then GDB has enabled the compression of packets with
+     the QCompress packet.  */
+  bool compress_mode = false;
   /* If true, then we tell GDB to use noack mode by default.  */
   int transport_is_reliable = 0;
 
@@ -0,0 +1,223 @@
+/* Compression of remote protocol packets.
+
+   Copyright (C) 2025 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "rsp-compress.h"
+#include "rsp-low.h"
+#include "byte-vector.h"
+#include <zlib.h>
+
+/* See rsp-compress.h.  */
+
+const char rsp_compress_method[] = "zlib";
+
+/* The preset dictionary shared by both ends of the connection.  It
+   holds strings that are common in the large packets: the XML
+   documents read with qXfer, stop replies, and the start of ELF
+   files read with vFile:pread.  Deflate finds matches most cheaply
+   near the end of the dictionary, so the most frequent strings come
+   last.  */
+
+static const char dictionary[] =
+  "\177ELF\002\001\001\000\000\000\000\000\000\000\000\000"
+  "\003\000>\000\001\000\000\000"
+  ".shstrtab.interp.note.gnu.build-id.gnu.hash.dynsym.dynstr"
+  ".gnu.version.gnu.version_r.rela.dyn.rela.plt.init.plt.text.fini"
+  ".rodata.eh_frame_hdr.eh_frame.init_array.fini_array.dynamic.got"
+  ".data.bss.comment.debug_info.debug_abbrev.debug_line.debug_str"
+  "<?xml version=\"1.0\"?>\n"
+  "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+  "<target><architecture>i386:x86-64</architecture>"
+  "<osabi>GNU/Linux</osabi>"
+  "<xi:include href=\"64bit-core.xml\"/>"
+  "<feature name=\"org.gnu.gdb.i386.core\">"
+  "<feature name=\"org.gnu.gdb.i386.sse\">"
+  "<feature name=\"org.gnu.gdb.i386.linux\">"
+  "<feature name=\"org.gnu.gdb.i386.avx\">"
+  "<flags id=\"i386_eflags\" size=\"4\">"
+  "<field name=\"CF\" start=\"0\" end=\"0\"/>"
+  "<vector id=\"v4f\" type=\"ieee_single\" count=\"4\"/>"
+  "<vector id=\"v2d\" type=\"ieee_double\" count=\"2\"/>"
+  "<vector id=\"v16i8\" type=\"int8\" count=\"16\"/>"
+  "<union id=\"vec128\"><field name=\"v8_bfloat16\" type=\"v8bf16\"/>"
+  "<reg name=\"rax\" bitsize=\"64\" type=\"int64\" regnum=\"0\"/>"
+  "<reg name=\"rip\" bitsize=\"64\" type=\"code_ptr\"/>"
+  "<reg name=\"rsp\" bitsize=\"64\" type=\"data_ptr\"/>"
+  "<reg name=\"st0\" bitsize=\"80\" type=\"i387_ext\"/>"
+  "<reg name=\"xmm0\" bitsize=\"128\" type=\"vec128\"/>"
+  "<reg name=\"fs_base\" bitsize=\"64\" type=\"int\"/>"
+  "<reg name=\"orig_rax\" bitsize=\"64\" type=\"int\" group=\"system\"/>"
+  "</feature></target>\n"
+  "<library-list-svr4 version=\"1.0\" main-lm=\"0x7ffff7ffe2e0\">"
+  "<library name=\"/lib/x86_64-linux-gnu/libc.so.6\" lm=\"0x7ffff7fc1000\""
+  " l_addr=\"0x7ffff7d80000\" l_ld=\"0x7ffff7f96940\" lmid=\"0x0\"/>"
+  "<library name=\"/lib64/ld-linux-x86-64.so.2\" lm=\"0x7ffff7ffda48\""
+  " l_addr=\"0x7ffff7fc3000\" l_ld=\"0x7ffff7ffce80\" lmid=\"0x0\"/>"
+  "</library-list-svr4>"
+  "<?xml version=\"1.0\"?>\n<threads>\n"
+  "<thread id=\"p1f2a.1f2a\" core=\"0\" name=\"a.out\""
+  " handle=\"40b7f7f7ff7f0000\"/>\n"
+  "<thread id=\"p1f2a.1f2b\" core=\"1\" name=\"a.out\""
+  " handle=\"00a6f7f7ff7f0000\"/>\n"
+  "</threads>\n"
+  "T0506:0000000000000000;07:b0e0ffffff7f0000;10:4011400000000000;"
+  "thread:p1f2a.1f2a;core:0;"
+  "0000000000000000ffffffffffffffff0000000000000000";
+
+/* The window size of the raw deflate streams: 32KB, the maximum,
+   negated to ask for raw streams with no zlib header or checksum --
+   the packet checksum already covers the data.  */
+
+static constexpr int window_bits = -15;
+
+/* See rsp-compress.h.  */
+
+rsp_compressor::~rsp_compressor ()
+{
+  if (m_deflate != nullptr)
+    {
+      deflateEnd (m_deflate);
+      delete m_deflate;
+    }
+  if (m_inflate != nullptr)
+    {
+      inflateEnd (m_inflate);
+      delete m_inflate;
+    }
+}
+
+/* See rsp-compress.h.  */
+
+bool
+rsp_compressor::compress (const char *data, int len, std::string &out)
+{
+  if (m_deflate == nullptr)
+    {
+      std::unique_ptr<z_stream> strm (new z_stream ());
+      if (deflateInit2 (strm.get (), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	return false;
+      m_deflate = strm.release ();
+    }
+  else if (deflateReset (m_deflate) != Z_OK)
+    return false;
+
+  if (deflateSetDictionary (m_deflate, (const Bytef *) dictionary,
+			    sizeof (dictionary) - 1) != Z_OK)
+    return false;
+
+  gdb::byte_vector compressed (deflateBound (m_deflate, len));
+  m_deflate->next_in = (Bytef *) data;
+  m_deflate->avail_in = len;
+  m_deflate->next_out = compressed.data ();
+  m_deflate->avail_out = compressed.size ();
+  if (deflate (m_deflate, Z_FINISH) != Z_STREAM_END)
+    return false;
+
+  /* The escaped data must fit in LEN - 1 bytes, to leave room for the
+     marker and still save something.  */
+  int compressed_len = compressed.size () - m_deflate->avail_out;
+  if (compressed_len >= len - 1)
+    return false;
+
+  out.resize (len);
+  out[0] = rsp_compress_marker;
+
+  int out_len;
+  int escaped_len
+    = remote_escape_output (compressed.data (), compressed_len, 1,
+			    (gdb_byte *) &out[1], &out_len, len - 2);
+  if (out_len != compressed_len)
+    return false;
+
+  out.resize (escaped_len + 1);
+  return true;
+}
+
+/* See rsp-compress.h.  */
+
+bool
+rsp_compressor::uncompress (const char *data, int len, std::string &out,
+			    size_t max)
+{
+  gdb_assert (len > 0 && data[0] == rsp_compress_marker);
+
+  if (m_inflate == nullptr)
+    {
+      std::unique_ptr<z_stream> strm (new z_stream ());
+      if (inflateInit2 (strm.get (), window_bits) != Z_OK)
+	return false;
+      m_inflate = strm.release ();
+    }
+  else if (inflateReset (m_inflate) != Z_OK)
+    return false;
+
+  if (inflateSetDictionary (m_inflate, (const Bytef *) dictionary,
+			    sizeof (dictionary) - 1) != Z_OK)
+    return false;
+
+  /* Undo the escaping.  This is remote_unescape_input, except that
+     an unmatched escape character makes the data malformed rather
+     than throwing an error.  */
+  gdb::byte_vector compressed;
+  compressed.reserve (len - 1);
+  for (int i = 1; i < len; i++)
+    {
+      if (data[i] != '}')
+	compressed.push_back (data[i]);
+      else if (++i < len)
+	compressed.push_back (data[i] ^ 0x20);
+      else
+	return false;
+    }
+
+  m_inflate->next_in = compressed.data ();
+  m_inflate->avail_in = compressed.size ();
+
+  /* Packets compress well, so start with room for a few times the
+     compressed size, and grow from there.  */
+  out.resize (std::min<size_t> (4 * len, max));
+  size_t out_len = 0;
+
+  while (true)
+    {
+      m_inflate->next_out = (Bytef *) &out[out_len];
+      m_inflate->avail_out = out.size () - out_len;
+
+      int ret = inflate (m_inflate, Z_NO_FLUSH);
+      out_len = out.size () - m_inflate->avail_out;
+
+      if (ret == Z_STREAM_END)
+	break;
+      if ((ret != Z_OK && ret != Z_BUF_ERROR)
+	  || m_inflate->avail_out != 0)
+	return false;
+
+      /* The output is full, but the stream has not ended.  */
+      if (out.size () >= max)
+	return false;
+      out.resize (std::min<size_t> (2 * out.size (), max));
+    }
+
+  /* Trailing data after the end of the stream is malformed too.  */
+  if (m_inflate->avail_in != 0)
+    return false;
+
+  out.resize (out_len);
+  return true;
+}
@@ -0,0 +1,76 @@
+/* Compression of remote protocol packets.
+
+   Copyright (C) 2025 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef GDBSUPPORT_RSP_COMPRESS_H
+#define GDBSUPPORT_RSP_COMPRESS_H
+
+/* Once compression has been enabled with the QCompress packet, the
+   data of a packet may be replaced by this character followed by the
+   compressed data, escaped as for binary data.  No uncompressed
+   packet starts with this character.  */
+
+constexpr char rsp_compress_marker = '\x01';
+
+/* Packets with less data than this are never compressed; the saving
+   would not be worth the time.  */
+
+constexpr int rsp_compress_threshold = 256;
+
+/* The name of the compression method, as used in the qSupported and
+   QCompress packets.  The data is compressed with zlib's raw deflate
+   format, using the preset dictionary in rsp-compress.cc, which must
+   therefore never change while the method keeps this name.  */
+
+extern const char rsp_compress_method[];
+
+struct z_stream_s;
+
+/* The compression state of one end of a connection.  Each packet is
+   compressed independently of the others, so that a packet can be
+   retransmitted, or replayed by gdbreplay, without any other.  */
+
+class rsp_compressor
+{
+public:
+  rsp_compressor () = default;
+  ~rsp_compressor ();
+
+  DISABLE_COPY_AND_ASSIGN (rsp_compressor);
+
+  /* Compress the LEN bytes of packet data at DATA.  If that makes the
+     packet shorter, store in OUT the data to send instead -- the
+     marker followed by the escaped compressed data -- and return
+     true.  Otherwise return false.  */
+
+  bool compress (const char *data, int len, std::string &out);
+
+  /* Uncompress the LEN bytes of packet data at DATA, which start with
+     the marker, into OUT.  Return false if the data is malformed, or
+     if it would uncompress to more than MAX bytes.  */
+
+  bool uncompress (const char *data, int len, std::string &out,
+		   size_t max);
+
+private:
+  /* The zlib streams, created on first use.  */
+  z_stream_s *m_deflate = nullptr;
+  z_stream_s *m_inflate = nullptr;
+};
+
+#endif /* GDBSUPPORT_RSP_COMPRESS_H */
@@ -45,6 +45,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -109,8 +110,14 @@ class Dwo_file
  public:
   Dwo_file(const char* name)
     : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+      sect_offsets_(), str_offset_map_(), debug_types_(), debug_str_(0),
+      debug_cu_index_(0), debug_tu_index_(0), section_data_(),
+      str_count_(0), machine_(0), size_(0), big_endian_(false), osabi_(0),
+      abiversion_(0)
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -121,7 +128,23 @@ class Dwo_file
 
   // Read the input file and send its contents to OUTPUT_FILE.
   void
-  read(Dwp_output_file* output_file);
+  read(Dwp_output_file* output_file)
+  {
+    this->prefetch();
+    this->merge(output_file);
+  }
+
+  // Open the input file, find the debug sections, and read the
+  // contents of the sections that will be copied to the output file.
+  // This does not touch the output file, so it may be run for several
+  // input files in parallel.
+  void
+  prefetch();
+
+  // Send the contents read by prefetch to OUTPUT_FILE.  Input files
+  // must be merged one at a time, in command line order.
+  void
+  merge(Dwp_output_file* output_file);
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -129,6 +152,11 @@ class Dwo_file
   bool
   verify(const File_list& files);
 
+  // Return the filename.
+  const char*
+  name() const
+  { return this->name_; }
+
  private:
   // Types for mapping input string offsets to output string offsets.
   typedef std::pair<section_offset_type, section_offset_type>
@@ -144,16 +172,27 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // The contents of a section read by prefetch.  The memory is owned
+  // by this object until it is handed over to the output file.
+  struct Section_data
+  {
+    unsigned char* contents;
+    section_size_type len;
+
+    Section_data()
+      : contents(NULL), len(0)
+    { }
+  };
+
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
+  // and save the target info.  P is a pointer to the ELF header
   // in memory.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -177,6 +216,15 @@ class Dwo_file
   section_contents(unsigned int shndx, section_size_type* plen, bool* is_new)
   { return this->obj_->decompressed_section_contents(shndx, plen, is_new); }
 
+  // Read the contents of section SHNDX into memory owned by this object.
+  void
+  fetch_section(unsigned int shndx);
+
+  // Take ownership of the contents of section SHNDX read by
+  // fetch_section.  Set *PLEN to the size.
+  unsigned char*
+  take_section(unsigned int shndx, section_size_type* plen);
+
   // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
   // and process the CU or TU sets.
   void
@@ -200,20 +248,21 @@ class Dwo_file
 
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
   copy_section(Dwp_output_file* output_file, unsigned int shndx,
 	       elfcpp::DW_SECT section_id);
 
-  // Remap the string offsets in the .debug_str_offsets.dwo section.
-  const unsigned char*
-  remap_str_offsets(const unsigned char* contents, section_size_type len);
+  // Remap the string offsets in the .debug_str_offsets.dwo section,
+  // in place.
+  void
+  remap_str_offsets(unsigned char* contents, section_size_type len);
 
   template <bool big_endian>
-  const unsigned char*
-  sized_remap_str_offsets(const unsigned char* contents, section_size_type len);
+  void
+  sized_remap_str_offsets(unsigned char* contents, section_size_type len);
 
   // Remap a single string offsets from an offset in the input string table
   // to an offset in the output string table.
@@ -238,6 +287,22 @@ class Dwo_file
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // Input section indexes of the debug sections found by prefetch.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  std::vector<unsigned int> debug_types_;
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // Section contents read by prefetch, indexed by input section index.
+  std::vector<Section_data> section_data_;
+  // The number of strings in the .debug_str.dwo section.
+  size_t str_count_;
+  // The target info from the ELF header.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
 };
 
 // An ELF input file.
@@ -711,6 +776,59 @@ class Dwo_name_info_reader : public Dwarf_info_reader
   File_list* files_;
 };
 
+// Reads the input files in parallel and merges them into the output
+// file.  Each file is opened and its sections read by a
+// Dwo_prefetch_task.  A chain of Dwo_merge_tasks then merges the files
+// into the output file one at a time, in command line order, so that
+// the output does not depend on the order in which the reads finish.
+// To bound memory use, only READ_AHEAD files are read ahead of the
+// file being merged.
+
+class Dwp_parallel_reader
+{
+ public:
+  Dwp_parallel_reader(const File_list& files, Dwp_output_file* output_file,
+		      bool verbose, unsigned int read_ahead)
+    : files_(files), output_file_(output_file), verbose_(verbose),
+      read_ahead_(read_ahead), dwo_files_(files.size()),
+      blockers_(files.size())
+  { gold_assert(read_ahead > 0); }
+
+  // Queue the tasks to read the first files, and the task to merge
+  // the first file.
+  void
+  queue_initial_tasks(Workqueue*);
+
+  // Return the blocker released when file I has been read.
+  Task_token*
+  prefetch_blocker(unsigned int i) const
+  { return this->blockers_[i]; }
+
+  // Merge file I into the output file, and queue the tasks to read
+  // another file and to merge the next one.
+  void
+  merge(Workqueue*, unsigned int i);
+
+ private:
+  // Queue the task to read file I.
+  void
+  queue_prefetch(Workqueue*, unsigned int i);
+
+  // The input files.
+  const File_list& files_;
+  // The output file.
+  Dwp_output_file* output_file_;
+  // Whether to print the name of each file as it is merged.
+  bool verbose_;
+  // The number of files to read ahead of the file being merged.
+  unsigned int read_ahead_;
+  // The input files which have been queued for reading and not yet
+  // merged.
+  std::vector<Dwo_file*> dwo_files_;
+  // The blockers released when each file has been read.
+  std::vector<Task_token*> blockers_;
+};
+
 // A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
 // and adding them to the output file.
 
@@ -828,6 +946,9 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  for (unsigned int i = 0; i < this->section_data_.size(); ++i)
+    if (this->section_data_[i].contents != NULL)
+      delete[] this->section_data_[i].contents;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
@@ -840,7 +961,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,25 +1001,18 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Open the input file, find the debug sections, and read the contents
+// of the sections that will be copied to the output file.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::prefetch()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
-
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  this->section_data_.resize(shnum);
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -918,48 +1032,85 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
     }
 
+  // Read the sections that copy_section will hand to the output file.
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      if (this->debug_shndx_[i] > 0)
+	this->fetch_section(this->debug_shndx_[i]);
+    }
+
+  // Read the string table, check it, and count the strings so that
+  // add_strings can size the offset map.
+  this->fetch_section(this->debug_str_);
+  const Section_data& str_data(this->section_data_[this->debug_str_]);
+  const char* p = reinterpret_cast<const char*>(str_data.contents);
+  const char* pend = p + str_data.len;
+  if (str_data.len > 0 && pend[-1] != '\0')
+    gold_fatal(_("%s: last entry in string section '%s' "
+		 "is not null terminated"),
+	       this->name_,
+	       this->section_name(this->debug_str_).c_str());
+  for (; p < pend; p += strlen(p) + 1)
+    ++this->str_count_;
+}
+
+// Send the contents read by prefetch to OUTPUT_FILE.
+
+void
+Dwo_file::merge(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
+	  if (this->debug_types_.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
 			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
@@ -969,8 +1120,9 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
+  for (std::vector<unsigned int>::const_iterator tp =
+	 this->debug_types_.begin();
+       tp != this->debug_types_.end();
        ++tp)
     {
       debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
@@ -985,7 +1137,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1021,10 +1173,10 @@ Dwo_file::verify(const File_list& files)
 }
 
 // Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// and save the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1058,15 +1210,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1225,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1092,23 +1240,22 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_unreachable();
 }
 
-// Function template to create a Sized_relobj_dwo and record the target info.
+// Function template to create a Sized_relobj_dwo and save the target info.
 // P is a pointer to the ELF header in memory.
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_ei_osabi(),
-	ehdr.get_ei_abiversion());
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_ei_osabi();
+  this->abiversion_ = ehdr.get_ei_abiversion();
   return obj;
 }
 
@@ -1360,29 +1507,59 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Read the contents of section SHNDX into memory owned by this object,
+// decompressing it if necessary, so that it persists after we close
+// the input file.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::fetch_section(unsigned int shndx)
 {
+  Section_data* data = &this->section_data_[shndx];
+  if (data->contents != NULL)
+    return;
+
   section_size_type len;
   bool is_new;
-  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
+  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  if (is_new)
+    data->contents = const_cast<unsigned char*>(contents);
+  else
+    {
+      data->contents = new unsigned char[len];
+      memcpy(data->contents, contents, len);
+    }
+  data->len = len;
+}
+
+// Take ownership of the contents of section SHNDX.  An empty section
+// may be copied more than once, so read it again if it was already
+// taken.
+
+unsigned char*
+Dwo_file::take_section(unsigned int shndx, section_size_type* plen)
+{
+  Section_data* data = &this->section_data_[shndx];
+  if (data->contents == NULL)
+    this->fetch_section(shndx);
+  unsigned char* contents = data->contents;
+  *plen = data->len;
+  data->contents = NULL;
+  data->len = 0;
+  return contents;
+}
+
+// Merge the input string table section into the output file.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file)
+{
+  section_size_type len;
+  unsigned char* pdata = this->take_section(this->debug_str_, &len);
   const char* p = reinterpret_cast<const char*>(pdata);
   const char* pend = p + len;
 
-  // Check that the last string is null terminated.
-  if (pend[-1] != '\0')
-    gold_fatal(_("%s: last entry in string section '%s' "
-		 "is not null terminated"),
-	       this->name_,
-	       this->section_name(debug_str).c_str());
-
-  // Count the number of strings in the section, and size the map.
-  size_t count = 0;
-  for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
-    ++count;
-  this->str_offset_map_.reserve(count + 1);
+  // Prefetch has checked the section and counted the strings.
+  this->str_offset_map_.reserve(this->str_count_ + 1);
 
   // Add the strings to the output string table, and record the new offsets
   // in the map.
@@ -1398,8 +1575,7 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
     }
   new_offset = 0;
   this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
+  delete[] pdata;
 }
 
 // Copy a section from the input file to the output file.
@@ -1416,27 +1592,13 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   if (this->sect_offsets_[shndx].size > 0)
     return this->sect_offsets_[shndx];
 
-  // Get the section contents. Upon return, if IS_NEW is true, the memory
-  // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
+  // Take the contents read by prefetch.  We own the memory, so the
+  // string offsets can be remapped in place.
   section_size_type len;
-  bool is_new;
-  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  unsigned char* contents = this->take_section(shndx, &len);
 
   if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
-    {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
-      if (is_new)
-	delete[] contents;
-      contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
-    }
+    this->remap_str_offsets(contents, len);
 
   // Add the contents of the input section to the output section.
   // The output file takes ownership of the memory pointed to by CONTENTS.
@@ -1450,39 +1612,35 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
-// Remap the 
-const unsigned char*
-Dwo_file::remap_str_offsets(const unsigned char* contents,
-			    section_size_type len)
+// Remap the string offsets in the .debug_str_offsets.dwo section.
+
+void
+Dwo_file::remap_str_offsets(unsigned char* contents, section_size_type len)
 {
   if ((len & 3) != 0)
     gold_fatal(_("%s: .debug_str_offsets.dwo section size not a multiple of 4"),
 	       this->name_);
 
   if (this->obj_->is_big_endian())
-    return this->sized_remap_str_offsets<true>(contents, len);
+    this->sized_remap_str_offsets<true>(contents, len);
   else
-    return this->sized_remap_str_offsets<false>(contents, len);
+    this->sized_remap_str_offsets<false>(contents, len);
 }
 
 template <bool big_endian>
-const unsigned char*
-Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
+void
+Dwo_file::sized_remap_str_offsets(unsigned char* contents,
 				  section_size_type len)
 {
-  unsigned char* remapped = new unsigned char[len];
-  const unsigned char* p = contents;
-  unsigned char* q = remapped;
+  unsigned char* p = contents;
   while (len > 0)
     {
       unsigned int val = elfcpp::Swap_unaligned<32, big_endian>::readval(p);
       val = this->remap_str_offset(val);
-      elfcpp::Swap_unaligned<32, big_endian>::writeval(q, val);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p, val);
       len -= 4;
       p += 4;
-      q += 4;
     }
-  return remapped;
 }
 
 unsigned int
@@ -2284,6 +2442,126 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   this->output_file_->add_tu_set(unit_set);
 }
 
+// This task opens an input file and reads the sections which will be
+// copied to the output file.  It releases BLOCKER when done.
+
+class Dwo_prefetch_task : public Task
+{
+ public:
+  Dwo_prefetch_task(Dwo_file* dwo_file, Task_token* blocker)
+    : dwo_file_(dwo_file), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->prefetch(); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_prefetch_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* blocker_;
+};
+
+// This task merges input file I into the output file, once it has
+// been read.
+
+class Dwo_merge_task : public Task
+{
+ public:
+  Dwo_merge_task(Dwp_parallel_reader* reader, unsigned int i)
+    : reader_(reader), i_(i)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    Task_token* blocker = this->reader_->prefetch_blocker(this->i_);
+    return blocker->is_blocked() ? blocker : NULL;
+  }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue* workqueue)
+  { this->reader_->merge(workqueue, this->i_); }
+
+  std::string
+  get_name() const
+  { return "Dwo_merge_task"; }
+
+ private:
+  Dwp_parallel_reader* reader_;
+  unsigned int i_;
+};
+
+// Class Dwp_parallel_reader.
+
+// Queue the tasks to read the first files, and the task to merge
+// the first file.
+
+void
+Dwp_parallel_reader::queue_initial_tasks(Workqueue* workqueue)
+{
+  if (this->files_.empty())
+    return;
+  for (unsigned int i = 0;
+       i < this->read_ahead_ && i < this->files_.size();
+       ++i)
+    this->queue_prefetch(workqueue, i);
+  workqueue->queue(new Dwo_merge_task(this, 0));
+}
+
+// Queue the task to read file I.
+
+void
+Dwp_parallel_reader::queue_prefetch(Workqueue* workqueue, unsigned int i)
+{
+  Dwo_file* dwo_file = new Dwo_file(this->files_[i].dwo_name.c_str());
+  Task_token* blocker = new Task_token(true);
+  blocker->add_blocker();
+  this->dwo_files_[i] = dwo_file;
+  this->blockers_[i] = blocker;
+  workqueue->queue(new Dwo_prefetch_task(dwo_file, blocker));
+}
+
+// Merge file I into the output file.  Its reader is then done, so
+// start reading another file and queue the merge of the next one.
+
+void
+Dwp_parallel_reader::merge(Workqueue* workqueue, unsigned int i)
+{
+  if (this->verbose_)
+    fprintf(stderr, "%s\n", this->files_[i].dwo_name.c_str());
+  this->dwo_files_[i]->merge(this->output_file_);
+
+  delete this->dwo_files_[i];
+  this->dwo_files_[i] = NULL;
+  delete this->blockers_[i];
+  this->blockers_[i] = NULL;
+
+  if (i + this->read_ahead_ < this->files_.size())
+    this->queue_prefetch(workqueue, i + this->read_ahead_);
+  if (i + 1 < this->files_.size())
+    workqueue->queue(new Dwo_merge_task(this, i + 1));
+}
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,6 +2570,8 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
+  THREAD_COUNT
 };
 
 struct option dwp_options[] =
@@ -2299,12 +2579,18 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
     { NULL, 0, NULL, 0 }
   };
 
+// The number of threads to use for --threads without --thread-count.
+
+static const int default_thread_count = 4;
+
 // Print usage message and exit.
 
 static void
@@ -2315,6 +2601,9 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use"
+					   " (implies --threads)\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2378,6 +2667,8 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2688,18 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    break;
+	  case THREAD_COUNT:
+	    {
+	      char* endptr;
+	      thread_count = strtol(optarg, &endptr, 0);
+	      if (*endptr != '\0' || thread_count < 1)
+		gold_fatal(_("invalid thread count: %s"), optarg);
+	      threads = true;
+	    }
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +2708,20 @@ main(int argc, char** argv)
 	}
     }
 
+  // Gold's locks are only real when threads are enabled, so this must
+  // be set before anything in libgold takes a lock.
+  if (threads)
+    {
+#ifdef ENABLE_THREADS
+      options.enable_threads();
+#else
+      gold_warning(_("ignoring --threads and --thread-count: "
+		     "%s was compiled without thread support"),
+		   program_name);
+      threads = false;
+#endif
+    }
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2438,12 +2755,28 @@ main(int argc, char** argv)
 
   // Process each file, adding its contents to the output file.
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  if (threads)
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      if (thread_count == 0)
+	thread_count = default_thread_count;
+      Dwp_parallel_reader reader(files, &output_file, verbose,
+				 2 * thread_count);
+      Workqueue workqueue(options);
+      workqueue.set_thread_count(thread_count);
+      reader.queue_initial_tasks(&workqueue);
+      workqueue.process(0);
+    }
+  else
+    {
+      for (File_list::const_iterator f = files.begin();
+	   f != files.end();
+	   ++f)
+	{
+	  if (verbose)
+	    fprintf(stderr, "%s\n", f->dwo_name.c_str());
+	  Dwo_file dwo_file(f->dwo_name.c_str());
+	  dwo_file.read(&output_file);
+	}
     }
   output_file.finalize();
 
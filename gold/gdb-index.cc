@@ -28,6 +28,7 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -171,6 +172,240 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// The results of scanning the .debug_info and .debug_types sections
+// of one input object.  With --threads, the scans of different objects
+// run in parallel in Gdb_index_scan_task tasks, so each scan collects
+// its own lists of CUs, TUs, address ranges and symbols.  The
+// Gdb_index_merge_task then adds them to the .gdb_index section in
+// input order, so the output does not depend on the order in which the
+// scans ran.  CU indexes within a scan are local to the scan, with
+// negative indexes referring to TUs as in the .gdb_index section.
+
+class Gdb_index_scan
+{
+ public:
+  // A symbol found by the scan.
+  struct Scan_symbol
+  {
+    Scan_symbol(const char* name_arg, int cu_index_arg, uint8_t flags_arg)
+      : name(name_arg), cu_index(cu_index_arg), flags(flags_arg)
+    { }
+
+    const char* name;
+    int cu_index;
+    uint8_t flags;
+  };
+
+  // An address range list for a CU.
+  struct Scan_range_list
+  {
+    Scan_range_list(int cu_index_arg, Dwarf_range_list* ranges_arg)
+      : cu_index(cu_index_arg), ranges(ranges_arg)
+    { }
+
+    int cu_index;
+    Dwarf_range_list* ranges;
+  };
+
+  typedef std::vector<std::pair<uint64_t, uint64_t> > Comp_unit_list;
+  typedef std::vector<std::pair<std::pair<uint64_t, uint64_t>, uint64_t> >
+    Type_unit_list;
+
+  // If COPY_SYMBOLS is true, the scan runs after the symbols are
+  // freed, so we keep our own copy of them.
+  Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+		 off_t symbols_size, bool copy_symbols);
+
+  ~Gdb_index_scan();
+
+  // The object being scanned.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Add a .debug_info or .debug_types section to scan.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Scan the sections added since the last call.  The object must be
+  // locked.
+  void
+  scan();
+
+  // Return whether all the sections have been scanned.
+  bool
+  is_done() const
+  { return this->next_section_ == this->sections_.size(); }
+
+  // Add a compilation unit, returning its local index.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(std::make_pair(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit, returning its local index.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(
+	std::make_pair(std::make_pair(tu_offset, type_offset), signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(int cu_index, Dwarf_range_list* ranges)
+  { this->ranges_.push_back(Scan_range_list(cu_index, ranges)); }
+
+  // Add a symbol.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+  {
+    const char* name = this->names_.add(sym_name, true, NULL);
+    this->scan_symbols_.push_back(Scan_symbol(name, cu_index, flags));
+  }
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset) const
+  { return find_pub_offset(this->cu_pubname_map_, cu_offset); }
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset) const
+  { return find_pub_offset(this->cu_pubtype_map_, cu_offset); }
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUs associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Accessors for the results.
+  const Comp_unit_list&
+  comp_units() const
+  { return this->comp_units_; }
+
+  const Type_unit_list&
+  type_units() const
+  { return this->type_units_; }
+
+  const std::vector<Scan_range_list>&
+  ranges() const
+  { return this->ranges_; }
+
+  const std::vector<Scan_symbol>&
+  symbols() const
+  { return this->scan_symbols_; }
+
+  // Statistics.
+  // Number of DWARF compilation units processed.
+  unsigned int cu_count;
+  // Number of DWARF compilation units without pubnames/pubtypes.
+  unsigned int cu_nopubnames_count;
+  // Number of DWARF type units processed.
+  unsigned int tu_count;
+  // Number of DWARF type units without pubnames/pubtypes.
+  unsigned int tu_nopubnames_count;
+
+ private:
+  Gdb_index_scan(const Gdb_index_scan&);
+  Gdb_index_scan& operator=(const Gdb_index_scan&);
+
+  // A section to scan.
+  struct Section
+  {
+    Section(bool is_type_unit_arg, unsigned int shndx_arg,
+	    unsigned int reloc_shndx_arg, unsigned int reloc_type_arg)
+      : is_type_unit(is_type_unit_arg), shndx(shndx_arg),
+	reloc_shndx(reloc_shndx_arg), reloc_type(reloc_type_arg)
+    { }
+
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  static off_t
+  find_pub_offset(const Pubname_offset_map& map, off_t cu_offset)
+  {
+    Pubname_offset_map::const_iterator it = map.find(cu_offset);
+    if (it != map.end())
+      return it->second;
+    return -1;
+  }
+
+  // Scan the pubnames or pubtypes section and build a map of the
+  // various cus and tus it refers to, so we can process the entries
+  // when we encounter the die for that cu or tu.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, Gdb_index_info_reader* dwinfo);
+
+  // The object being scanned.
+  Relobj* object_;
+  // The symbol table of the object.
+  const unsigned char* symbols_;
+  off_t symbols_size_;
+  // Whether we own SYMBOLS_.
+  bool owns_symbols_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // The index of the next section to scan.
+  size_t next_section_;
+  // The readers used so far.  The pubnames tables refer to the first
+  // one, so they are kept until the scan is deleted.
+  std::vector<Gdb_index_info_reader*> readers_;
+  // The pubnames and pubtypes sections of the object, and maps from
+  // CU offset to the offset of the CU's subsection within them.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // The list of DWARF compilation units, as (offset, length).
+  Comp_unit_list comp_units_;
+  // The list of DWARF type units, as ((offset, type offset), signature).
+  Type_unit_list type_units_;
+  // The list of address ranges.
+  std::vector<Scan_range_list> ranges_;
+  // The symbols found, in the order they were found.
+  std::vector<Scan_symbol> scan_symbols_;
+  // Storage for the symbol names.
+  Stringpool names_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,15 +418,19 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Add the statistics of a finished scan to the totals.
+  static void
+  record_stats(const Gdb_index_scan* scan);
+
   // Print usage statistics.
   static void
   print_stats();
@@ -285,8 +524,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The scan of the current object.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,8 +560,8 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  ++this->scan_->cu_count;
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +572,10 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
+  ++this->scan_->tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -398,9 +637,9 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 		return;
 	      }
 	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
+	      ++this->scan_->cu_nopubnames_count;
 	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	      ++this->scan_->tu_nopubnames_count;
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -454,8 +693,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -494,8 +732,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -842,8 +1079,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -868,8 +1104,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -894,7 +1129,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -933,8 +1168,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -945,10 +1179,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -956,12 +1190,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -981,6 +1215,19 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
+// Add the statistics of a finished scan to the totals.
+
+void
+Gdb_index_info_reader::record_stats(const Gdb_index_scan* scan)
+{
+  Gdb_index_info_reader::dwarf_cu_count += scan->cu_count;
+  Gdb_index_info_reader::dwarf_cu_nopubnames_count
+    += scan->cu_nopubnames_count;
+  Gdb_index_info_reader::dwarf_tu_count += scan->tu_count;
+  Gdb_index_info_reader::dwarf_tu_nopubnames_count
+    += scan->tu_nopubnames_count;
+}
+
 // Print usage statistics.
 void
 Gdb_index_info_reader::print_stats()
@@ -995,53 +1242,44 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
+// Class Gdb_index_scan.
 
-// Construct the .gdb_index section.
-
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+Gdb_index_scan::Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+			       off_t symbols_size, bool copy_symbols)
+  : cu_count(0), cu_nopubnames_count(0), tu_count(0), tu_nopubnames_count(0),
+    object_(object), symbols_(symbols), symbols_size_(symbols_size),
+    owns_symbols_(false), sections_(), next_section_(0), readers_(),
+    pubnames_table_(NULL), pubtypes_table_(NULL), cu_pubname_map_(),
+    cu_pubtype_map_(), stmt_list_offset_(-1), comp_units_(), type_units_(),
+    ranges_(), scan_symbols_(), names_()
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  if (copy_symbols && symbols != NULL)
+    {
+      unsigned char* copy = new unsigned char[symbols_size];
+      memcpy(copy, symbols, symbols_size);
+      this->symbols_ = copy;
+      this->owns_symbols_ = true;
+    }
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_scan::~Gdb_index_scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
+  for (size_t i = 0; i < this->readers_.size(); ++i)
+    delete this->readers_[i];
+  if (this->owns_symbols_)
+    delete[] this->symbols_;
 }
 
-
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
 // when we encounter the die for that cu or tu.
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1059,8 +1297,12 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
-    return NULL;
+  if (!table->read_section(this->object_, this->symbols_,
+			   this->symbols_size_))
+    {
+      delete table;
+      return NULL;
+    }
 
   while (table->read_header(section_offset))
     {
@@ -1071,53 +1313,166 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
   return table;
 }
 
-// Wrapper for map_pubtable_to_dies
+// Scan the sections added since the last call.
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_scan::scan()
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = -1;
-
-  delete this->pubnames_table_;
-  this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
-  this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+  for (; this->next_section_ < this->sections_.size(); ++this->next_section_)
+    {
+      const Section& section(this->sections_[this->next_section_]);
+      Gdb_index_info_reader* dwinfo =
+	new Gdb_index_info_reader(section.is_type_unit, this->object_,
+				  this->symbols_, this->symbols_size_,
+				  section.shndx, section.reloc_shndx,
+				  section.reloc_type, this);
+      this->readers_.push_back(dwinfo);
+      if (this->readers_.size() == 1)
+	{
+	  this->pubnames_table_ =
+	    this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
+	  this->pubtypes_table_ =
+	    this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
+	}
+      dwinfo->parse();
+    }
 }
 
-// Given a cu_offset, find the associated section of the pubnames
-// table.
+// This task scans the debug info of one input object for the
+// .gdb_index section.  It is used when --threads is in effect.
 
-off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+class Gdb_index_scan_task : public Task
 {
-  Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
-  if (it != this->cu_pubname_map_.end())
-    return it->second;
-  return -1;
-}
+ public:
+  Gdb_index_scan_task(Gdb_index_scan* scan, Task_token* blocker)
+    : scan_(scan), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->scan_->object();
+    return object->is_locked() ? object->token() : NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->scan_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->scan_->scan();
+    this->scan_->object()->release();
+  }
 
-// Given a cu_offset, find the associated section of the pubnames
-// table.
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->scan_->object()->name(); }
+
+ private:
+  Gdb_index_scan* scan_;
+  Task_token* blocker_;
+};
 
-off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+// This task adds the results of all the scans to the .gdb_index
+// section once they are done.  It is blocked by THIS_BLOCKER, to keep
+// the place of the task it replaces in the chain of middle tasks, and
+// by SCANS_BLOCKER.  It unblocks NEXT_BLOCKER.
+
+class Gdb_index_merge_task : public Task
 {
-  Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
-  if (it != this->cu_pubtype_map_.end())
-    return it->second;
-  return -1;
+ public:
+  Gdb_index_merge_task(Gdb_index* gdb_index, Task_token* this_blocker,
+		       Task_token* scans_blocker, Task_token* next_blocker)
+    : gdb_index_(gdb_index), this_blocker_(this_blocker),
+      scans_blocker_(scans_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_merge_task()
+  {
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+    delete this->scans_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->scans_blocker_->is_blocked())
+      return this->scans_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->merge_scans(); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_merge_task"; }
+
+ private:
+  Gdb_index* gdb_index_;
+  Task_token* this_blocker_;
+  Task_token* scans_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    scans_()
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    delete this->scans_[i];
 }
 
-// Scan a .debug_info or .debug_types input section.
+
+// Scan a .debug_info or .debug_types input section.  The sections of
+// an object are added to the same scan.  With --threads the scan is
+// deferred to a Gdb_index_scan_task; otherwise it is done now, while
+// the object is locked.
 
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
@@ -1128,13 +1483,94 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  bool defer = parameters->options().threads();
+  Gdb_index_scan* scan;
+  if (!this->scans_.empty() && this->scans_.back()->object() == object)
+    scan = this->scans_.back();
+  else
+    {
+      scan = new Gdb_index_scan(object, symbols, symbols_size, defer);
+      this->scans_.push_back(scan);
+    }
+  scan->add_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+  if (!defer)
+    scan->scan();
+}
+
+// Queue a Gdb_index_scan_task for each deferred scan, and a task to
+// merge the results once they are done.  THIS_BLOCKER is the blocker
+// of the next task in the chain of middle tasks.  Return the blocker
+// that task should wait for instead.
+
+Task_token*
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* this_blocker)
+{
+  if (this->scans_.empty())
+    return this_blocker;
+
+  Task_token* scans_blocker = new Task_token(true);
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    {
+      if (this->scans_[i]->is_done())
+	continue;
+      scans_blocker->add_blocker();
+      workqueue->queue(new Gdb_index_scan_task(this->scans_[i],
+					       scans_blocker));
+    }
+
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+  workqueue->queue(new Gdb_index_merge_task(this, this_blocker,
+					    scans_blocker, next_blocker));
+  return next_blocker;
+}
+
+// Add the results of the scans to the index, in input order.
+
+void
+Gdb_index::merge_scans()
+{
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    {
+      Gdb_index_scan* scan = this->scans_[i];
+      gold_assert(scan->is_done());
+
+      // Translate the CU and TU indexes local to the scan.
+      int cu_base = this->comp_units_.size();
+      int tu_base = this->type_units_.size();
+
+      const Gdb_index_scan::Comp_unit_list& cus(scan->comp_units());
+      for (unsigned int j = 0; j < cus.size(); ++j)
+	this->add_comp_unit(cus[j].first, cus[j].second);
+
+      const Gdb_index_scan::Type_unit_list& tus(scan->type_units());
+      for (unsigned int j = 0; j < tus.size(); ++j)
+	this->add_type_unit(tus[j].first.first, tus[j].first.second,
+			    tus[j].second);
+
+      const std::vector<Gdb_index_scan::Scan_range_list>&
+	ranges(scan->ranges());
+      for (unsigned int j = 0; j < ranges.size(); ++j)
+	{
+	  int cu_index = ranges[j].cu_index;
+	  cu_index = cu_index >= 0 ? cu_base + cu_index : cu_index - tu_base;
+	  this->add_address_range_list(scan->object(), cu_index,
+				       ranges[j].ranges);
+	}
+
+      const std::vector<Gdb_index_scan::Scan_symbol>&
+	symbols(scan->symbols());
+      for (unsigned int j = 0; j < symbols.size(); ++j)
+	{
+	  int cu_index = symbols[j].cu_index;
+	  cu_index = cu_index >= 0 ? cu_base + cu_index : cu_index - tu_base;
+	  this->add_symbol(cu_index, symbols[j].name, symbols[j].flags);
+	}
+
+      Gdb_index_info_reader::record_stats(scan);
+      delete scan;
+    }
+  this->scans_.clear();
 }
 
 // Add a symbol.
@@ -1173,32 +1609,14 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
 Gdb_index::set_final_data_size()
 {
+  // Pick up any scans done while laying out the input objects.
+  this->merge_scans();
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
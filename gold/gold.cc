@@ -44,6 +44,7 @@
 #include "plugin.h"
 #include "gc.h"
 #include "icf.h"
+#include "gdb-index.h"
 #include "incremental.h"
 #include "timer.h"
 
@@ -530,7 +531,8 @@ queue_middle_tasks(const General_options& options,
   // be folding sections that will be garbage.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      symtab->icf()->find_identical_sections(input_objects, symtab,
+						 workqueue);
     }
 
   // Call Object::layout for the second time to determine the
@@ -777,6 +779,12 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // With --threads, scanning the debug info for the .gdb_index section
+  // was deferred.  The scans have to finish before the layout.
+  if (layout->gdb_index_data() != NULL)
+    this_blocker = layout->gdb_index_data()->queue_scan_tasks(workqueue,
+							      this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
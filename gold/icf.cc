@@ -157,6 +157,17 @@
 //
 // Performance : Less than 20 % link-time overhead on industry strength
 // applications.  Up to 6 %  text size reductions.
+//
+// Only relocations to sections that might be folded change from one
+// iteration to the next.  The rest of each section's identity (its
+// text and the relocations to sections that cannot be folded) is
+// built once, on the first iteration, and checksummed once.  Those
+// checksums are independent of each other and are computed by
+// Icf_cksum_task workers on the workqueue when --threads is in effect.
+// Each later iteration only extends the cached checksum with the
+// current kept section of every tracked relocation target.  Sections
+// are still grouped serially in section id order, so the folding
+// decisions do not depend on the number of threads.
 
 #include "gold.h"
 #include "object.h"
@@ -167,6 +178,8 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "gold-threads.h"
+#include "workqueue.h"
 
 #include <limits>
 
@@ -180,15 +193,15 @@ namespace gold
 // ID_SECTION : Vector mapping a section index to a Section_id pair.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
+// FIXED_CKSUMS : Contains the checksum of each section's text and relocs
+//                to sections that cannot be folded.  FIXED_CKSUMS is NULL
+//                implies that this function is being called for the
+//                first time before the first iteration of icf.
 
 static void
 preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
                                std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+                               const std::vector<uint32_t>* fixed_cksums)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
@@ -202,7 +215,7 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
       uint32_t cksum;
       Section_id secn = id_section[i];
       section_size_type plen;
-      if (section_contents == NULL)
+      if (fixed_cksums == NULL)
         {
           // Lock the object so we can read from it.  This is only called
           // single-threaded from queue_middle_tasks, so it is OK to lock.
@@ -216,12 +229,7 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
           cksum = xcrc32(contents, plen, 0xffffffff);
         }
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+        cksum = (*fixed_cksums)[i];
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -235,6 +243,228 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
     }
 }
 
+// A relocation to a section that might be folded.  How it contributes
+// to the identity of the section holding it depends on the current
+// kept section of its target, so it is recorded apart from the fixed
+// contents and rendered again on each iteration.
+
+struct Icf_tracked_reloc
+{
+  Icf_tracked_reloc(unsigned int secn_id_arg, const char* addend_arg)
+    : secn_id(secn_id_arg), addend(addend_arg)
+  { }
+
+  // The ICF id of the target section.
+  unsigned int secn_id;
+  // The symbol value, addend and offset of the reloc.
+  std::string addend;
+};
+
+typedef std::vector<Icf_tracked_reloc> Icf_tracked_relocs;
+
+// Append the contribution of the tracked relocs TRACKED_RELOCS to
+// BUFFER, using the current kept section of each target.
+
+static void
+append_tracked_relocs(const Icf_tracked_relocs& tracked_relocs,
+                      const std::vector<unsigned int>& kept_section_id,
+                      std::string* buffer)
+{
+  for (Icf_tracked_relocs::const_iterator p = tracked_relocs.begin();
+       p != tracked_relocs.end();
+       ++p)
+    {
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+               kept_section_id[p->secn_id]);
+      buffer->append(kept_section_str);
+      // Append the addend.
+      buffer->append(p->addend);
+      buffer->append("@");
+    }
+}
+
+// The checksums of the fixed section contents collected on the first
+// iteration are independent of each other.  This class holds the
+// state shared by the threads which compute them.  The sections are
+// split into shards, and every thread that takes part claims shards
+// until none are left.  The thread which runs ICF works on shards as
+// well, so the work completes even when no other workqueue thread is
+// free to help.
+
+class Icf_cksum_work
+{
+ public:
+  Icf_cksum_work(const std::vector<unsigned int>& sections,
+                 const std::vector<std::string>& section_contents,
+                 std::vector<uint32_t>* fixed_cksums)
+    : sections_(sections), section_contents_(section_contents),
+      fixed_cksums_(fixed_cksums), lock_(), condvar_(this->lock_),
+      next_shard_(0), shards_done_(0), refcount_(1)
+  {
+    this->shard_count_ = ((sections.size() + shard_size - 1)
+                          / shard_size);
+  }
+
+  // The number of shards.
+  unsigned int
+  shard_count() const
+  { return this->shard_count_; }
+
+  // Add a reference for a task which will take part.
+  void
+  add_ref()
+  {
+    Hold_lock hl(this->lock_);
+    ++this->refcount_;
+  }
+
+  // Drop a reference, deleting this object when it was the last one.
+  void
+  release()
+  {
+    bool last;
+    {
+      Hold_lock hl(this->lock_);
+      gold_assert(this->refcount_ > 0);
+      --this->refcount_;
+      last = this->refcount_ == 0;
+    }
+    if (last)
+      delete this;
+  }
+
+  // Claim and checksum shards until there are none left.
+  void
+  run_shards();
+
+  // Wait until every shard has been checksummed.
+  void
+  wait();
+
+ private:
+  // The number of sections in a shard.
+  static const unsigned int shard_size = 256;
+
+  // The ids of the sections to checksum.
+  const std::vector<unsigned int>& sections_;
+  // The fixed contents of each section, indexed by section id.
+  const std::vector<std::string>& section_contents_;
+  // Where to store the checksums, indexed by section id.
+  std::vector<uint32_t>* fixed_cksums_;
+  // Controls access to the members below.
+  Lock lock_;
+  // Signalled when a shard is done.
+  Condvar condvar_;
+  // The total number of shards.
+  unsigned int shard_count_;
+  // The next shard to claim.
+  unsigned int next_shard_;
+  // The number of shards which are done.
+  unsigned int shards_done_;
+  // The number of users of this object.
+  unsigned int refcount_;
+};
+
+void
+Icf_cksum_work::run_shards()
+{
+  while (true)
+    {
+      unsigned int shard;
+      {
+        Hold_lock hl(this->lock_);
+        if (this->next_shard_ >= this->shard_count_)
+          return;
+        shard = this->next_shard_++;
+      }
+
+      size_t begin = static_cast<size_t>(shard) * shard_size;
+      size_t end = std::min(begin + shard_size, this->sections_.size());
+      for (size_t j = begin; j < end; ++j)
+        {
+          unsigned int i = this->sections_[j];
+          const std::string& contents(this->section_contents_[i]);
+          (*this->fixed_cksums_)[i] =
+            xcrc32(reinterpret_cast<const unsigned char*>(contents.data()),
+                   contents.length(), 0xffffffff);
+        }
+
+      Hold_lock hl(this->lock_);
+      ++this->shards_done_;
+      if (this->shards_done_ == this->shard_count_)
+        this->condvar_.broadcast();
+    }
+}
+
+void
+Icf_cksum_work::wait()
+{
+  Hold_lock hl(this->lock_);
+  while (this->shards_done_ < this->shard_count_)
+    this->condvar_.wait();
+}
+
+// A task which helps checksum the fixed contents of ICF sections.
+
+class Icf_cksum_task : public Task
+{
+ public:
+  Icf_cksum_task(Icf_cksum_work* work)
+    : work_(work)
+  { this->work_->add_ref(); }
+
+  ~Icf_cksum_task()
+  { this->work_->release(); }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->work_->run_shards(); }
+
+  std::string
+  get_name() const
+  { return "Icf_cksum_task"; }
+
+ private:
+  Icf_cksum_work* work_;
+};
+
+// Compute the checksum of the fixed contents of each section listed in
+// SECTIONS, storing it in FIXED_CKSUMS.  With --threads the shards
+// are spread over the workqueue.
+
+static void
+compute_fixed_cksums(Workqueue* workqueue,
+                     const std::vector<unsigned int>& sections,
+                     const std::vector<std::string>& section_contents,
+                     std::vector<uint32_t>* fixed_cksums)
+{
+  Icf_cksum_work* work = new Icf_cksum_work(sections, section_contents,
+                                            fixed_cksums);
+  if (workqueue != NULL && parameters->options().threads())
+    {
+      unsigned int task_count = parameters->options().thread_count_middle();
+      if (task_count == 0 || task_count > work->shard_count())
+        task_count = work->shard_count();
+      // This thread takes one share of the work itself.
+      for (unsigned int i = 1; i < task_count; ++i)
+        workqueue->queue_soon(new Icf_cksum_task(work));
+    }
+  work->run_shards();
+  work->wait();
+  work->release();
+}
+
 // For SHF_MERGE sections that use REL relocations, the addend is stored in
 // the text section at the relocation offset.  Read  the addend value given
 // the pointer to the addend in the text section and the addend size.
@@ -290,8 +520,8 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
 //                      functions can be folded. Should normally be the
 //                      same as `secn` except when processing extra identity
 //                      regions.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// TRACKED_RELOCS     : Where to record the relocs to ICF sections, in
+//                      order; written if first_iteration is true.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // START_OFFSET       : Only consider the part of the section at and after
 //                      this offset.
@@ -303,7 +533,7 @@ get_section_contents(bool first_iteration,
 		     std::string* fixed_cache,
                      const Section_id& secn,
 		     const Section_id& self_secn,
-                     unsigned int* num_tracked_relocs,
+                     Icf_tracked_relocs* tracked_relocs,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
 		     section_offset_type start_offset = 0,
@@ -443,11 +673,11 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
               char kept_section_str[10];
               unsigned int secn_id = section_id_map_it->second;
+              if (tracked_relocs != NULL)
+                tracked_relocs->push_back(Icf_tracked_reloc(secn_id,
+                                                            addend_str));
               snprintf(kept_section_str, sizeof(kept_section_str), "%u",
                        kept_section_id[secn_id]);
               if (first_iteration)
@@ -620,7 +850,7 @@ get_section_contents(bool first_iteration,
       std::string external_all =
 	get_section_contents(first_iteration, &external_fixed,
 			     it_ext->second.section, self_secn,
-			     num_tracked_relocs, symtab,
+			     tracked_relocs, symtab,
 			     kept_section_id, it_ext->second.offset,
 			     it_ext->second.offset + it_ext->second.length);
       buffer.append(external_fixed);
@@ -660,25 +890,28 @@ get_section_contents(bool first_iteration,
 // contents are explicitly compared with the kept section of the group.
 //
 // Parameters  :
+// WORKQUEUE          : Workqueue used to checksum sections in parallel.
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
+// FIXED_CKSUMS       : Store the checksum of SECTION_CONTENTS.
+// TRACKED_RELOCS     : Store the section's relocs to ICF sections.
 
 static bool
-match_sections(unsigned int iteration_num,
+match_sections(Workqueue* workqueue,
+               unsigned int iteration_num,
                Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               std::vector<std::string>* section_contents,
+               std::vector<uint32_t>* fixed_cksums,
+               std::vector<Icf_tracked_relocs>* tracked_relocs)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
@@ -686,64 +919,77 @@ match_sections(unsigned int iteration_num,
   bool converged = true;
 
   if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
+    {
+      preprocess_for_unique_sections(id_section,
+                                     is_secn_or_group_unique,
+                                     NULL);
+
+      // Collect the parts of the contents which do not change from
+      // iteration to iteration.  This reads the input files, so it
+      // is done on this thread only.
+      std::vector<unsigned int> collected;
+      for (unsigned int i = 0; i < id_section.size(); i++)
+        {
+          if ((*is_secn_or_group_unique)[i])
+            continue;
+
+          Section_id secn = id_section[i];
+
+          // Lock the object so we can read from it.  This is only called
+          // single-threaded from queue_middle_tasks, so it is OK to lock.
+          // Unfortunately we have no way to pass in a Task token.
+          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+          Task_lock_obj<Object> tl(dummy_task, secn.first);
+
+          get_section_contents(true, &(*section_contents)[i], secn, secn,
+                               &(*tracked_relocs)[i], symtab,
+                               (*kept_section_id));
+          collected.push_back(i);
+        }
+
+      compute_fixed_cksums(workqueue, collected, *section_contents,
+                           fixed_cksums);
+    }
   else
     preprocess_for_unique_sections(id_section,
                                    is_secn_or_group_unique,
-                                   section_contents);
+                                   fixed_cksums);
 
   std::vector<std::string> full_section_contents;
 
+  // This loop stays serial on every iteration.  Grouping must see the
+  // sections in section id order for the fold decisions not to depend
+  // on the number of threads, and the only other work, extending the
+  // cached checksum with the tracked relocs, is a few bytes per section.
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
       full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, secn.first);
+      // This section is already folded into something.
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
+        continue;
 
-      std::string this_secn_contents;
-      uint32_t cksum;
-      std::string* this_secn_cache = &((*section_contents)[i]);
-      if (iteration_num == 1)
-        {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, this_secn_cache,
-						    secn, secn, &num_relocs,
-						    symtab, (*kept_section_id));
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, this_secn_cache,
-						    secn, secn, NULL,
-						    symtab, (*kept_section_id));
-        }
+      // The contents are the fixed part followed by the tracked relocs,
+      // so the checksum of the fixed part can be extended.
+      std::string tracked_contents;
+      append_tracked_relocs((*tracked_relocs)[i], *kept_section_id,
+                            &tracked_contents);
+      uint32_t cksum = xcrc32(reinterpret_cast<const unsigned char*>(
+                                tracked_contents.data()),
+                              tracked_contents.length(),
+                              (*fixed_cksums)[i]);
+      std::string this_secn_contents((*section_contents)[i]);
+      this_secn_contents.append(tracked_contents);
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
+          full_section_contents[i].swap(this_secn_contents);
         }
       else
         {
@@ -786,12 +1032,12 @@ match_sections(unsigned int iteration_num,
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              full_section_contents[i].swap(this_secn_contents);
             }
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && (*tracked_relocs)[i].empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -949,13 +1195,15 @@ Icf::add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
 
 void
 Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+                             Symbol_table* symtab,
+                             Workqueue* workqueue)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
   std::vector<uint64_t> section_addraligns;
   std::vector<bool> is_secn_or_group_unique;
   std::vector<std::string> section_contents;
+  std::vector<uint32_t> fixed_cksums;
+  std::vector<Icf_tracked_relocs> tracked_relocs;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -1001,10 +1249,10 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
 	  section_addraligns.push_back((*p)->section_addralign(i));
           is_secn_or_group_unique.push_back(false);
           section_contents.push_back("");
+          fixed_cksums.push_back(0);
           section_num++;
         }
 
@@ -1042,14 +1290,16 @@ Icf::find_identical_sections(const Input_objects* input_objects,
                             : 3;
 
   bool converged = false;
+  tracked_relocs.resize(section_num);
 
   while (!converged && (num_iterations < max_iterations))
     {
       num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
+      converged = match_sections(workqueue, num_iterations, symtab,
+                                 &this->kept_section_id_,
                                  this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+                                 &is_secn_or_group_unique, &section_contents,
+                                 &fixed_cksums, &tracked_relocs);
     }
 
   if (parameters->options().print_icf_sections())
@@ -35,6 +35,7 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
 
 class Icf
 {
@@ -90,10 +91,12 @@ class Icf
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
   // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // of each group is the kept section during folding.  WORKQUEUE is
+  // used to spread the checksumming over threads.
   void
   find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+                          Symbol_table* symtab,
+                          Workqueue* workqueue);
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
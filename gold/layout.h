@@ -696,6 +696,11 @@ class Layout
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // Return the .gdb_index section data, or NULL if there is none.
+  Gdb_index*
+  gdb_index_data() const
+  { return this->gdb_index_data_; }
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
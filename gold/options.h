@@ -1707,6 +1707,13 @@ class General_options
   set_incremental_disposition(Incremental_disposition disp)
   { this->incremental_disposition_ = disp; }
 
+  // Enable threads.  This is for programs such as dwp which use
+  // libgold without parsing a linker command line.  Only call this
+  // when ENABLE_THREADS is defined.
+  void
+  enable_threads()
+  { this->set_threads(true); }
+
   // The disposition to use for startup files (those that precede the
   // first --incremental-changed, etc. option).
   Incremental_disposition
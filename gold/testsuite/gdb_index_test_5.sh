@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# gdb_index_test_5.sh -- a test case for the --gdb-index option.
+
+# Copyright (C) 2025 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# gdb_index_test_5a is linked serially and gdb_index_test_5b with
+# --threads, which scans each object in its own task.  The results of
+# the scans are merged in input order, so the two indexes must be the
+# same.
+
+if ! cmp -s gdb_index_test_5a.stdout gdb_index_test_5b.stdout
+then
+    echo "The index differs with --threads:"
+    diff gdb_index_test_5a.stdout gdb_index_test_5b.stdout
+    exit 1
+fi
+
+# Check that the index covers the symbols of every object.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=gdb_index_test_5b.stdout
+
+check $STDOUT "^Version [4-7]"
+check $STDOUT "^\[ *[0-9]*\] main:"
+check $STDOUT "^\[ *[0-9]*\] one::c1:"
+check $STDOUT "^\[ *[0-9]*\] t1:"
+check $STDOUT "^\[ *[0-9]*\] t16a:"
+check $STDOUT "^\[  3\] 0x"
+
+exit 0
@@ -0,0 +1,62 @@
+// icf_threads_test.cc -- a test case for gold
+
+// Copyright (C) 2025 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to give identical code folding enough
+// sections to checksum them in several threads.  Each leaf<N> is
+// identical to leaf<N % 7>.  Each caller<N> only becomes identical to
+// caller<N % 7> once the leaf functions are folded, so folding takes
+// more than one iteration.
+
+template<int N>
+int
+leaf()
+{
+  return N % 7;
+}
+
+template<int N>
+int
+caller()
+{
+  return leaf<N>() + 1;
+}
+
+template<int N>
+struct instantiate
+{
+  static int
+  run()
+  { return caller<N>() + instantiate<N - 1>::run(); }
+};
+
+template<>
+struct instantiate<0>
+{
+  static int
+  run()
+  { return caller<0>(); }
+};
+
+int
+main()
+{
+  return instantiate<700>::run() == 0;
+}
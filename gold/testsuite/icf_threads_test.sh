@@ -0,0 +1,52 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test --icf=all with --threads.
+
+# Copyright (C) 2025 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify that icf folds the same
+# sections with --threads as without.  icf_threads_test_1 is linked
+# serially and icf_threads_test_2 with --threads, so their symbols
+# must have the same addresses.
+
+set -e
+
+if ! cmp -s icf_threads_test_1.stdout icf_threads_test_2.stdout
+then
+    echo "Identical Code Folding differs with --threads"
+    diff icf_threads_test_1.stdout icf_threads_test_2.stdout
+    exit 1
+fi
+
+check_folded()
+{
+    addr1=`grep " $2\$" $1 | awk '{print $1}'`
+    addr2=`grep " $3\$" $1 | awk '{print $1}'`
+    if test -z "$addr1" || test "$addr1" != "$addr2"
+    then
+	echo "Identical Code Folding did not fold $2 and $3"
+	exit 1
+    fi
+}
+
+check_folded icf_threads_test_2.stdout "int leaf<1>()" "int leaf<694>()"
+check_folded icf_threads_test_2.stdout "int caller<1>()" "int caller<694>()"
+
+exit 0
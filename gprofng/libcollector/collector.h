@@ -81,6 +81,9 @@ extern int __collector_check_segment (unsigned long addr,
 extern int __collector_check_readable_segment (unsigned long addr,
 					       unsigned long *base,
 					       unsigned long *end, int maxnretries);
+extern int __collector_check_elf_header (unsigned long addr,
+				       unsigned long *base,
+				       unsigned long *end);
 extern int __collector_ext_line_init (int * pfollow_this_experiment,
 				      const char * progspec,
 				      const char *progname);
@@ -88,10 +91,13 @@ extern int __collector_ext_line_install (char *, const char *);
 extern void __collector_ext_line_close ();
 extern void __collector_ext_unwind_init (int);
 extern void __collector_ext_unwind_close ();
+extern void __collector_ext_unwind_unmap (unsigned long vaddr,
+					 unsigned long size);
 extern int __collector_ext_jstack_unwind (char*, int, ucontext_t *);
 extern void __collector_ext_dispatcher_fork_child_cleanup ();
 extern void __collector_ext_unwind_key_init (int isPthread, void * stack);
 extern void __collector_ext_dispatcher_tsd_create_key ();
+extern void __collector_ext_iolib_tsd_create_key ();
 extern void __collector_ext_dispatcher_thread_timer_suspend ();
 extern int __collector_ext_dispatcher_thread_timer_resume ();
 extern int __collector_ext_dispatcher_install ();
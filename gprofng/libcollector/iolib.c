@@ -35,6 +35,7 @@
 #include "collector.h"
 #include "gp-experiment.h"
 #include "memmgr.h"
+#include "tsd.h"
 
 /* ------------- Data and prototypes for block management --------- */
 #define IO_BLK      0 /* Concurrent requests */
@@ -54,6 +55,15 @@
 #define CUR_FOFF(x) ((x) & 0x01ffffffffffffffULL)           /* bits 56: 0 */
 #define CUR_MAKE(busy, indx, foff) ((((uint64_t)(busy))<<63) | (((uint64_t)(indx))<<57) | ((uint64_t)(foff)) )
 
+/* Overhead statistics of a block, updated while the block is held */
+typedef struct Blkstats
+{
+  uint64_t npckts;          /* packets written */
+  uint64_t nbytes;          /* bytes written */
+  hrtime_t time;            /* time spent in __collector_write_packet */
+  uint32_t nblks;           /* blocks mapped to the file */
+} Blkstats;
+
 typedef struct Buffer
 {
   uint8_t *vaddr;
@@ -77,6 +87,9 @@ typedef struct DataHandle
   uint32_t chblk[NCHUNKS];  /* number of active blocks in a chunk */
   uint32_t nblk;            /* number of blocks in data file */
   int exempt;               /* if exempt from experiment size limit */
+  Blkstats *blkstats;       /* nflow*NCHUNKS array, if measuring overhead */
+  uint32_t ndropped;        /* packets lost because all blocks were busy */
+  pid_t owner;              /* process that measures the overhead */
 
   /* IO_TXT */
   Buffer *buffers;          /* array of text buffers */
@@ -90,6 +103,9 @@ static long blksz;          /* Block size. Multiple of page size. Power of two t
 static long log2blksz;      /* log2(blksz) to make (x/blksz)==(x>>log2blksz) fast. */
 static uint32_t size_limit; /* Experiment size limit */
 static uint32_t cur_size;   /* Current experiment size */
+static unsigned thread_key = COLLECTOR_TSD_INVALID_KEY; /* per-thread writer number */
+static uint32_t nwriters;   /* number of writer threads seen so far */
+static int measure_overhead; /* GPROFNG_COLLECTOR_OVERHEAD is set */
 static void init ();
 static void deleteHandle (DataHandle *hndl);
 static int exp_size_ck (int nblocks, char *fname);
@@ -100,6 +116,8 @@ static uint8_t *getBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static int remapBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static int newBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
 static void deleteBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk);
+static unsigned get_writer (void);
+static void report_overhead (DataHandle *hndl);
 
 /* IO_TXT */
 static int is_not_the_log_file (char *fname);
@@ -125,6 +143,8 @@ init ()
 	    pgsz, pgsz, (long) blksz, (long) blksz, (long) log2blksz);
   size_limit = 0;
   cur_size = 0;
+  char *s = CALL_UTIL (getenv)("GPROFNG_COLLECTOR_OVERHEAD");
+  measure_overhead = s != NULL && *s != 0 && CALL_UTIL (strcmp)(s, "0") != 0;
   initialized = 1;
 }
 
@@ -313,6 +333,16 @@ __collector_create_handle (char *descp)
       hndl->blkoff = (uint32_t*) __collector_allocCSize (__collector_heap, hndl->nflow * NCHUNKS * sizeof (uint32_t), 1);
       if (hndl->blkoff == NULL)
 	return NULL;
+      hndl->blkstats = NULL;
+      hndl->ndropped = 0;
+      hndl->owner = getpid ();
+      if (measure_overhead)
+	{
+	  size_t sz = hndl->nflow * NCHUNKS * sizeof (Blkstats);
+	  hndl->blkstats = (Blkstats*) __collector_allocCSize (__collector_heap, sz, 1);
+	  if (hndl->blkstats != NULL)
+	    CALL_UTIL (memset)(hndl->blkstats, 0, sz);
+	}
       hndl->nchnk = 0;
       for (int j = 0; j < NCHUNKS; ++j)
 	{
@@ -348,6 +378,10 @@ deleteHandle (DataHandle *hndl)
 	    continue;
 	  deleteBlock (hndl, j / NCHUNKS, j % NCHUNKS);
 	}
+      /* A fork child deletes the handles it inherited while the
+       * parent's log is still open; leave the report to the parent. */
+      if (hndl->blkstats && hndl->owner == getpid ())
+	report_overhead (hndl);
     }
   else if (hndl->iotype == IO_TXT)
     {
@@ -676,6 +710,8 @@ remapBlock (DataHandle *hndl, unsigned iflow, unsigned ichunk)
       goto exit;
     }
   CALL_UTIL (close)(fd);
+  if (hndl->blkstats)
+    hndl->blkstats[iflow * NCHUNKS + ichunk].nblks++;
 
   if (hndl->exempt == 0)
     exp_size_ck (1, hndl->fname);
@@ -776,16 +812,26 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
       TprintfT (0, "collector_write_packet: packet too long: %d (max %ld)\n", recsz, blksz);
       return 1;
     }
-  collector_thread_t tid = __collector_no_threads ? __collector_lwp_self ()
-						  : __collector_thr_self ();
-  unsigned iflow = (unsigned) (((unsigned long) tid) % hndl->nflow);
+  hrtime_t start = hndl->blkstats ? __collector_gethrtime () : 0;
+
+  /*
+   * Each writer thread has its own block: writer N uses flow N % nflow
+   * and starts looking at chunk N / nflow, so the threads sharing a flow
+   * don't compete for the same blocks.  IO_SEQ requests keep using the
+   * first free block to preserve their order in the file.
+   */
+  unsigned writer = get_writer ();
+  unsigned iflow = writer % hndl->nflow;
+  unsigned chunk0 = hndl->iotype == IO_BLK ? (writer / hndl->nflow) % NCHUNKS : 0;
 
   /* Acquire block */
   uint32_t *sptr = &hndl->blkstate[iflow * NCHUNKS];
   uint32_t state = ST_BUSY;
   unsigned ichunk;
-  for (ichunk = 0; ichunk < NCHUNKS; ++ichunk)
+  unsigned i;
+  for (i = 0; i < NCHUNKS; ++i)
     {
+      ichunk = (chunk0 + i) % NCHUNKS;
       uint32_t oldstate = sptr[ichunk];
       if (oldstate == ST_BUSY)
 	continue;
@@ -802,13 +848,15 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
 	break;
     }
 
-  if (state == ST_BUSY || ichunk == NCHUNKS)
+  if (state == ST_BUSY || i == NCHUNKS)
     {
       /* We are out of blocks for this data flow.
        * We might switch to another flow but for now report and return.
        */
       TprintfT (0, "collector_write_packet: all %d blocks on flow %d for %s are busy\n",
 		NCHUNKS, iflow, hndl->fname);
+      if (hndl->blkstats)
+	__collector_inc_32 (&hndl->ndropped);
       return 1;
     }
 
@@ -845,10 +893,80 @@ __collector_write_packet (DataHandle *hndl, CM_Packet *pckt)
       return 0;
     }
   hndl->blkoff[iflow * NCHUNKS + ichunk] += recsz;
+  if (hndl->blkstats)
+    {
+      Blkstats *st = &hndl->blkstats[iflow * NCHUNKS + ichunk];
+      st->npckts++;
+      st->nbytes += recsz;
+      st->time += __collector_gethrtime () - start;
+    }
   sptr[ichunk] = ST_FREE;
   return 0;
 }
 
+void
+__collector_ext_iolib_tsd_create_key ()
+{
+  thread_key = __collector_tsd_create_key (sizeof (uint32_t), NULL, NULL);
+  nwriters = 0;
+}
+
+/*
+ * Return a small number identifying the calling thread.  Threads are
+ * numbered in the order of their first write.
+ */
+static unsigned
+get_writer (void)
+{
+  if (__collector_no_threads)
+    return (unsigned) __collector_lwp_self ();
+  uint32_t *writer = (uint32_t *) __collector_tsd_get_by_key (thread_key);
+  if (writer == NULL)
+    return (unsigned) __collector_thr_self ();
+  if (*writer == 0)
+    {
+      uint32_t oldcnt = nwriters;
+      for (;;)
+	{
+	  uint32_t newcnt = __collector_cas_32 (&nwriters, oldcnt, oldcnt + 1);
+	  if (newcnt == oldcnt)
+	    break;
+	  oldcnt = newcnt;
+	}
+      *writer = oldcnt + 1;
+    }
+  return *writer - 1;
+}
+
+/*
+ * Write the statistics collected for GPROFNG_COLLECTOR_OVERHEAD
+ * to the log file.
+ */
+static void
+report_overhead (DataHandle *hndl)
+{
+  uint64_t npckts = 0;
+  uint64_t nbytes = 0;
+  hrtime_t time = 0;
+  uint32_t nblks = 0;
+  for (int j = 0; j < hndl->nflow * NCHUNKS; ++j)
+    {
+      Blkstats *st = &hndl->blkstats[j];
+      npckts += st->npckts;
+      nbytes += st->nbytes;
+      time += st->time;
+      nblks += st->nblks;
+    }
+  char *fname = __collector_strrchr (hndl->fname, '/');
+  fname = fname ? fname + 1 : hndl->fname;
+  (void) __collector_log_write ("<event kind=\"%s\" id=\"%d\">collector overhead for %s: %llu packets, %llu bytes, %u blocks, %u dropped, %lld.%09lld sec. in writes, %u threads</event>\n",
+				SP_JCMD_COMMENT, COL_COMMENT_NONE, fname,
+				(unsigned long long) npckts,
+				(unsigned long long) nbytes, nblks,
+				hndl->ndropped, (long long) (time / NANOSEC),
+				(long long) (time % NANOSEC), nwriters);
+}
+
 /*
  *    IO_TXT files
  *
@@ -747,6 +747,7 @@ update_map_segments (hrtime_t hrt, int resolve)
 	      /* Don't record MA_ANON maps except MA_STACK and MA_BREAK */
 	      if ((!(oldp->mflags & MA_ANON) || (oldp->mflags & (MA_STACK | MA_BREAK))))
 		record_segment_unmap (hrt, oldp->vaddr);
+	      __collector_ext_unwind_unmap (oldp->vaddr, oldp->size);
 	      /* Remove and free map */
 	      prev->next = oldp->next;
 	      MapInfo *tmp = oldp;
@@ -893,6 +894,37 @@ __collector_check_readable_segment( unsigned long addr, unsigned long *base, uns
     return res;
 }
 
+/**
+ * Find the mapping of the ELF header of the file mapped at addr
+ * @param addr
+ * @param base
+ * @param end
+ * @return 1 - found, 0 - addr is not in a file mapping
+ */
+int
+__collector_check_elf_header (unsigned long addr, unsigned long *base,
+			      unsigned long *end)
+{
+  MapInfo *hdr = NULL;
+  MapInfo *mp;
+  for (mp = mmaps.next; mp && mp->vaddr <= addr; mp = mp->next)
+    {
+      if (mp->offset == 0 && (mp->mflags & PROT_READ))
+	hdr = mp;
+      if (addr < mp->vaddr + mp->size)
+	{
+	  if (hdr == NULL || hdr->mapname != mp->mapname || *mp->mapname == 0)
+	    break;
+	  *base = hdr->vaddr;
+	  *end = hdr->vaddr + hdr->size;
+	  return 1;
+	}
+    }
+  *base = 0;
+  *end = 0;
+  return 0;
+}
+
 static ELF_AUX *auxv = NULL;
 
 static void
@@ -21,6 +21,7 @@
 #include "config.h"
 #include <alloca.h>
 #include <dlfcn.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
@@ -106,7 +107,9 @@ static unsigned long misalign_hdlx = 0;
 #endif
 
 #elif ARCH(Intel)
+#include <elf.h>
 #include "opcodes/disassemble.h"
+#include "sframe.h"
 
 static int
 fprintf_func (void *arg ATTRIBUTE_UNUSED, const char *fmt ATTRIBUTE_UNUSED, ...)
@@ -311,6 +314,43 @@ struct WalkContext
   unsigned long tbgn;  /* current memory segment start */
   unsigned long tend;  /* current memory segment end */
 };
+
+#if WSIZE(64)
+/*
+ * SFrame stack trace information of a text segment.
+ * The table is filled in lazily by the unwinder; the SFrame sections
+ * are read in place, where the dynamic linker has loaded them.
+ */
+#define MAXSFRAMES	256
+
+enum
+{
+  SF_FREE = 0,      /* unused entry */
+  SF_BUSY,          /* entry is being filled in */
+  SF_NONE,          /* no usable SFrame section */
+  SF_VALID
+};
+
+typedef struct SFrameInfo
+{
+  volatile uint32_t state;
+  unsigned long tbgn;   /* text segment */
+  unsigned long tend;
+  unsigned long sfbgn;  /* SFrame section */
+  unsigned long sfend;
+  const char *fdes;
+  const char *fres;
+  const char *fres_end;
+  uint32_t nfdes;
+  uint32_t fde_size;    /* the version 1 FDEs lack the last two fields */
+  int pcrel;            /* function start addresses are relative to the FDE */
+  int ra_offset;        /* fixed offset of the return address from the CFA */
+} SFrameInfo;
+
+static SFrameInfo *SFrameTable = NULL;
+static uint32_t nsframes = 0;   /* number of used entries in SFrameTable */
+static int use_sframe = 1;
+#endif /* WSIZE(64) */
 #endif
 
 #if defined(DEBUG) && ARCH(Intel)
@@ -420,6 +460,12 @@ __collector_ext_unwind_init (int record)
 	    max_native_nframes, max_java_nframes);
   omp_no_walk = 1;
 
+#if ARCH(Intel) && WSIZE(64)
+  str = CALL_UTIL (getenv)("GPROFNG_USE_SFRAME");
+  use_sframe = str == NULL || CALL_UTIL (strcmp)(str, "0") != 0;
+  TprintfT (DBG_LT0, "GPROFNG_USE_SFRAME=%d\n", use_sframe);
+#endif
+
   if (__collector_VM_ReadByteInstruction == NULL)
     __collector_VM_ReadByteInstruction = (int(*)(unsigned char*)) dlsym (RTLD_DEFAULT, "Async_VM_ReadByteInstruction");
 
@@ -462,6 +508,17 @@ __collector_ext_unwind_init (int record)
 	  return;
 	}
     }
+#if WSIZE(64)
+  nsframes = 0;
+  SFrameTable = NULL;
+  if (use_sframe)
+    {
+      sz = MAXSFRAMES * sizeof (*SFrameTable);
+      SFrameTable = (SFrameInfo *) __collector_allocCSize (__collector_heap, sz, 1);
+      if (SFrameTable != NULL)
+	CALL_UTIL (memset)((void*) SFrameTable, 0, sz);
+    }
+#endif
 #endif /* ARCH() */
 
   if (record)
@@ -489,6 +546,31 @@ __collector_ext_unwind_close ()
   dhndl = NULL;
 }
 
+/*
+ * Forget the SFrame information of the objects that were mapped
+ * at [vaddr, vaddr + size).
+ */
+void
+__collector_ext_unwind_unmap (unsigned long vaddr, unsigned long size)
+{
+#if ARCH(Intel) && WSIZE(64)
+  if (SFrameTable == NULL)
+    return;
+  for (uint32_t i = 0; i < nsframes; i++)
+    {
+      SFrameInfo *sf = SFrameTable + i;
+      if (sf->state < SF_NONE)
+	continue;
+      if ((sf->tbgn < vaddr + size && sf->tend > vaddr)
+	  || (sf->state == SF_VALID && sf->sfbgn < vaddr + size && sf->sfend > vaddr))
+	sf->state = SF_FREE;
+    }
+#else
+  (void) vaddr;
+  (void) size;
+#endif
+}
+
 void*
 __collector_ext_return_address (unsigned level)
 {
@@ -4392,6 +4474,288 @@ parse_x86_AVX_instruction (unsigned char *pc)
   return len;
 }
 
+#if WSIZE(64)
+#ifndef PT_GNU_SFRAME
+#define PT_GNU_SFRAME	0x6474e554
+#endif
+#ifndef SFRAME_F_FDE_FUNC_START_PCREL
+#define SFRAME_F_FDE_FUNC_START_PCREL 0x4
+#endif
+
+/*
+ * Find the SFrame section of the object whose text segment is SF->tbgn.
+ * Returns 1 if a usable section was found.
+ */
+static int
+sframe_load (SFrameInfo *sf)
+{
+  unsigned long hbgn, hend;
+  if (!__collector_check_elf_header (sf->tbgn, &hbgn, &hend))
+    return 0;
+  Elf64_Ehdr *ehdr = (Elf64_Ehdr *) hbgn;
+  if (hbgn + sizeof (Elf64_Ehdr) > hend
+      || __collector_strncmp ((char *) ehdr->e_ident, ELFMAG, SELFMAG) != 0
+      || ehdr->e_ident[EI_CLASS] != ELFCLASS64
+      || ehdr->e_phentsize != sizeof (Elf64_Phdr)
+      || ehdr->e_phoff + ehdr->e_phnum * sizeof (Elf64_Phdr) > hend - hbgn)
+    return 0;
+
+  /* The ELF header is at file offset 0 of the first loadable segment */
+  Elf64_Phdr *phdr = (Elf64_Phdr *) (hbgn + ehdr->e_phoff);
+  Elf64_Phdr *sfphdr = NULL;
+  unsigned long bias = 0;
+  int nload = 0;
+  for (int i = 0; i < ehdr->e_phnum; i++)
+    {
+      if (phdr[i].p_type == PT_LOAD && nload++ == 0)
+	bias = hbgn - (phdr[i].p_vaddr - phdr[i].p_offset);
+      else if (phdr[i].p_type == PT_GNU_SFRAME)
+	sfphdr = phdr + i;
+    }
+  if (nload == 0 || sfphdr == NULL)
+    return 0;
+
+  unsigned long sfbgn = bias + sfphdr->p_vaddr;
+  unsigned long sfend = sfbgn + sfphdr->p_memsz;
+  unsigned long sbgn, send;
+  if (sfend <= sfbgn + sizeof (sframe_header)
+      || !__collector_check_readable_segment (sfbgn, &sbgn, &send, 0)
+      || sfend > send)
+    return 0;
+
+  sframe_header *sfh = (sframe_header *) sfbgn;
+  if (sfh->sfh_preamble.sfp_magic != SFRAME_MAGIC
+      || (sfh->sfh_preamble.sfp_version != SFRAME_VERSION_1
+	  && sfh->sfh_preamble.sfp_version != SFRAME_VERSION_2)
+      || (sfh->sfh_preamble.sfp_flags & SFRAME_F_FDE_SORTED) == 0
+      || sfh->sfh_abi_arch != SFRAME_ABI_AMD64_ENDIAN_LITTLE
+      || sfh->sfh_cfa_fixed_ra_offset == SFRAME_CFA_FIXED_RA_INVALID)
+    return 0;
+  unsigned long data = sfbgn + SFRAME_V1_HDR_SIZE (*sfh);
+  unsigned long fdes = data + sfh->sfh_fdeoff;
+  unsigned long fres = data + sfh->sfh_freoff;
+  uint32_t fde_size = sfh->sfh_preamble.sfp_version == SFRAME_VERSION_1
+		      ? offsetof (sframe_func_desc_entry, sfde_func_rep_size)
+		      : sizeof (sframe_func_desc_entry);
+  if (fdes + sfh->sfh_num_fdes * fde_size > sfend
+      || fres + sfh->sfh_fre_len > sfend)
+    return 0;
+  sf->sfbgn = sfbgn;
+  sf->sfend = sfend;
+  sf->fdes = (const char *) fdes;
+  sf->nfdes = sfh->sfh_num_fdes;
+  sf->fde_size = fde_size;
+  sf->fres = (const char *) fres;
+  sf->fres_end = (const char *) fres + sfh->sfh_fre_len;
+  sf->pcrel = (sfh->sfh_preamble.sfp_flags & SFRAME_F_FDE_FUNC_START_PCREL) != 0;
+  sf->ra_offset = sfh->sfh_cfa_fixed_ra_offset;
+  DprintfT (SP_DUMP_UNWIND, "sframe_load: text 0x%lx-0x%lx sframe 0x%lx-0x%lx %u fdes\n",
+	    sf->tbgn, sf->tend, sfbgn, sfend, sf->nfdes);
+  return 1;
+}
+
+/*
+ * Find the SFrameInfo for the text segment [tbgn, tend).
+ * A new entry is created the first time a segment is seen.
+ */
+static SFrameInfo *
+sframe_lookup (unsigned long tbgn, unsigned long tend)
+{
+  uint32_t n = nsframes;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      SFrameInfo *sf = SFrameTable + i;
+      if (sf->state >= SF_NONE && sf->tbgn == tbgn && sf->tend == tend)
+	return sf;
+    }
+
+  /* Reuse a free entry or take a new one */
+  SFrameInfo *sf = NULL;
+  for (uint32_t i = 0; i < n && sf == NULL; i++)
+    if (SFrameTable[i].state == SF_FREE
+	&& __collector_cas_32 (&SFrameTable[i].state, SF_FREE, SF_BUSY) == SF_FREE)
+      sf = SFrameTable + i;
+  while (sf == NULL)
+    {
+      if (n >= MAXSFRAMES)
+	return NULL;
+      uint32_t old = __collector_cas_32 (&nsframes, n, n + 1);
+      if (old == n)
+	{
+	  sf = SFrameTable + n;
+	  sf->state = SF_BUSY;
+	}
+      else
+	n = old;
+    }
+  sf->tbgn = tbgn;
+  sf->tend = tend;
+  uint32_t state = sframe_load (sf) ? SF_VALID : SF_NONE;
+  __sync_synchronize ();
+  sf->state = state;
+  return sf;
+}
+
+static inline const sframe_func_desc_entry *
+sframe_fde (SFrameInfo *sf, uint32_t i)
+{
+  return (const sframe_func_desc_entry *) (sf->fdes + i * sf->fde_size);
+}
+
+static inline unsigned long
+sframe_func_start (SFrameInfo *sf, uint32_t i)
+{
+  const sframe_func_desc_entry *fde = sframe_fde (sf, i);
+  unsigned long base = sf->pcrel ? (unsigned long) fde : sf->sfbgn;
+  return base + (long) fde->sfde_func_start_address;
+}
+
+static inline uint32_t
+sframe_read (const char *p, int size)
+{
+  switch (size)
+    {
+    case 1:
+      return *(const uint8_t *) p;
+    case 2:
+      return *(const uint16_t *) p;
+    default:
+      return *(const uint32_t *) p;
+    }
+}
+
+/*
+ * Compute the caller's frame from the SFrame row of wctx->pc.
+ * Returns RA_FAILURE and leaves wctx unchanged when there is no row
+ * for the pc, so that the caller can fall back on code analysis.
+ */
+static int
+sframe_unwind (struct WalkContext *wctx, SFrameInfo **last)
+{
+  if (SFrameTable == NULL || wctx->tbgn == 0)
+    return RA_FAILURE;
+  SFrameInfo *sf = *last;
+  if (sf == NULL || sf->tbgn != wctx->tbgn || sf->tend != wctx->tend
+      || sf->state != SF_VALID)
+    {
+      sf = sframe_lookup (wctx->tbgn, wctx->tend);
+      if (sf == NULL || sf->state != SF_VALID)
+	return RA_FAILURE;
+      *last = sf;
+    }
+
+  /* Find the last function that starts at or before pc */
+  unsigned long pc = wctx->pc;
+  uint32_t lo = 0;
+  uint32_t hi = sf->nfdes;
+  while (lo < hi)
+    {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (sframe_func_start (sf, mid) <= pc)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return RA_FAILURE;
+  const sframe_func_desc_entry *fde = sframe_fde (sf, lo - 1);
+  unsigned long func_start = sframe_func_start (sf, lo - 1);
+  if (pc - func_start >= fde->sfde_func_size)
+    return RA_FAILURE;
+
+  /* Find the last row that starts at or before pc */
+  uint8_t func_info = fde->sfde_func_info;
+  int fre_type = SFRAME_V1_FUNC_FRE_TYPE (func_info);
+  int addr_size = fre_type == SFRAME_FRE_TYPE_ADDR1 ? 1
+		  : fre_type == SFRAME_FRE_TYPE_ADDR2 ? 2
+		  : fre_type == SFRAME_FRE_TYPE_ADDR4 ? 4 : 0;
+  if (addr_size == 0)
+    return RA_FAILURE;
+  uint32_t off = (uint32_t) (pc - func_start);
+  if (SFRAME_V1_FUNC_FDE_TYPE (func_info) == SFRAME_FDE_TYPE_PCMASK)
+    {
+      /* Version 1 has no block size; it is always 16 */
+      uint32_t rep_size = sf->fde_size == sizeof (sframe_func_desc_entry)
+			  ? fde->sfde_func_rep_size : 16;
+      if (rep_size == 0)
+	return RA_FAILURE;
+      off %= rep_size;
+    }
+  const char *fre = sf->fres + fde->sfde_func_start_fre_off;
+  const char *row = NULL;
+  for (uint32_t j = 0; j < fde->sfde_func_num_fres; j++)
+    {
+      if (fre + addr_size + 1 > sf->fres_end)
+	return RA_FAILURE;
+      uint8_t fre_info = fre[addr_size];
+      int nofs = SFRAME_V1_FRE_OFFSET_COUNT (fre_info);
+      int osize = 1 << SFRAME_V1_FRE_OFFSET_SIZE (fre_info);
+      if (sframe_read (fre, addr_size) > off)
+	break;
+      row = fre;
+      fre += addr_size + 1 + nofs * osize;
+    }
+  if (row == NULL || row + addr_size + 1 > sf->fres_end)
+    return RA_FAILURE;
+
+  /* Get the CFA and the locations of the return address and frame pointer */
+  uint8_t fre_info = row[addr_size];
+  int nofs = SFRAME_V1_FRE_OFFSET_COUNT (fre_info);
+  int osize = 1 << SFRAME_V1_FRE_OFFSET_SIZE (fre_info);
+  const char *ofs = row + addr_size + 1;
+  if (nofs < 1 || nofs > 2 || osize > 4 || ofs + nofs * osize > sf->fres_end)
+    return RA_FAILURE;
+  long cfa_offset = (int32_t) sframe_read (ofs, osize);
+  if (osize == 1)
+    cfa_offset = (int8_t) cfa_offset;
+  else if (osize == 2)
+    cfa_offset = (int16_t) cfa_offset;
+  unsigned long cfa = SFRAME_V1_FRE_CFA_BASE_REG_ID (fre_info) == SFRAME_BASE_REG_SP
+		      ? wctx->sp : wctx->fp;
+  cfa += cfa_offset;
+  unsigned long *ra_loc = (unsigned long *) (cfa + sf->ra_offset);
+  if (cfa <= wctx->sp || cfa >= wctx->sbase
+      || (unsigned long) ra_loc < wctx->sp)
+    return RA_FAILURE;
+  unsigned long fp = wctx->fp;
+  if (nofs == 2)
+    {
+      long fp_offset = (int32_t) sframe_read (ofs + osize, osize);
+      if (osize == 1)
+	fp_offset = (int8_t) fp_offset;
+      else if (osize == 2)
+	fp_offset = (int16_t) fp_offset;
+      unsigned long *fp_loc = (unsigned long *) (cfa + fp_offset);
+      if ((unsigned long) fp_loc < wctx->sp || (unsigned long) fp_loc >= cfa)
+	return RA_FAILURE;
+      fp = *fp_loc;
+    }
+
+  unsigned long ra = *ra_loc;
+  if (ra == 0)
+    {
+      wctx->pc = 0;
+      wctx->sp = cfa;
+      wctx->fp = fp;
+      return RA_END_OF_STACK;
+    }
+  unsigned long tbgn = wctx->tbgn;
+  unsigned long tend = wctx->tend;
+  if (ra < tbgn || ra >= tend)
+    if (!__collector_check_segment (ra, &tbgn, &tend, 0))
+      return RA_FAILURE;
+  unsigned long npc = adjust_ret_addr (ra, ra - tbgn, tend);
+  DprintfT (SP_DUMP_UNWIND, "sframe_unwind: pc=0x%lx cfa=0x%lx ra=0x%lx npc=0x%lx\n",
+	    pc, cfa, ra, npc);
+  wctx->pc = npc != 0 ? npc : ra;
+  wctx->sp = cfa;
+  wctx->fp = fp;
+  wctx->tbgn = tbgn;
+  wctx->tend = tend;
+  return RA_SUCCESS;
+}
+#endif /* WSIZE(64) */
+
 /*
  * In the Intel world, a stack frame looks like this:
  *
@@ -4442,6 +4806,9 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
     }
   // We do not know yet if update_map_segments is really needed
   __collector_check_segment (wctx.pc, &wctx.tbgn, &wctx.tend, 0);
+#if WSIZE(64)
+  SFrameInfo *sfinfo = NULL;  /* SFrame info of the last text segment */
+#endif
 
   for (;;)
     {
@@ -4471,7 +4838,13 @@ stack_unwind (char *buf, int size, void *bptr, void *eptr, ucontext_t *context,
 	      ind = ind >= 2 ? ind - 2 : 0;
 	      goto exit;
 	    }
+#if WSIZE(64)
+	  int ret = sframe_unwind (&wctx, &sfinfo);
+	  if (ret == RA_FAILURE)
+	    ret = find_i386_ret_addr (&wctx, do_walk);
+#else
 	  int ret = find_i386_ret_addr (&wctx, do_walk);
+#endif
 	  DprintfT (SP_DUMP_UNWIND, "stack_unwind (x86 walk):%d find_i386_ret_addr returns %d\n", __LINE__, ret);
 	  if (ret == RA_FAILURE)
 	    {
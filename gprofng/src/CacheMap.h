@@ -50,6 +50,7 @@ public:
   Value_t get (Key_t key, typename Map<Key_t, Value_t>::Relation rel);
   Value_t
   remove (Key_t key);
+  void update_values (Value_t (*func) (Value_t, void *), void *arg);
 
 private:
 
@@ -183,4 +184,21 @@ CacheMap<Key_t, Value_t>::remove (Key_t key)
   return res;
 }
 
+// Replace every cached value with func (value, arg)
+template <typename Key_t, typename Value_t>
+void
+CacheMap<Key_t, Value_t>::update_values (Value_t (*func) (Value_t, void *),
+					 void *arg)
+{
+  for (int i = 0, sz = INIT_SIZE; i < nchunks; i++)
+    {
+      Entry *chunk = chunks[i];
+      for (int j = 0; j < sz; j++)
+	if (chunk[j].key != (Key_t) 0)
+	  chunk[j].val = func (chunk[j].val, arg);
+      if (i > 0)
+	sz *= 2;
+    }
+}
+
 #endif
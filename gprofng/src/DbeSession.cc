@@ -133,6 +133,7 @@ DbeSession::DbeSession (Settings *_settings, bool _ipc_mode, bool _rdt_mode)
   comp_lobjs = new HashMap<char*, LoadObject*>;
   comp_dbelines = new HashMap<char*, DbeLine*>;
   comp_sources = new HashMap<char*, SourceFile*>;
+  thread_pool = new DbeThreadPool (-1);
   loadObjMap = new DbeSyncMap<LoadObject>;
   f_special = new Vector<Function*>(LastSpecialFunction);
   omp_functions = new Vector<Function*>(OMP_LAST_STATE);
@@ -383,6 +384,8 @@ DbeSession::DbeSession (Settings *_settings, bool _ipc_mode, bool _rdt_mode)
 
 DbeSession::~DbeSession ()
 {
+  thread_pool->wait_queues ();
+  delete thread_pool;
   Destroy (views);
   Destroy (exps);
   Destroy (dobjs);
@@ -662,6 +665,12 @@ DbeSession::get_sources ()
   return sources;
 }
 
+DbeThreadPool *
+DbeSession::get_thread_pool ()
+{
+  return thread_pool;
+}
+
 DbeFile *
 DbeSession::getDbeFile (char *filename, int filetype)
 {
@@ -1106,8 +1115,12 @@ read_experiment_data_in_parallel (void *arg)
 {
   exp_ctx *ctx = (exp_ctx *) arg;
   Experiment *dexp = ctx->exp;
-  bool read_ahead = ctx->read_ahead;
-  dexp->read_experiment_data (read_ahead);
+  // The frame info file and the event data files are queued separately,
+  // so that decoding them overlaps.
+  if (ctx->read_ahead)
+    dexp->read_ahead_data ();
+  else
+    dexp->read_experiment_data (false);
   free (ctx);
   return 0;
 }
@@ -1245,13 +1258,17 @@ DbeSession::open_experiment (Experiment *exp, char *path)
     {
       if (t_exp_list[j] == NULL) continue;
       Experiment *dexp = t_exp_list[j];
-      exp_ctx *new_ctx = (exp_ctx*) xmalloc (sizeof (exp_ctx));
-      new_ctx->path = NULL;
-      new_ctx->exp = dexp;
-      new_ctx->ds = this;
-      new_ctx->read_ahead = true;
-      DbeQueue *q = new DbeQueue (read_experiment_data_in_parallel, new_ctx);
-      threadPool->put_queue (q);
+      for (int read_ahead = 0; read_ahead < 2; read_ahead++)
+	{
+	  exp_ctx *new_ctx = (exp_ctx*) xmalloc (sizeof (exp_ctx));
+	  new_ctx->path = NULL;
+	  new_ctx->exp = dexp;
+	  new_ctx->ds = this;
+	  new_ctx->read_ahead = read_ahead != 0;
+	  DbeQueue *q = new DbeQueue (read_experiment_data_in_parallel,
+				      new_ctx);
+	  threadPool->put_queue (q);
+	}
     }
   threadPool->wait_queues ();
   delete threadPool;
@@ -63,6 +63,7 @@ class Function;
 class JMethod;
 class Histable;
 class DbeView;
+class DbeThreadPool;
 class Module;
 class LoadObject;
 class DataObject;
@@ -407,6 +408,10 @@ public:
   };
   Vector<SourceFile *> *get_sources ();
 
+  // A thread pool for short requests, kept for the whole session.
+  // Wait for the requests with DbeThreadPool::wait_idle.
+  DbeThreadPool *get_thread_pool ();
+
 private:
   void init ();
   void check_tab_avail ();
@@ -460,6 +465,7 @@ private:
   List **dnameHTable;                   // DataObject name hash table
   Settings *settings;                   // setting/defaults structure
   Vector<IndexObjType_t*> *dyn_indxobj; // Index Object definitions
+  DbeThreadPool *thread_pool;           // see get_thread_pool
   int dyn_indxobj_indx;
   int dyn_indxobj_indx_fixed;
 
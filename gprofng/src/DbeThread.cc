@@ -62,6 +62,7 @@ thread_pool_loop (void* arg)
 		   "thread_pool_loop:%d thread=%llu queue=%d done\n",
 		   __LINE__, (unsigned long long) pthread_self (), q->id);
 	  delete q;
+	  thrp->queue_done ();
 	  continue;
 	}
       if (thrp->no_new_queues)
@@ -73,12 +74,10 @@ thread_pool_loop (void* arg)
       Dprintf (DEBUG_THREADS,
 	       "thread_pool_loop:%d before pthread_cond_wait thread=%llu\n",
 	       __LINE__, (unsigned long long) pthread_self ());
-      pthread_mutex_lock (&thrp->p_mutex);
-      pthread_cond_wait (&thrp->p_cond_var, &thrp->p_mutex);
+      thrp->wait_for_queue ();
       Dprintf (DEBUG_THREADS,
 	       "thread_pool_loop:%d after pthread_cond_wait thread=%llu\n",
 	       __LINE__, (unsigned long long) pthread_self ());
-      pthread_mutex_unlock (&thrp->p_mutex);
     }
 
   // never reached, but we must use it here. See `man pthread_cleanup_push`
@@ -107,12 +106,14 @@ DbeThreadPool::DbeThreadPool (int _max_threads)
 	   __LINE__, _max_threads, max_threads);
   pthread_mutex_init (&p_mutex, NULL);
   pthread_cond_init (&p_cond_var, NULL);
+  pthread_cond_init (&p_done_var, NULL);
   threads = new Vector <pthread_t>(max_threads);
   queue = NULL;
   last_queue = NULL;
   no_new_queues = false;
   queues_cnt = 0;
   total_queues = 0;
+  running_cnt = 0;
 }
 
 DbeThreadPool::~DbeThreadPool ()
@@ -133,11 +134,33 @@ DbeThreadPool::get_queue ()
     {
       queue = q->next;
       queues_cnt--;
+      running_cnt++;
     }
   pthread_mutex_unlock (&p_mutex);
   return q;
 }
 
+// Called when a request returned by get_queue is done
+void
+DbeThreadPool::queue_done ()
+{
+  pthread_mutex_lock (&p_mutex);
+  running_cnt--;
+  if (running_cnt == 0 && queue == NULL)
+    pthread_cond_broadcast (&p_done_var);
+  pthread_mutex_unlock (&p_mutex);
+}
+
+// Wait until a request is queued, or until no new requests will come
+void
+DbeThreadPool::wait_for_queue ()
+{
+  pthread_mutex_lock (&p_mutex);
+  while (queue == NULL && !no_new_queues)
+    pthread_cond_wait (&p_cond_var, &p_mutex);
+  pthread_mutex_unlock (&p_mutex);
+}
+
 void
 DbeThreadPool::put_queue (DbeQueue *q)
 {
@@ -195,7 +218,7 @@ DbeThreadPool::wait_queues ()
   no_new_queues = true;
   pthread_mutex_unlock (&p_mutex);
   pthread_cond_broadcast (&p_cond_var);
-  for (;;) // Run requests on the worked thread too
+  for (;;) // Run requests on the calling thread too
     {
       DbeQueue *q = get_queue ();
       if (q == NULL)
@@ -206,6 +229,7 @@ DbeThreadPool::wait_queues ()
       Dprintf (DEBUG_THREADS, "wait_queues:%d thread=%llu queue=%d done\n",
 	       __LINE__, (unsigned long long) pthread_self (), q->id);
       delete q;
+      queue_done ();
     }
   for (int i = 0, sz = threads->size (); i < sz; i++)
     {
@@ -214,6 +238,27 @@ DbeThreadPool::wait_queues ()
     }
 }
 
+// Like wait_queues, but the threads are kept, and the pool can take new
+// requests afterwards.  Requests run by the pool must not wait for it
+// themselves.
+void
+DbeThreadPool::wait_idle ()
+{
+  for (;;) // Run requests on the calling thread too
+    {
+      DbeQueue *q = get_queue ();
+      if (q == NULL)
+	break;
+      q->func (q->arg);
+      delete q;
+      queue_done ();
+    }
+  pthread_mutex_lock (&p_mutex);
+  while (running_cnt > 0 || queue != NULL)
+    pthread_cond_wait (&p_done_var, &p_mutex);
+  pthread_mutex_unlock (&p_mutex);
+}
+
 DbeQueue::DbeQueue (int (*_func) (void *arg), void *_arg)
 {
   func = _func;
@@ -44,10 +44,14 @@ public:
   ~DbeThreadPool ();
   DbeQueue *get_queue ();
   void put_queue (DbeQueue *q);
+  void queue_done ();
+  void wait_for_queue ();
   void wait_queues ();
+  void wait_idle ();
 
   pthread_mutex_t p_mutex;
   pthread_cond_t p_cond_var;
+  pthread_cond_t p_done_var;
   volatile bool no_new_queues;
 private:
   Vector<pthread_t> *threads;
@@ -56,6 +60,7 @@ private:
   DbeQueue *volatile last_queue;
   volatile int queues_cnt;
   volatile int total_queues;
+  volatile int running_cnt;     // requests taken by get_queue and not done
 };
 
 #endif
@@ -255,6 +255,9 @@ void
 DbeView::init ()
 {
   phaseIdx = 0;
+  filterPhaseStart = -1;
+  filterPhaseEnd = -1;
+  filterNesting = 0;
   reg_metrics = new Vector<BaseMetric*>;
   metrics_lists = new Vector<MetricList*>;
   metrics_ref_lists = new Vector<MetricList*>;
@@ -824,8 +827,10 @@ DbeView::set_exp_enable (int n, bool e)
   if (fs->get_enabled () != e)
     {
       fs->set_enabled (e);
+      filter_change_start ();
       purge_events (n);
       phaseIdx++;
+      filter_change_end ();
     }
 }
 
@@ -1899,7 +1904,9 @@ DbeView::set_filter (const char *filter_spec)
 	  cur_filter_expr = NULL;
 	}
       noParFilter = false;
+      filter_change_start ();
       purge_events ();
+      filter_change_end ();
       reset_data (false);
       return NULL;
     }
@@ -1926,7 +1933,9 @@ DbeView::set_filter (const char *filter_spec)
   cur_filter_str = dbe_strdup (filter_spec);
   delete cur_filter_expr;
   cur_filter_expr = expr;
+  filter_change_start ();
   purge_events ();
+  filter_change_end ();
   reset_data (false);
   return NULL;
 }
@@ -1984,6 +1993,7 @@ DbeView::update_advanced_filter ()
   char *s = get_advanced_filter ();
   if (dbe_strcmp (s, cur_filter_str))
     {
+      filter_change_start ();
       phaseIdx++;
       char *err_msg = set_filter (s);
       if (err_msg)
@@ -1992,6 +2002,7 @@ DbeView::update_advanced_filter ()
 	  fprintf (stderr, NTXT ("ERROR: Advanced Filter: '%s'\n"), err_msg);
 #endif
 	}
+      filter_change_end ();
     }
   free (s);
 }
@@ -2173,6 +2184,7 @@ DbeView::set_pattern (int m, char *pattern)
 	  free (orig_pattern[i]);
 	}
       phaseIdx = orig_phaseIdx;
+      filterPhaseEnd = -1;
     }
   else
     {
@@ -2672,6 +2684,24 @@ DbeView::dump_gc_events (FILE *out_file)
     }
 }
 
+// Filter changes keep the set of call stacks seen by PathTree, which can
+// then update its metrics instead of rebuilding.  Other changes to
+// phaseIdx made between filter_change_start and filter_change_end are
+// attributed to the filter.
+void
+DbeView::filter_change_start ()
+{
+  if (filterNesting++ == 0 && filterPhaseEnd != phaseIdx)
+    filterPhaseStart = phaseIdx;
+}
+
+void
+DbeView::filter_change_end ()
+{
+  if (--filterNesting == 0)
+    filterPhaseEnd = phaseIdx;
+}
+
 void
 DbeView::purge_events (int n)
 {
@@ -685,6 +685,14 @@ public:
     return phaseIdx;
   }
 
+  // True if only the event filters have changed since phase IDX
+  bool
+  isFilterPhase (int idx)
+  {
+    return filterPhaseEnd == phaseIdx && idx >= filterPhaseStart
+	    && idx < phaseIdx;
+  }
+
   enum DbeView_status
   {
     DBEVIEW_SUCCESS = 0,
@@ -795,6 +803,8 @@ private:
   FilterSet *get_filter_set (int n);
 
   void purge_events (int n = -1);
+  void filter_change_start ();
+  void filter_change_end ();
 
   char *cur_filter_str;
   char *prev_filter_str;
@@ -819,6 +829,9 @@ private:
   IOActivity *iospace;
   HeapActivity *heapspace;
   int phaseIdx;
+  int filterPhaseStart;     // first phase of the current run of filter changes
+  int filterPhaseEnd;       // phase after the last filter change
+  int filterNesting;
   bool ompDisMode;
   bool filterHideMode;
   bool showAll;
@@ -28,6 +28,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/param.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <set>
 
 #include "util.h"
@@ -1324,7 +1326,8 @@ Experiment::Experiment ()
   hwc_lost_int = 0;
   hwc_scanned = 0;
   hwc_default = false;
-  invalid_packet = 0;
+  preloaded_data = 0;
+  cols_maps = NULL;
 
   // clear HWC event stats
   dsevents = 0;
@@ -1451,6 +1454,9 @@ Experiment::~Experiment ()
 
   dataDscrs->destroy ();
   delete dataDscrs;
+  for (long i = 0, sz = VecSize (cols_maps); i < sz; i++)
+    munmap (cols_maps->get (i)->addr, cols_maps->get (i)->len);
+  Destroy (cols_maps);
   pcktDscrs->destroy ();
   delete pcktDscrs;
   jthreads->destroy ();
@@ -1574,11 +1580,603 @@ Experiment::read_experiment_data (bool read_ahead)
 
   read_frameinfo_file ();
   if (read_ahead)
+    read_ahead_data ();
+}
+
+// Decode the packets of all event data files of the experiment.
+// Only per-experiment data is touched, so this can run in parallel
+// for multiple sub-experiments and concurrently with
+// read_frameinfo_file() for the same experiment.  Resolving the
+// frame info and the other post-processing is left to the
+// get_*_events() functions.
+void
+Experiment::read_ahead_data ()
+{
+  static const int data_ids[] = {
+    DATA_CLOCK, DATA_HWC, DATA_SYNCH, DATA_HEAP, DATA_IOTRACE,
+    DATA_RACE, DATA_DLCK
+  };
+  for (size_t i = 0; i < sizeof (data_ids) / sizeof (data_ids[0]); i++)
+    {
+      DataDescriptor *dDscr = getDataDescriptor (data_ids[i]);
+      if (dDscr == NULL || dDscr->getSize () > 0)
+	continue;
+      read_events_file (data_ids[i]);
+      preloaded_data |= 1u << data_ids[i];
+    }
+}
+
+// Read the event data file of DATA_ID, unless read_ahead_data()
+// has already done so.
+void
+Experiment::read_events_file (int data_id)
+{
+  if (is_preloaded (data_id))
+    {
+      preloaded_data &= ~(1u << data_id);
+      return;
+    }
+
+  const char *fname;
+  const char *fmt;
+  switch (data_id)
+    {
+    case DATA_CLOCK:
+      fname = SP_PROFILE_FILE;
+      fmt = GTXT ("Loading Profile Data: %s");
+      break;
+    case DATA_HWC:
+      fname = SP_HWCNTR_FILE;
+      fmt = GTXT ("Loading HW Profile Data: %s");
+      break;
+    case DATA_SYNCH:
+      fname = SP_SYNCTRACE_FILE;
+      fmt = GTXT ("Loading Synctrace Data: %s");
+      break;
+    case DATA_HEAP:
+      fname = SP_HEAPTRACE_FILE;
+      fmt = GTXT ("Loading Heap Trace Data: %s");
+      break;
+    case DATA_IOTRACE:
+      fname = SP_IOTRACE_FILE;
+      fmt = GTXT ("Loading IO Trace Data: %s");
+      break;
+    case DATA_RACE:
+      fname = SP_RACETRACE_FILE;
+      fmt = GTXT ("Loading Race Data: %s");
+      break;
+    case DATA_DLCK:
+      fname = SP_DEADLOCK_FILE;
+      fmt = GTXT ("Loading Deadlocks Data: %s");
+      break;
+    default:
+      return;
+    }
+  if (read_events_cache (fname))
+    return;
+
+  // Remember which data descriptors are empty, to find the ones
+  // this file fills in.
+  Vector<long> *sizes = new Vector<long>;
+  for (long i = 0, sz = VecSize (dataDscrs); i < sz; i++)
+    {
+      DataDescriptor *dDscr = dataDscrs->get (i);
+      sizes->append (dDscr != NULL ? dDscr->getSize () : -1);
+    }
+  char *msg = dbe_sprintf (fmt, get_basename (expt_name));
+  int invalid_packets = read_data_file (fname, msg);
+  free (msg);
+  write_events_cache (fname, sizes, invalid_packets);
+  delete sizes;
+}
+
+/*
+ * Column cache of the event data files
+ *
+ * The first time an event data file is decoded, the packet values are
+ * written to <experiment>/cache/<file>.cols, one array per property.
+ * Later opens map that file privately and use the arrays in place as
+ * the DataDescriptor columns, instead of decoding the packets again.
+ * Columns are copied only if they grow, and the pages of a column are
+ * copied only when its values are modified.
+ *
+ * THRID, LWPID and CPUID values are tags assigned by mapTagValue(),
+ * which depend on the order the files are read in.  The cache keeps
+ * the original value of each tag.  On load, these values are mapped
+ * again in the same order, and the columns are renumbered if the tags
+ * changed.
+ *
+ * The cache is rebuilt when the data file changes size or mtime.  It
+ * is not written if a data file fills non-numeric properties.  Set
+ * GPROFNG_DATA_CACHE=0 to neither read nor write it.
+ */
+
+#define COLS_MAGIC      "GPCOLS1"
+#define COLS_BYTE_ORDER 0x01020304
+
+struct Cols_header
+{
+  char magic[8];
+  uint32_t byte_order;
+  uint32_t ndscr;
+  int64_t src_size;
+  int64_t src_mtime;
+  int64_t invalid_packets;
+};
+
+struct Cols_dscr
+{
+  int32_t data_id;
+  int32_t ncols;
+  int64_t nrecs;
+  int32_t ntags;
+  int32_t pad;
+};
+
+struct Cols_column
+{
+  int32_t prop_id;
+  int32_t vtype;
+  int64_t len;
+  int64_t offset;
+};
+
+struct Cols_tag
+{
+  int32_t prop_id;
+  uint32_t tag;
+  uint64_t value;
+};
+
+static bool
+cols_enabled ()
+{
+  char *s = getenv ("GPROFNG_DATA_CACHE");
+  return s == NULL || atoi (s) != 0;
+}
+
+static int
+cols_width (int vtype)
+{
+  switch (vtype)
+    {
+    case TYPE_INT32:
+    case TYPE_UINT32:
+      return 4;
+    case TYPE_INT64:
+    case TYPE_UINT64:
+    case TYPE_DOUBLE:
+      return 8;
+    default:
+      return 0;
+    }
+}
+
+static bool
+is_tag_prop (int prop_id)
+{
+  return prop_id == PROP_THRID || prop_id == PROP_LWPID
+	  || prop_id == PROP_CPUID;
+}
+
+static int
+cols_tag_cmp (const void *a, const void *b)
+{
+  const Cols_tag *t1 = *((const Cols_tag **) a);
+  const Cols_tag *t2 = *((const Cols_tag **) b);
+  if (t1->prop_id != t2->prop_id)
+    return t1->prop_id < t2->prop_id ? -1 : 1;
+  return t1->tag < t2->tag ? -1 : t1->tag > t2->tag ? 1 : 0;
+}
+
+static bool
+cols_write (int fd, const void *buf, size_t len)
+{
+  const char *p = (const char *) buf;
+  while (len > 0)
+    {
+      ssize_t n = write (fd, p, len);
+      if (n <= 0)
+	return false;
+      p += n;
+      len -= n;
+    }
+  return true;
+}
+
+// Write the cache of data file FNAME.  SIZES are the sizes of the
+// data descriptors before the file was read.
+void
+Experiment::write_events_cache (const char *fname, Vector<long> *sizes,
+				int invalid_packets)
+{
+  if (!cols_enabled ())
+    return;
+  char *data_file_name = dbe_sprintf (NTXT ("%s/%s"), expt_name, fname);
+  dbe_stat_t sbuf;
+  int st = dbe_stat_file (data_file_name, &sbuf);
+  free (data_file_name);
+  if (st != 0)
+    return;
+
+  Vector<DataDescriptor*> *dscrs = new Vector<DataDescriptor*>;
+  for (long i = 0, sz = VecSize (dataDscrs); i < sz; i++)
+    {
+      DataDescriptor *dDscr = dataDscrs->get (i);
+      if (dDscr == NULL || i >= sizes->size ()
+	  || dDscr->getSize () == sizes->get (i))
+	continue;
+      if (sizes->get (i) != 0)
+	{
+	  // Appended to data read before; can't be cached on its own
+	  delete dscrs;
+	  return;
+	}
+      dscrs->append (dDscr);
+    }
+
+  // Lay out the headers, the original tag values and the columns
+  Vector<Vector<Cols_tag*>*> *tags = new Vector<Vector<Cols_tag*>*>;
+  int64_t offset = sizeof (Cols_header);
+  bool ok = dscrs->size () > 0;
+  for (long i = 0, sz = dscrs->size (); ok && i < sz; i++)
+    {
+      DataDescriptor *dDscr = dscrs->get (i);
+      Vector<PropDescr*> *props = dDscr->getProps ();
+      Vector<Cols_tag*> *dtags = new Vector<Cols_tag*>;
+      tags->append (dtags);
+      for (long j = 0, psz = props->size (); j < psz; j++)
+	{
+	  PropDescr *prop = props->get (j);
+	  Data *d = dDscr->getData (prop->propID);
+	  long len = d != NULL ? d->getSize () : 0;
+	  if (len > 0 && cols_width (prop->vtype) == 0)
+	    {
+	      ok = false;
+	      break;
+	    }
+	  if (len == 0 || !is_tag_prop (prop->propID))
+	    continue;
+
+	  // The values of the tags, in the order they first appear
+	  Vector<Cols_tag*> *known = new Vector<Cols_tag*>;
+	  Vector<Histable*> *objs = tagObjs->get (prop->propID);
+	  for (long k = 0, osz = VecSize (objs); k < osz; k++)
+	    {
+	      Other *obj = (Other *) objs->get (k);
+	      Cols_tag *t = new Cols_tag;
+	      t->prop_id = prop->propID;
+	      t->tag = obj->tag;
+	      t->value = obj->value64;
+	      known->append (t);
+	    }
+	  known->sort (cols_tag_cmp);
+	  Vector<uint32_t> *seen = new Vector<uint32_t>;
+	  for (long k = 0; k < len; k++)
+	    {
+	      uint32_t tag = (uint32_t) d->fetchULong (k);
+	      long lt = 0, rt = seen->size () - 1;
+	      while (lt <= rt)
+		{
+		  long md = (lt + rt) / 2;
+		  if (seen->get (md) < tag)
+		    lt = md + 1;
+		  else
+		    rt = md - 1;
+		}
+	      if (lt < seen->size () && seen->get (lt) == tag)
+		continue;
+	      seen->insert (lt, tag);
+	      for (long n = 0, ksz = known->size (); n < ksz; n++)
+		if (known->get (n)->tag == tag)
+		  dtags->append (new Cols_tag (*known->get (n)));
+	    }
+	  delete seen;
+	  known->destroy ();
+	  delete known;
+	}
+      offset += sizeof (Cols_dscr) + props->size () * sizeof (Cols_column)
+	      + dtags->size () * sizeof (Cols_tag);
+    }
+
+  char *dir = dbe_sprintf (NTXT ("%s/cache"), expt_name);
+  char *tmp_name = dbe_sprintf (NTXT ("%s/%s.cols.%d"), dir, fname,
+				(int) getpid ());
+  int fd = -1;
+  if (ok)
+    {
+      mkdir (dir, 0755);
+      fd = ::open (tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      ok = fd >= 0;
+    }
+
+  if (ok)
+    {
+      Cols_header hdr;
+      memset (&hdr, 0, sizeof (hdr));
+      memcpy (hdr.magic, COLS_MAGIC, sizeof (hdr.magic));
+      hdr.byte_order = COLS_BYTE_ORDER;
+      hdr.ndscr = (uint32_t) dscrs->size ();
+      hdr.src_size = (int64_t) sbuf.st_size;
+      hdr.src_mtime = (int64_t) sbuf.st_mtime;
+      hdr.invalid_packets = invalid_packets;
+      ok = cols_write (fd, &hdr, sizeof (hdr));
+    }
+  offset = (offset + 7) & ~(int64_t) 7;
+  int64_t data_start = offset;
+  for (long i = 0, sz = dscrs->size (); ok && i < sz; i++)
+    {
+      DataDescriptor *dDscr = dscrs->get (i);
+      Vector<PropDescr*> *props = dDscr->getProps ();
+      Cols_dscr cd;
+      memset (&cd, 0, sizeof (cd));
+      cd.data_id = dDscr->getId ();
+      cd.ncols = (int32_t) props->size ();
+      cd.nrecs = dDscr->getSize ();
+      cd.ntags = (int32_t) tags->get (i)->size ();
+      ok = cols_write (fd, &cd, sizeof (cd));
+      for (long j = 0, psz = props->size (); ok && j < psz; j++)
+	{
+	  PropDescr *prop = props->get (j);
+	  Data *d = dDscr->getData (prop->propID);
+	  Cols_column col;
+	  memset (&col, 0, sizeof (col));
+	  col.prop_id = prop->propID;
+	  col.vtype = prop->vtype;
+	  col.len = d != NULL ? d->getSize () : 0;
+	  col.offset = col.len > 0 ? offset : 0;
+	  offset += (col.len * cols_width (prop->vtype) + 7) & ~(int64_t) 7;
+	  ok = cols_write (fd, &col, sizeof (col));
+	}
+      for (int j = 0; ok && j < cd.ntags; j++)
+	ok = cols_write (fd, tags->get (i)->get (j), sizeof (Cols_tag));
+    }
+
+  // The columns
+  if (ok && lseek (fd, data_start, SEEK_SET) != data_start)
+    ok = false;
+  for (long i = 0, sz = dscrs->size (); ok && i < sz; i++)
+    {
+      DataDescriptor *dDscr = dscrs->get (i);
+      Vector<PropDescr*> *props = dDscr->getProps ();
+      for (long j = 0, psz = props->size (); ok && j < psz; j++)
+	{
+	  PropDescr *prop = props->get (j);
+	  Data *d = dDscr->getData (prop->propID);
+	  long len = d != NULL ? d->getSize () : 0;
+	  if (len == 0)
+	    continue;
+	  int width = cols_width (prop->vtype);
+	  size_t bytes = (len * width + 7) & ~(int64_t) 7;
+	  char *buf = (char *) xcalloc (bytes, 1);
+	  for (long k = 0; k < len; k++)
+	    switch (prop->vtype)
+	      {
+	      case TYPE_INT32:
+		((int32_t *) buf)[k] = d->fetchInt (k);
+		break;
+	      case TYPE_UINT32:
+		((uint32_t *) buf)[k] = (uint32_t) d->fetchULong (k);
+		break;
+	      case TYPE_INT64:
+		((int64_t *) buf)[k] = d->fetchLong (k);
+		break;
+	      case TYPE_UINT64:
+		((uint64_t *) buf)[k] = d->fetchULong (k);
+		break;
+	      case TYPE_DOUBLE:
+		((double *) buf)[k] = d->fetchDouble (k);
+		break;
+	      default:
+		break;
+	      }
+	  ok = cols_write (fd, buf, bytes);
+	  free (buf);
+	}
+    }
+
+  if (fd >= 0)
+    {
+      if (close (fd) != 0)
+	ok = false;
+      if (ok)
+	{
+	  char *cols_name = dbe_sprintf (NTXT ("%s/%s.cols"), dir, fname);
+	  if (rename (tmp_name, cols_name) != 0)
+	    unlink (tmp_name);
+	  free (cols_name);
+	}
+      else
+	unlink (tmp_name);
+    }
+  free (tmp_name);
+  free (dir);
+  for (long i = 0, sz = tags->size (); i < sz; i++)
     {
-      resolveFrameInfo = false;
-      (void) get_profile_events ();
-      resolveFrameInfo = true;
+      tags->get (i)->destroy ();
+      delete tags->get (i);
     }
+  delete tags;
+  delete dscrs;
+}
+
+// Fill in the data descriptors of data file FNAME from its cache.
+// Returns false if there is no valid cache.
+bool
+Experiment::read_events_cache (const char *fname)
+{
+  if (!cols_enabled ())
+    return false;
+  char *data_file_name = dbe_sprintf (NTXT ("%s/%s"), expt_name, fname);
+  dbe_stat_t sbuf;
+  int st = dbe_stat_file (data_file_name, &sbuf);
+  free (data_file_name);
+  if (st != 0)
+    return false;
+
+  char *cols_name = dbe_sprintf (NTXT ("%s/cache/%s.cols"), expt_name, fname);
+  int fd = ::open (cols_name, O_RDONLY);
+  free (cols_name);
+  if (fd < 0)
+    return false;
+  struct stat cbuf;
+  void *addr = MAP_FAILED;
+  size_t len = 0;
+  if (fstat (fd, &cbuf) == 0 && cbuf.st_size >= (off_t) sizeof (Cols_header))
+    {
+      len = (size_t) cbuf.st_size;
+      addr = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+  close (fd);
+  if (addr == MAP_FAILED)
+    return false;
+
+  // Validate everything before touching any data descriptor
+  char *base = (char *) addr;
+  Cols_header *hdr = (Cols_header *) base;
+  bool ok = memcmp (hdr->magic, COLS_MAGIC, sizeof (hdr->magic)) == 0
+	  && hdr->byte_order == COLS_BYTE_ORDER
+	  && hdr->src_size == (int64_t) sbuf.st_size
+	  && hdr->src_mtime == (int64_t) sbuf.st_mtime;
+  size_t pos = sizeof (Cols_header);
+  bool seen[DATA_LAST] = { false };
+  for (uint32_t i = 0; ok && i < hdr->ndscr; i++)
+    {
+      if (pos + sizeof (Cols_dscr) > len)
+	{
+	  ok = false;
+	  break;
+	}
+      Cols_dscr *cd = (Cols_dscr *) (base + pos);
+      pos += sizeof (Cols_dscr);
+      // Each data descriptor is filled in from one entry only
+      if (cd->data_id < 0 || cd->data_id >= DATA_LAST || seen[cd->data_id])
+	{
+	  ok = false;
+	  break;
+	}
+      seen[cd->data_id] = true;
+      DataDescriptor *dDscr = getDataDescriptor (cd->data_id);
+      if (dDscr == NULL || dDscr->getSize () != 0 || cd->nrecs < 0
+	  || cd->ncols != dDscr->getProps ()->size ()
+	  || cd->ntags < 0
+	  || pos + cd->ncols * sizeof (Cols_column)
+	     + cd->ntags * sizeof (Cols_tag) > len)
+	{
+	  ok = false;
+	  break;
+	}
+      Cols_column *cols = (Cols_column *) (base + pos);
+      int64_t tag_values = 0;
+      for (int j = 0; ok && j < cd->ncols; j++)
+	{
+	  PropDescr *prop = dDscr->getProps ()->get (j);
+	  int width = cols_width (cols[j].vtype);
+	  if (cols[j].prop_id != prop->propID || cols[j].vtype != prop->vtype
+	      || cols[j].len < 0 || cols[j].len > cd->nrecs
+	      || (cols[j].len > 0
+		  && (width == 0 || cols[j].offset % 8 != 0
+		      || cols[j].offset < 0
+		      || (uint64_t) cols[j].offset + cols[j].len * width > len)))
+	    ok = false;
+	  else if (is_tag_prop (cols[j].prop_id))
+	    tag_values += cols[j].len;
+	}
+      pos += cd->ncols * sizeof (Cols_column);
+
+      // Each tag was written for a distinct value of a tag column, and
+      // its property is handed to mapTagValue() below.
+      Cols_tag *tags = (Cols_tag *) (base + pos);
+      if (cd->ntags > tag_values)
+	ok = false;
+      for (int j = 0; ok && j < cd->ntags; j++)
+	if (!is_tag_prop (tags[j].prop_id))
+	  ok = false;
+
+      // The tags are looked up by property and tag below, so no two
+      // may have the same ones.
+      if (ok && cd->ntags > 1)
+	{
+	  Vector<Cols_tag*> *sorted = new Vector<Cols_tag*> (cd->ntags);
+	  for (int j = 0; j < cd->ntags; j++)
+	    sorted->append (tags + j);
+	  sorted->sort (cols_tag_cmp);
+	  for (long j = 1, sz = sorted->size (); ok && j < sz; j++)
+	    {
+	      Cols_tag *t1 = sorted->get (j - 1);
+	      Cols_tag *t2 = sorted->get (j);
+	      if (cols_tag_cmp (&t1, &t2) == 0)
+		ok = false;
+	    }
+	  delete sorted;
+	}
+      pos += cd->ntags * sizeof (Cols_tag);
+    }
+  if (!ok)
+    {
+      munmap (addr, len);
+      return false;
+    }
+
+  pos = sizeof (Cols_header);
+  for (uint32_t i = 0; i < hdr->ndscr; i++)
+    {
+      Cols_dscr *cd = (Cols_dscr *) (base + pos);
+      pos += sizeof (Cols_dscr);
+      DataDescriptor *dDscr = getDataDescriptor (cd->data_id);
+      Cols_column *cols = (Cols_column *) (base + pos);
+      pos += cd->ncols * sizeof (Cols_column);
+      Cols_tag *tags = (Cols_tag *) (base + pos);
+      pos += cd->ntags * sizeof (Cols_tag);
+
+      // Assign the tags in the order the packets would have.
+      // RENAMED maps the cached tags that changed to the new ones.
+      Vector<Cols_tag*> *renamed = new Vector<Cols_tag*>;
+      for (int j = 0; j < cd->ntags; j++)
+	{
+	  uint32_t tag = mapTagValue ((Prop_type) tags[j].prop_id,
+				      tags[j].value);
+	  if (tag != tags[j].tag)
+	    {
+	      Cols_tag *t = new Cols_tag (tags[j]);
+	      t->value = tag;
+	      renamed->append (t);
+	    }
+	}
+      renamed->sort (cols_tag_cmp);
+
+      for (int j = 0; j < cd->ncols; j++)
+	{
+	  if (cols[j].len == 0)
+	    continue;
+	  Data *d = Data::newData ((VType_type) cols[j].vtype,
+				   base + cols[j].offset, cols[j].len);
+	  if (renamed->size () > 0 && is_tag_prop (cols[j].prop_id))
+	    for (long k = 0; k < cols[j].len; k++)
+	      {
+		Cols_tag key;
+		key.prop_id = cols[j].prop_id;
+		key.tag = (uint32_t) d->fetchULong (k);
+		Cols_tag *kp = &key;
+		long n = renamed->bisearch (0, -1, &kp, cols_tag_cmp);
+		if (n >= 0)
+		  d->setValue (k, renamed->get (n)->value);
+	      }
+	  dDscr->setData (cols[j].prop_id, d);
+	}
+      dDscr->addRecords (cd->nrecs);
+      renamed->destroy ();
+      delete renamed;
+    }
+
+  Cols_map *m = new Cols_map;
+  m->addr = addr;
+  m->len = len;
+  if (cols_maps == NULL)
+    cols_maps = new Vector<Cols_map*>;
+  cols_maps->append (m);
+  warn_invalid_packets (fname, (int) hdr->invalid_packets);
+  return true;
 }
 
 Experiment::Exp_status
@@ -3072,12 +3670,9 @@ Experiment::get_profile_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_CLOCK);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () == 0)
+  if (dDscr->getSize () == 0 || is_preloaded (DATA_CLOCK))
     {
-      char *base_name = get_basename (expt_name);
-      char *msg = dbe_sprintf (GTXT ("Loading Profile Data: %s"), base_name);
-      read_data_file (SP_PROFILE_FILE, msg);
-      free (msg);
+      read_events_file (DATA_CLOCK);
       add_evt_time_to_profile_events (dDscr);
       resolve_frame_info (dDscr);
     }
@@ -3143,17 +3738,12 @@ Experiment::get_sync_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_SYNCH);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () > 0)
+  if (dDscr->getSize () > 0 && !is_preloaded (DATA_SYNCH))
     return dDscr;
 
   // fetch data
-  {
-    char *base_name = get_basename (expt_name);
-    char *msg = dbe_sprintf (GTXT ("Loading Synctrace Data: %s"), base_name);
-    read_data_file (SP_SYNCTRACE_FILE, msg);
-    free (msg);
-    resolve_frame_info (dDscr);
-  }
+  read_events_file (DATA_SYNCH);
+  resolve_frame_info (dDscr);
 
   // check for PROP_EVT_TIME
   PropDescr *tmp_propDscr = dDscr->getProp (PROP_EVT_TIME);
@@ -3182,16 +3772,14 @@ Experiment::get_hwc_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_HWC);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () == 0)
+  if (dDscr->getSize () == 0 || is_preloaded (DATA_HWC))
     {
       char *base_name = get_basename (expt_name);
-      char *msg = dbe_sprintf (GTXT ("Loading HW Profile Data: %s"), base_name);
 
       // clear HWC event stats
       dsevents = 0;
       dsnoxhwcevents = 0;
-      read_data_file (SP_HWCNTR_FILE, msg);
-      free (msg);
+      read_events_file (DATA_HWC);
       resolve_frame_info (dDscr);
 
       // describe the HW counters in PropDescr
@@ -3264,13 +3852,10 @@ Experiment::get_iotrace_events ()
   if (dDscr == NULL)
     return NULL;
 
-  if (dDscr->getSize () > 0)
+  if (dDscr->getSize () > 0 && !is_preloaded (DATA_IOTRACE))
     return dDscr;
 
-  char *base_name = get_basename (expt_name);
-  char *msg = dbe_sprintf (GTXT ("Loading IO Trace Data: %s"), base_name);
-  read_data_file (SP_IOTRACE_FILE, msg);
-  free (msg);
+  read_events_file (DATA_IOTRACE);
 
   if (dDscr->getSize () == 0)
     return dDscr;
@@ -3572,13 +4157,10 @@ Experiment::get_heap_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_HEAP);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () > 0)
+  if (dDscr->getSize () > 0 && !is_preloaded (DATA_HEAP))
     return dDscr;
 
-  char *base_name = get_basename (expt_name);
-  char *msg = dbe_sprintf (GTXT ("Loading Heap Trace Data: %s"), base_name);
-  read_data_file (SP_HEAPTRACE_FILE, msg);
-  free (msg);
+  read_events_file (DATA_HEAP);
 
   if (dDscr->getSize () == 0)
     return dDscr;
@@ -3993,12 +4575,9 @@ Experiment::get_race_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_RACE);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () == 0)
+  if (dDscr->getSize () == 0 || is_preloaded (DATA_RACE))
     {
-      char *base_name = get_basename (expt_name);
-      char *msg = dbe_sprintf (GTXT ("Loading Race Data: %s"), base_name);
-      read_data_file (SP_RACETRACE_FILE, msg);
-      free (msg);
+      read_events_file (DATA_RACE);
       resolve_frame_info (dDscr);
     }
   return dDscr;
@@ -4010,12 +4589,9 @@ Experiment::get_deadlock_events ()
   DataDescriptor *dDscr = getDataDescriptor (DATA_DLCK);
   if (dDscr == NULL)
     return NULL;
-  if (dDscr->getSize () == 0)
+  if (dDscr->getSize () == 0 || is_preloaded (DATA_DLCK))
     {
-      char *base_name = get_basename (expt_name);
-      char *msg = dbe_sprintf (GTXT ("Loading Deadlocks Data: %s"), base_name);
-      read_data_file (SP_DEADLOCK_FILE, msg);
-      free (msg);
+      read_events_file (DATA_DLCK);
       resolve_frame_info (dDscr);
     }
   return dDscr;
@@ -4455,7 +5031,8 @@ check_mstate (char *ptr, PacketDescriptor *pDscr, int arg)
 #define PACKET_ALIGNMENT 4
 
 uint64_t
-Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
+Experiment::readPacket (Data_window *dwin, Data_window::Span *span,
+			int *invalid_packet)
 {
   Common_packet *rcp = (Common_packet *) dwin->bind (span,
 						    sizeof (CommonHead_packet));
@@ -4465,7 +5042,7 @@ Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
     {
       if ((((long) rcp) % PACKET_ALIGNMENT) != 0)
 	{
-	  invalid_packet++;
+	  (*invalid_packet)++;
 	  size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
 	  return size;
 	}
@@ -4483,7 +5060,7 @@ Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
 
   if ((((long) rcp) % PACKET_ALIGNMENT) != 0)
     {
-      invalid_packet++;
+      (*invalid_packet)++;
       size = PROFILE_BUFFER_CHUNK - span->offset % PROFILE_BUFFER_CHUNK;
       return size;
     }
@@ -4502,7 +5079,7 @@ Experiment::readPacket (Data_window *dwin, Data_window::Span *span)
       char *ptr = (char*) rcp + dwin->decode (((Frame_packet*) rcp)->hsize);
       if ((((long) ptr) % PACKET_ALIGNMENT) != 0)
 	{
-	  invalid_packet++;
+	  (*invalid_packet)++;
 	  delete fp;
 	  return size;
 	}
@@ -4785,7 +5362,7 @@ Experiment::readPacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
 
 #define PROG_BYTE 102400 // update progress bar every PROG_BYTE bytes
 
-void
+int
 Experiment::read_data_file (const char *fname, const char *msg)
 {
   Data_window::Span span;
@@ -4801,7 +5378,7 @@ Experiment::read_data_file (const char *fname, const char *msg)
   if (dwin->not_opened ())
     {
       delete dwin;
-      return;
+      return 0;
     }
   dwin->need_swap_endian = need_swap_endian;
 
@@ -4809,10 +5386,10 @@ Experiment::read_data_file (const char *fname, const char *msg)
   span.length = dwin->get_fsize ();
   total_len = remain_len = span.length;
   progress_bar_msg = dbe_sprintf (NTXT ("%s %s"), NTXT ("  "), msg);
-  invalid_packet = 0;
+  int invalid_packet = 0;
   for (;;)
     {
-      uint64_t pcktsz = readPacket (dwin, &span);
+      uint64_t pcktsz = readPacket (dwin, &span, &invalid_packet);
       if (pcktsz == 0)
 	break;
       // Update progress bar
@@ -4831,17 +5408,28 @@ Experiment::read_data_file (const char *fname, const char *msg)
     }
   delete dwin;
 
+  warn_invalid_packets (fname, invalid_packet);
+
+  theApplication->set_progress (0, NTXT (""));
+  free (progress_bar_msg);
+  return invalid_packet;
+}
+
+void
+Experiment::warn_invalid_packets (const char *fname, int invalid_packet)
+{
   if (invalid_packet)
     {
       StringBuilder sb;
       sb.sprintf (GTXT ("WARNING: There are %d invalid packet(s) in the %s file"),
 		  invalid_packet, fname);
       Emsg *m = new Emsg (CMSG_WARN, sb);
+      // The frame info and the event data files may be read concurrently
+      static pthread_mutex_t warnq_lock = PTHREAD_MUTEX_INITIALIZER;
+      pthread_mutex_lock (&warnq_lock);
       warnq->append (m);
+      pthread_mutex_unlock (&warnq_lock);
     }
-
-  theApplication->set_progress (0, NTXT (""));
-  free (progress_bar_msg);
 }
 
 int
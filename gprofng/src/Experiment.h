@@ -139,7 +139,6 @@ public:
   int hwc_bogus;        // Count of bogus HWC packets
   int hwc_lost_int;     // Count of packets reflecting lost interrupt
   int hwc_scanned;      // If the HWC packets have been scanned
-  int invalid_packet;   // Count of invalid packets
   bool exec_started;    // True if exec was called, and exec error not yet seen
   bool dataspaceavail;  // True if dataspace data is in the experiment
   bool leaklistavail;   // True if leaklist data is in the experiment
@@ -263,6 +262,7 @@ public:
 
   Exp_status open_epilogue ();
   void read_experiment_data (bool read_ahead);
+  void read_ahead_data ();
   static int copy_file_to_archive (const char *name, const char *aname, int hide_msg);
   static int copy_file_to_common_archive (const char *name, const char *aname,
 	       int hide_msg, const char *common_archive, int relative_path = 0);
@@ -446,7 +446,8 @@ protected:
   Exp_status find_expdir (char *directory_name);
 
   // Invoke the parser to process a file.
-  void read_data_file (const char*, const char*);
+  int read_data_file (const char*, const char*);
+  void warn_invalid_packets (const char *fname, int invalid_packet);
   int read_log_file ();
   void read_labels_file ();
   void read_notes_file ();
@@ -500,11 +501,22 @@ protected:
   class ExperimentHandler;
   class ExperimentLabelsHandler;
 
-  uint64_t readPacket (Data_window *dwin, Data_window::Span *span);
+  uint64_t readPacket (Data_window *dwin, Data_window::Span *span,
+		       int *invalid_packet);
   void readPacket (Data_window *dwin, char *ptr, PacketDescriptor *pDscr,
 		   DataDescriptor *dDscr, int arg, uint64_t pktsz);
 
   // read data
+  void read_events_file (int data_id);
+  bool read_events_cache (const char *fname);
+  void write_events_cache (const char *fname, Vector<long> *sizes,
+			   int invalid_packets);
+  bool
+  is_preloaded (int data_id)
+  {
+    return (preloaded_data & (1u << data_id)) != 0;
+  }
+
   DataDescriptor *get_profile_events ();
   DataDescriptor *get_sync_events ();
   DataDescriptor *get_hwc_events ();
@@ -534,6 +546,13 @@ protected:
   UIDnode **uidHTable;
   Vector<UIDnode*> *uidnodes;
   bool resolveFrameInfo;
+  unsigned int preloaded_data; // DATA_* files decoded by read_ahead_data()
+  struct Cols_map
+  {
+    void *addr;
+    size_t len;
+  };
+  Vector<Cols_map*> *cols_maps; // mapped column caches of event data files
   bool discardTiny;
   int tiny_threshold; /* optimize away tiny experiments which ran
 		       * for less than specified time (ms): default 0 */
@@ -1259,6 +1259,42 @@ Expression::verifyObjectInExpr (Histable *obj)
   return false;
 }
 
+bool
+Expression::readsObjects ()
+{
+  if (op == OP_NAME && arg0 && arg0->op == OP_NUM)
+    switch (arg0->v.val)
+      {
+      case PROP_SAMPLE_MAP:
+      case PROP_GCEVENT_MAP:
+      case PROP_LEAF:
+      case PROP_STACKL:
+      case PROP_STACKI:
+      case PROP_STACK:
+      case PROP_MSTACKL:
+      case PROP_XSTACKL:
+      case PROP_USTACKL:
+      case PROP_MSTACKI:
+      case PROP_XSTACKI:
+      case PROP_USTACKI:
+      case PROP_MSTACK:
+      case PROP_XSTACK:
+      case PROP_USTACK:
+      case PROP_DOBJ:
+      case PROP_CPRID:
+      case PROP_TSKID:
+      case PROP_JTHREAD:
+	return true;
+      default:
+	break;
+      }
+  if (arg0 && arg0->readsObjects ())
+    return true;
+  if (arg1 && arg1->readsObjects ())
+    return true;
+  return false;
+}
+
 bool
 Expression::hasLoadObject ()
 {
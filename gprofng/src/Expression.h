@@ -147,6 +147,11 @@ public:
   };
 
   bool verifyObjectInExpr (Histable *obj);
+
+  // True if eval() may look up or create shared objects (functions, lines,
+  // data objects, samples ...) rather than only read the event and its
+  // experiment.
+  bool readsObjects ();
   Expression *
   pEval (Context *ctx); // Partial evaluation to simplify expression
 
@@ -29,6 +29,7 @@
 #include "DbeSession.h"
 #include "Application.h"
 #include "CallStack.h"
+#include "DbeThread.h"
 #include "Emsg.h"
 #include "Experiment.h"
 #include "Expression.h"
@@ -85,6 +86,8 @@ PathTree::construct (DbeView *_dbev, int _indxtype, PathTreeType _pathTreeType)
   ftree_internal = NULL;
   ftree_needs_update = false;
   depth_map = NULL;
+  refilter_map = NULL;
+  refilter_nodes = 0;
   init ();
 }
 
@@ -174,6 +177,8 @@ PathTree::fini ()
   pathMap = NULL;
   destroy (depth_map);
   depth_map = NULL;
+  delete refilter_map;
+  refilter_map = NULL;
   if (indxtype >= 0)
     delete total_obj;
 
@@ -209,8 +214,15 @@ PathTree::reset ()
 
   if (phaseIdx != dbev->getPhaseIdx ())
     {
-      fini ();
-      init ();
+      // A filter change leaves the call stacks alone, so the existing
+      // nodes can be reused for the new set of packets.
+      if (indx_expr == NULL && nexps > 0 && dbev->isFilterPhase (phaseIdx))
+	refilter_start ();
+      else
+	{
+	  fini ();
+	  init ();
+	}
       phaseIdx = dbev->getPhaseIdx ();
       ftree_needs_update = true;
     }
@@ -218,8 +230,18 @@ PathTree::reset ()
     {
       ftree_needs_update = true;
       if (add_experiment (nexps) == CANCELED)
-	return CANCELED;
+	{
+	  if (refilter_map)
+	    {
+	      // Half of the metrics are gone; rebuild next time.
+	      fini ();
+	      init ();
+	    }
+	  return CANCELED;
+	}
     }
+  if (refilter_map)
+    refilter_finish ();
 
   // LIBRARY_VISIBILITY
   if (dbev->isNewViewMode ())
@@ -229,6 +251,142 @@ PathTree::reset ()
   return NORMAL;
 }
 
+// Recompute the metrics after a filter change without rebuilding the
+// tree.  The metrics are dropped but the nodes are kept, so most packets
+// find their path in pathMap.  refilter_mark numbers the nodes in the
+// order a fresh build would have created them, and refilter_finish
+// renumbers the tree in that order and drops the nodes no packet reached.
+// The result is the tree a rebuild would have produced.
+void
+PathTree::refilter_start ()
+{
+  for (int i = 0; i < nslots; i++)
+    {
+      int **tmp = slots[i].mvals;
+      for (long j = 0; j < nchunks; j++)
+	delete[] tmp[j];
+      delete[] tmp;
+    }
+  delete[] slots;
+  slots = NULL;
+  nslots = 0;
+  delete statsq;
+  delete warningq;
+  statsq = new Emsgqueue (NTXT ("statsq"));
+  warningq = new Emsgqueue (NTXT ("warningq"));
+  refilter_map = new Vector<NodeIdx> (nodes);
+  refilter_map->store (root_idx, root_idx);
+  refilter_nodes = root_idx + 1;
+  nexps = 0;
+  status = 0;
+}
+
+void
+PathTree::refilter_mark (NodeIdx node_idx)
+{
+  if (node_idx < refilter_map->size () && refilter_map->get (node_idx) != 0)
+    return;
+  refilter_mark (NODE_IDX (node_idx)->ancestor);
+  refilter_map->store (node_idx, refilter_nodes++);
+}
+
+static PathTree::NodeIdx
+refilter_node_idx (PathTree::NodeIdx node_idx, void *arg)
+{
+  Vector<PathTree::NodeIdx> *map = (Vector<PathTree::NodeIdx> *) arg;
+  return node_idx < map->size () ? map->get (node_idx) : 0;
+}
+
+void
+PathTree::refilter_finish ()
+{
+  long map_sz = refilter_map->size ();
+  long new_nodes = refilter_nodes;
+  long new_nchunks = (new_nodes + CHUNKSZ - 1) / CHUNKSZ;
+
+  // Move the metric values
+  for (int i = 0; i < nslots; i++)
+    {
+      Slot *slot = slots + i;
+      Slot new_slot = *slot;
+      new_slot.mvals = new int*[new_nchunks];
+      for (long k = 0; k < new_nchunks; k++)
+	new_slot.mvals[k] = NULL;
+      for (long j = 1; j < map_sz; j++)
+	{
+	  NodeIdx new_idx = refilter_map->get (j);
+	  if (new_idx == 0 || IS_MVAL_ZERO (*slot, j))
+	    continue;
+	  TValue val;
+	  val.ll = 0;
+	  ASN_METRIC_VAL (val, *slot, j);
+	  INCREMENT_METRIC (&new_slot, new_idx,
+			    slot->vtype == VT_INT ? val.i : val.ll);
+	}
+      for (long k = 0; k < nchunks; k++)
+	delete[] slot->mvals[k];
+      delete[] slot->mvals;
+      slot->mvals = new_slot.mvals;
+    }
+
+  // Move the nodes
+  Node **new_chunks = new Node*[new_nchunks];
+  for (long k = 0; k < new_nchunks; k++)
+    allocate_chunk (new_chunks, k);
+  for (long j = 1; j < nodes; j++)
+    {
+      Node *node = NODE_IDX (j);
+      NodeIdx new_idx = j < map_sz ? refilter_map->get (j) : 0;
+      if (new_idx == 0)
+	{
+	  delete node->descendants;
+	  continue;
+	}
+      Node *new_node = &new_chunks[new_idx / CHUNKSZ][new_idx % CHUNKSZ];
+      new_node->ancestor = refilter_map->get (node->ancestor);
+      new_node->instr = node->instr;
+      if (node->descendants)
+	{
+	  // Descendants stay sorted by Histable::id
+	  new_node->descendants = new Vector<NodeIdx>(2);
+	  for (long k = 0, sz = node->descendants->size (); k < sz; k++)
+	    {
+	      NodeIdx dsc_idx = node->descendants->get (k);
+	      if (dsc_idx < map_sz && refilter_map->get (dsc_idx) != 0)
+		new_node->descendants->append (refilter_map->get (dsc_idx));
+	    }
+	  delete node->descendants;
+	}
+    }
+  for (long k = 0; k < nchunks; k++)
+    delete[] chunks[k];
+  delete[] chunks;
+  chunks = new_chunks;
+  nchunks = new_nchunks;
+  nodes = new_nodes;
+  root = NODE_IDX (root_idx);
+
+  // Rebuild the function lists and the depth in the new order
+  delete fn_map;
+  fn_map = new DefaultMap<Function*, NodeIdx>;
+  int *levels = new int[nodes];
+  depth = 1;
+  for (long j = root_idx; j < nodes; j++)
+    {
+      Node *node = NODE_IDX (j);
+      Function *func = (Function*) (node->instr->convertto (Histable::FUNCTION));
+      node->funclist = fn_map->get (func);
+      fn_map->put (func, j);
+      levels[j] = node->ancestor ? levels[node->ancestor] + 1 : 0;
+      if (levels[j] + 1 > depth)
+	depth = levels[j] + 1;
+    }
+  delete[] levels;
+  pathMap->update_values (refilter_node_idx, refilter_map);
+  delete refilter_map;
+  refilter_map = NULL;
+}
+
 int
 PathTree::allocate_slot (int id, ValueTag vtype)
 {
@@ -535,6 +693,107 @@ PathTree::find_desc_node (NodeIdx node_idx, Histable *instr, bool leaf)
   return dsc_idx;
 }
 
+typedef struct
+{
+  DbeView *dbev;
+  Experiment *exp;
+  DataView *packets;
+  Vector<BaseMetric*> *mlist;
+  long lo;
+  long hi;
+  int64_t *mvals;
+} packet_metrics_ctx;
+
+static int
+eval_packet_metrics_in_parallel (void *arg)
+{
+  packet_metrics_ctx *pctx = (packet_metrics_ctx *) arg;
+  Vector<BaseMetric*> *mlist = pctx->mlist;
+  int nmetrics = mlist->size ();
+
+  // Expression::eval keeps intermediate values in the Expression itself,
+  // so every thread needs its own copies.
+  Expression **conds = new Expression*[nmetrics];
+  Expression **vals = new Expression*[nmetrics];
+  for (int midx = 0; midx < nmetrics; midx++)
+    {
+      BaseMetric *mtr = mlist->fetch (midx);
+      conds[midx] = mtr->get_cond () ? mtr->get_cond ()->copy () : NULL;
+      vals[midx] = mtr->get_val ()->copy ();
+    }
+
+  Expression::Context ctx (pctx->dbev, pctx->exp);
+  int64_t *mvals = pctx->mvals;
+  for (long i = pctx->lo; i < pctx->hi; i++)
+    {
+      ctx.put (pctx->packets, i);
+      for (int midx = 0; midx < nmetrics; midx++)
+	{
+	  if (conds[midx] != NULL && !conds[midx]->passes (&ctx))
+	    *mvals++ = 0;
+	  else
+	    *mvals++ = vals[midx]->eval (&ctx);
+	}
+    }
+
+  for (int midx = 0; midx < nmetrics; midx++)
+    {
+      delete conds[midx];
+      delete vals[midx];
+    }
+  delete[] conds;
+  delete[] vals;
+  free (pctx);
+  return 0;
+}
+
+// Evaluate the metrics of packets [lo, hi) into mvals, on the threads of
+// the session's pool.  The threads only read the packets, whose index
+// PACKETS->getSize () has brought up to date, the experiment and the
+// metrics, of whose expressions each uses its own copies.  Expressions
+// that read call stacks or other objects may create objects, so they
+// are evaluated on this thread.
+void
+PathTree::eval_packet_metrics (Experiment *exp, DataView *packets,
+			       Vector<BaseMetric*> *mlist, long lo, long hi,
+			       int64_t *mvals)
+{
+  DbeThreadPool *threadPool = NULL;
+  if (hi - lo > PACKETS_PER_THREAD)
+    {
+      threadPool = dbeSession->get_thread_pool ();
+      for (long i = 0, sz = mlist->size (); i < sz; i++)
+	{
+	  BaseMetric *mtr = mlist->get (i);
+	  if ((mtr->get_cond () && mtr->get_cond ()->readsObjects ())
+	      || mtr->get_val ()->readsObjects ())
+	    {
+	      threadPool = NULL;
+	      break;
+	    }
+	}
+    }
+  for (long i = lo; i < hi; i += PACKETS_PER_THREAD)
+    {
+      packet_metrics_ctx *pctx = (packet_metrics_ctx *)
+	      xmalloc (sizeof (packet_metrics_ctx));
+      pctx->dbev = dbev;
+      pctx->exp = exp;
+      pctx->packets = packets;
+      pctx->mlist = mlist;
+      pctx->lo = i;
+      pctx->hi = i + PACKETS_PER_THREAD < hi ? i + PACKETS_PER_THREAD : hi;
+      pctx->mvals = mvals + (i - lo) * mlist->size ();
+      if (threadPool)
+	threadPool->put_queue (new DbeQueue (eval_packet_metrics_in_parallel,
+					     pctx));
+      else
+	eval_packet_metrics_in_parallel (pctx);
+    }
+  if (threadPool)
+    threadPool->wait_idle ();
+}
+
 PtreePhaseStatus
 PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
 {
@@ -603,51 +862,65 @@ PathTree::process_packets (Experiment *exp, DataView *packets, int data_type)
       mslots[midx] = SLOT_IDX (slot_ind);
     }
 
-  for (long i = 0, packets_sz = packets->getSize (); i < packets_sz; ++i)
+  // The metric values are evaluated in parallel, a window of packets at
+  // a time.  The paths are then added to the tree in packet order, so
+  // the tree does not depend on the number of threads.
+  int nmetrics = mlist2.size ();
+  long packets_sz = packets->getSize ();
+  long window_sz = packets_sz < PACKETS_PER_WINDOW ? packets_sz
+		   : PACKETS_PER_WINDOW;
+  int64_t *mvals = new int64_t[window_sz * nmetrics];
+  for (long lo = 0; lo < packets_sz; lo += window_sz)
     {
-      if (dbeSession->is_interactive ())
+      long hi = lo + window_sz < packets_sz ? lo + window_sz : packets_sz;
+      eval_packet_metrics (exp, packets, &mlist2, lo, hi, mvals);
+      for (long i = lo; i < hi; ++i)
 	{
-	  if (NULL == progress_bar_msg)
-	    progress_bar_msg = dbe_sprintf (GTXT ("Processing Experiment: %s"),
-					  get_basename (exp->get_expt_name ()));
-	  int val = (int) (100 * i / packets_sz);
-	  if (val > progress_bar_percent)
+	  if (dbeSession->is_interactive ())
 	    {
-	      progress_bar_percent += 10;
-	      if (theApplication->set_progress (val, progress_bar_msg)
-		  && cancel_ok)
+	      if (NULL == progress_bar_msg)
+		progress_bar_msg = dbe_sprintf (GTXT ("Processing Experiment: %s"),
+					get_basename (exp->get_expt_name ()));
+	      int val = (int) (100 * i / packets_sz);
+	      if (val > progress_bar_percent)
 		{
-		  delete[] mslots;
-		  return CANCELED;
+		  progress_bar_percent += 10;
+		  if (theApplication->set_progress (val, progress_bar_msg)
+		      && cancel_ok)
+		    {
+		      delete[] mvals;
+		      delete[] mslots;
+		      return CANCELED;
+		    }
 		}
 	    }
-	}
-
-      NodeIdx path_idx = 0;
-      ctx.put (packets, i);
-
-      for (int midx = 0, mlist_sz = mlist2.size (); midx < mlist_sz; ++midx)
-	{
-	  BaseMetric *mtr = mlist2.fetch (midx);
-	  if (mtr->get_cond () != NULL && !mtr->get_cond ()->passes (&ctx))
-	    continue;
 
-	  int64_t mval = mtr->get_val ()->eval (&ctx);
-	  if (mval == 0)
-	    continue;
-	  if (path_idx == 0)
-	    path_idx = find_path (exp, packets, i);
-	  NodeIdx node_idx = path_idx;
-	  Slot *mslot = mslots[midx];
-	  while (node_idx)
+	  NodeIdx path_idx = 0;
+	  int64_t *vals = mvals + (i - lo) * nmetrics;
+	  for (int midx = 0; midx < nmetrics; ++midx)
 	    {
-	      INCREMENT_METRIC (mslot, node_idx, mval);
-	      node_idx = NODE_IDX (node_idx)->ancestor;
+	      int64_t mval = vals[midx];
+	      if (mval == 0)
+		continue;
+	      if (path_idx == 0)
+		{
+		  path_idx = find_path (exp, packets, i);
+		  if (refilter_map)
+		    refilter_mark (path_idx);
+		}
+	      NodeIdx node_idx = path_idx;
+	      Slot *mslot = mslots[midx];
+	      while (node_idx)
+		{
+		  INCREMENT_METRIC (mslot, node_idx, mval);
+		  node_idx = NODE_IDX (node_idx)->ancestor;
+		}
 	    }
 	}
     }
   if (dbeSession->is_interactive ())
     free (progress_bar_msg);
+  delete[] mvals;
   delete[] mslots;
   if (indx_expr != NULL)
     root->descendants->sort ((CompareFunc) desc_node_comp, this);
@@ -29,6 +29,8 @@
 #include "Histable.h"
 #include "Metric.h"
 
+template <typename Key_t, typename Value_t> class CacheMap;
+
 typedef enum
 {
   NORMAL = 0, CANCELED
@@ -135,7 +137,9 @@ private:
 
   enum
   {
-    MAX_DESC_HTABLE_SZ = 65535
+    MAX_DESC_HTABLE_SZ = 65535,
+    PACKETS_PER_THREAD = 16384,
+    PACKETS_PER_WINDOW = 16 * PACKETS_PER_THREAD
   };
 
   typedef struct hash_node
@@ -172,7 +176,7 @@ private:
   Expression *indx_expr;
   Histable *total_obj;
   Map<Function*, NodeIdx> *fn_map;
-  Map<uint64_t, NodeIdx> *pathMap;
+  CacheMap<uint64_t, NodeIdx> *pathMap;
   Map<uint64_t, uint64_t> *hideMap;
   int status;
   NodeIdx root_idx;
@@ -200,12 +204,19 @@ private:
   PathTree *ftree_internal;             // function-based pathtree
   bool ftree_needs_update;
   Vector<Vector<NodeIdx>*> *depth_map; // for each depth level, list of nodes
+  Vector<NodeIdx> *refilter_map;        // old to new node index during refilter
+  long refilter_nodes;
 
   void init ();
   void fini ();
   PtreePhaseStatus reset ();
   PtreePhaseStatus add_experiment (int);
   PtreePhaseStatus process_packets (Experiment*, DataView*, int);
+  void eval_packet_metrics (Experiment*, DataView*, Vector<BaseMetric*>*,
+			    long, long, int64_t*);
+  void refilter_start ();
+  void refilter_mark (NodeIdx);
+  void refilter_finish ();
   DataView *get_filtered_events (int exp_index, int data_type);
   void construct (DbeView *_dbev, int _indxtype, PathTreeType _pathTreeType);
 
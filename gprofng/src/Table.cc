@@ -222,6 +222,11 @@ public:
     data = new Vector<int32_t>;
   }
 
+  DataINT32 (int32_t *buf, long sz)
+  {
+    data = new Vector<int32_t>(buf, sz);
+  }
+
   virtual
   ~DataINT32 ()
   {
@@ -331,6 +336,11 @@ public:
     data = new Vector<uint32_t>;
   }
 
+  DataUINT32 (uint32_t *buf, long sz)
+  {
+    data = new Vector<uint32_t>(buf, sz);
+  }
+
   virtual
   ~DataUINT32 ()
   {
@@ -440,6 +450,11 @@ public:
     data = new Vector<int64_t>;
   }
 
+  DataINT64 (int64_t *buf, long sz)
+  {
+    data = new Vector<int64_t>(buf, sz);
+  }
+
   virtual
   ~DataINT64 ()
   {
@@ -549,6 +564,11 @@ public:
     data = new Vector<uint64_t>;
   }
 
+  DataUINT64 (uint64_t *buf, long sz)
+  {
+    data = new Vector<uint64_t>(buf, sz);
+  }
+
   virtual
   ~DataUINT64 ()
   {
@@ -878,6 +898,11 @@ public:
     data = new Vector<double>;
   }
 
+  DataDOUBLE (double *buf, long sz)
+  {
+    data = new Vector<double>(buf, sz);
+  }
+
   virtual
   ~DataDOUBLE ()
   {
@@ -1000,6 +1025,29 @@ Data::newData (VType_type vtype)
     }
 }
 
+// Create a column of SZ values stored at BUF, which the caller keeps
+// valid for the lifetime of the column.  BUF is copied only when the
+// column grows.
+Data *
+Data::newData (VType_type vtype, void *buf, long sz)
+{
+  switch (vtype)
+    {
+    case TYPE_INT32:
+      return new DataINT32 ((int32_t *) buf, sz);
+    case TYPE_UINT32:
+      return new DataUINT32 ((uint32_t *) buf, sz);
+    case TYPE_INT64:
+      return new DataINT64 ((int64_t *) buf, sz);
+    case TYPE_UINT64:
+      return new DataUINT64 ((uint64_t *) buf, sz);
+    case TYPE_DOUBLE:
+      return new DataDOUBLE ((double *) buf, sz);
+    default:
+      return NULL;
+    }
+}
+
 /*
  *    class DataDescriptor
  */
@@ -1123,6 +1171,28 @@ DataDescriptor::addRecord ()
   return master_size++;
 }
 
+long
+DataDescriptor::addRecords (long cnt)
+{
+  if (!isMaster)
+    return -1;
+  long recn = master_size;
+  master_size += cnt;
+  return recn;
+}
+
+void
+DataDescriptor::setData (int prop_id, Data *d)
+{
+  if (!isMaster || getProp (prop_id) == NULL)
+    {
+      delete d;
+      return;
+    }
+  delete data->fetch (prop_id);
+  data->store (prop_id, d);
+}
+
 static void
 checkEntity (Vector<long long> *set, long long val)
 {
@@ -374,6 +374,7 @@ class Data
 {
 public:
   static Data *newData (VType_type);
+  static Data *newData (VType_type, void *buf, long sz);
 
   virtual
   ~Data () { }
@@ -479,7 +480,9 @@ public:
   // table creation/reset
   void addProperty (PropDescr*); // add property to all packets
   long addRecord ();            // add packet
+  long addRecords (long cnt);   // add CNT packets
   Data *getData (int prop_id);  // get all packets
+  void setData (int prop_id, Data *d); // replace all values of a property
   void setDatumValue (int prop_id, long pkt_id, const Datum *val);
   void setValue (int prop_id, long pkt_id, uint64_t val);
   void setObjValue (int prop_id, long pkt_id, void *val);
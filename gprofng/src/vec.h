@@ -86,14 +86,27 @@ public:
     data = NULL;
     limit = 0;
     sorted = false;
+    borrowed = false;
   };
 
   Vector (long sz);
 
+  // Use the SZ items at BUF, which are owned by the caller, until the
+  // vector has to grow.
+  Vector (ITEM *buf, long sz)
+  {
+    count = sz;
+    data = buf;
+    limit = sz;
+    sorted = false;
+    borrowed = true;
+  };
+
   virtual
   ~Vector ()
   {
-    free (data);
+    if (!borrowed)
+      free (data);
   }
 
   void append (const ITEM item);
@@ -191,6 +204,7 @@ private:
   long count;   // Number of items
   long limit;   // Vector length (power of 2)
   bool sorted;
+  bool borrowed; // data is not owned by the vector
 };
 
 template<> VecType Vector<int>::type ();
@@ -225,6 +239,7 @@ Vector<ITEM>::Vector (long sz)
   limit = sz > 0 ? sz : KILOCHUNK; // was 0;
   data = limit ? (ITEM *) xmalloc (sizeof (ITEM) * limit) : NULL;
   sorted = false;
+  borrowed = false;
 }
 
 template <typename ITEM> void
@@ -242,7 +257,15 @@ Vector<ITEM>
       else
 	limit = limit * 2;
     }
-  data = (ITEM *) xrealloc (data, limit * sizeof (ITEM));
+  if (borrowed)
+    {
+      ITEM *p = (ITEM *) xmalloc (limit * sizeof (ITEM));
+      memcpy ((char *) p, (char *) data, count * sizeof (ITEM));
+      data = p;
+      borrowed = false;
+    }
+  else
+    data = (ITEM *) xrealloc (data, limit * sizeof (ITEM));
 }
 
 template <typename ITEM> void
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static void * volatile p;
+
+static void
+alloc (int n, int size)
+{
+  for (int i = 0; i < n; i++)
+    {
+      p = malloc (size + i % 64);
+      free (p);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc > 1)
+    {
+      /* The exec'ed descendant.  */
+      alloc (atoi (argv[1]), 256);
+      return 0;
+    }
+
+  for (int i = 0; i < 4; i++)
+    {
+      pid_t pid = fork ();
+      if (pid == 0)
+	{
+	  char arg[16];
+
+	  /* The forked descendant, which execs itself.  */
+	  alloc (5000 * (i + 1), 16);
+	  sprintf (arg, "%d", 10000 * (i + 1));
+	  execl (argv[0], argv[0], arg, (char *) NULL);
+	  _exit (1);
+	}
+      else if (pid < 0)
+	return 1;
+    }
+  alloc (20000, 4096);
+  while (wait (NULL) > 0)
+    ;
+  return 0;
+}
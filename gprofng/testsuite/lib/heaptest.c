@@ -0,0 +1,31 @@
+#include <stdlib.h>
+
+static void * volatile p;
+
+static void
+alloc_small (int n)
+{
+  for (int i = 0; i < n; i++)
+    {
+      p = malloc (16 + i % 64);
+      free (p);
+    }
+}
+
+static void
+alloc_large (int n)
+{
+  for (int i = 0; i < n; i++)
+    {
+      p = malloc (4096 + i % 4096);
+      free (p);
+    }
+}
+
+int
+main (void)
+{
+  alloc_small (40000);
+  alloc_large (20000);
+  return 0;
+}
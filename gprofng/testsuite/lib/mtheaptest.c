@@ -0,0 +1,26 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define NALLOCS 20000
+
+static void *
+alloc (void *arg)
+{
+  for (int i = 0; i < NALLOCS; i++)
+    free (malloc (16 + i % 64));
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+
+  for (int i = 0; i < NTHREADS; i++)
+    if (pthread_create (&threads[i], NULL, alloc, NULL) != 0)
+      return 1;
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include <stdlib.h>
+
+static void * volatile p;
+
+static void __attribute__ ((noinline))
+leaf (int n)
+{
+  for (int i = 0; i < n; i++)
+    {
+      p = malloc (16 + i % 64);
+      free (p);
+    }
+}
+
+static void __attribute__ ((noinline))
+middle (int depth, int n)
+{
+  char buf[64];
+
+  buf[depth] = n;
+  if (depth > 0)
+    middle (depth - 1, n + buf[depth] % 2);
+  else
+    leaf (n);
+  p = buf;
+}
+
+static void __attribute__ ((noinline))
+top (int n)
+{
+  leaf (n);
+  middle (3, n);
+}
+
+int
+main (void)
+{
+  for (int i = 0; i < 100; i++)
+    top (100);
+  middle (5, 1000);
+  return 0;
+}
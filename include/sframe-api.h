@@ -145,6 +145,14 @@ extern void *
 sframe_get_funcdesc_with_addr (sframe_decoder_ctx *dctx, int32_t addr,
 			       int *errp);
 
+/* Build an index of the FDEs and FREs in the decoder DCTX, which is then
+   used by sframe_find_fre instead of decoding the FREs of the function one
+   by one.  The index also caches recent lookups, so calls to
+   sframe_find_fre on an indexed DCTX must not be made concurrently.
+   Returns SFRAME_ERR if failure.  */
+extern int
+sframe_decoder_build_index (sframe_decoder_ctx *dctx);
+
 /* Find the SFrame Frame Row Entry which contains the PC.  Returns
    SFRAME_ERR if failure.  */
 
@@ -282,7 +282,7 @@ arc_write_one_ctf (ctf_dict_t *f, int fd, size_t threshold)
     }
 
   if (ctf_write_thresholded (f, fd, threshold) != 0)
-    return f->ctf_errno * -1;
+    return ctf_errno (f) * -1;
 
   if ((end_off = lseek (fd, 0, SEEK_CUR)) < 0)
     return errno * -1;
@@ -516,6 +516,12 @@ ctf_arc_close (ctf_archive_t *arc)
   if (arc == NULL)
     return;
 
+  /* The cached dicts use the archive's strtabs in place, so they must be
+     closed before it is unmapped.  */
+  free (arc->ctfi_symdicts);
+  free (arc->ctfi_symnamedicts);
+  ctf_dynhash_destroy (arc->ctfi_dicts);
+
   if (arc->ctfi_is_archive)
     {
       if (arc->ctfi_unmap_on_close)
@@ -523,9 +529,6 @@ ctf_arc_close (ctf_archive_t *arc)
     }
   else
     ctf_dict_close (arc->ctfi_dict);
-  free (arc->ctfi_symdicts);
-  free (arc->ctfi_symnamedicts);
-  ctf_dynhash_destroy (arc->ctfi_dicts);
   if (arc->ctfi_free_symsect)
     free ((void *) arc->ctfi_symsect.cts_data);
   if (arc->ctfi_free_strsect)
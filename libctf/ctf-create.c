@@ -177,9 +177,15 @@ ctf_update (ctf_dict_t *fp)
   return 0;
 }
 
+/* Return the name table for the given KIND.  The static types' names are
+   hashed into it first if this has not yet been done: on error, the errno
+   on FP is set, and the table returned may lack some static names.  */
+
 ctf_dynhash_t *
 ctf_name_table (ctf_dict_t *fp, int kind)
 {
+  (void) ctf_populate_names (fp);
+
   switch (kind)
     {
     case CTF_K_STRUCT:
@@ -1070,7 +1076,8 @@ ctf_add_enumerator (ctf_dict_t *fp, ctf_id_t enid, const char *name,
   /* Enumeration constant names are only added, and only checked for duplicates,
      if the enum they are part of is a root-visible type.  */
 
-  if (root == CTF_ADD_ROOT && ctf_dynhash_lookup (fp->ctf_names, name))
+  if (root == CTF_ADD_ROOT
+      && ctf_dynhash_lookup (ctf_name_table (fp, CTF_K_UNKNOWN), name))
     {
       if (fp->ctf_flags & LCTF_STRICT_NO_DUP_ENUMERATORS)
 	return (ctf_set_errno (ofp, ECTF_DUPLICATE));
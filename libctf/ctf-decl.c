@@ -84,7 +84,7 @@ ctf_decl_push (ctf_decl_t *cd, ctf_dict_t *fp, ctf_id_t type)
 
   if ((tp = ctf_lookup_by_id (&fp, type)) == NULL)
     {
-      cd->cd_err = fp->ctf_errno;
+      cd->cd_err = ctf_errno (fp);
       return;
     }
 
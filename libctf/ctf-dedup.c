@@ -22,6 +22,10 @@
 #include <errno.h>
 #include <assert.h>
 #include "hashtab.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 /* (In the below, relevant functions are named in square brackets.)  */
 
@@ -342,6 +346,15 @@ packed_id_to_type (const void *id)
 }
 #endif
 
+/* Types are hashed in parallel if threads are available, except on 32-bit
+   platforms, where GIDs are allocated in the dict doing the hashing and so
+   cannot be moved from one dict to another.  */
+
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_PTHREAD_CREATE) \
+  && defined (_libctf_thread_local_) && !defined (IDS_NEED_ALLOCATION)
+# define CTF_DEDUP_PARALLEL 1
+#endif
+
 /* Make an element in a dynhash-of-dynsets, or return it if already present.  */
 
 static ctf_dynset_t *
@@ -1086,8 +1099,12 @@ ctf_dedup_hash_type (ctf_dict_t *fp, ctf_dict_t *input,
 	  ctf_dprintf ("%lu: Known hash for ID %i/%lx: %s\n", depth, input_num,
 		       type,  hval);
 #endif
-	  populate_fun (fp, input, inputs, input_num, type, type_id,
-			decorated, hval);
+	  if (populate_fun (fp, input, inputs, input_num, type, type_id,
+			    decorated, hval) < 0)
+	    {
+	      whaterr = N_("error calling population function");
+	      goto err;				/* errno is set for us. */
+	    }
 
 	  return hval;
 	}
@@ -1736,6 +1753,7 @@ ctf_dedup_fini (ctf_dict_t *fp, ctf_dict_t **outputs, uint32_t noutputs)
   ctf_dynhash_destroy (d->cd_input_nums);
   ctf_dynhash_destroy (d->cd_emission_struct_members);
   ctf_dynset_destroy (d->cd_conflicting_types);
+  free (d->cd_populate_log);
 
   /* Free the per-output state.  */
   if (outputs)
@@ -1906,6 +1924,454 @@ ctf_dedup_conflictify_unshared (ctf_dict_t *output, ctf_dict_t **inputs)
   return ctf_set_errno (output, err);
 }
 
+/* Hash all the types in INPUTS[INPUT_NUM], recording the results in FP and
+   calling POPULATE_FUN for each of them.  */
+
+static int
+ctf_dedup_hash_input (ctf_dict_t *fp, ctf_dict_t **inputs, uint32_t input_num,
+		      int (*populate_fun) (ctf_dict_t *fp,
+					   ctf_dict_t *input,
+					   ctf_dict_t **inputs,
+					   int input_num,
+					   ctf_id_t type,
+					   void *id,
+					   const char *decorated_name,
+					   const char *hash))
+{
+  ctf_next_t *it = NULL;
+  ctf_id_t id;
+
+  while ((id = ctf_type_next (inputs[input_num], &it, NULL, 1)) != CTF_ERR)
+    {
+      if (ctf_dedup_hash_type (fp, inputs[input_num], inputs, input_num, id,
+			       0, 0, populate_fun) == NULL)
+	{
+	  ctf_next_destroy (it);
+	  return -1;				/* errno is set for us.  */
+	}
+    }
+  if (ctf_errno (inputs[input_num]) != ECTF_NEXT_END)
+    {
+      ctf_set_errno (fp, ctf_errno (inputs[input_num]));
+      ctf_err_warn (fp, 0, 0, _("iteration failure computing type hashes"));
+      return -1;
+    }
+  return 0;
+}
+
+#ifdef CTF_DEDUP_PARALLEL
+
+/* Parallel type hashing.
+
+   Hashing is by far the most expensive phase of deduplication, and the
+   hashing of each input is independent of all the others: the hash of a type
+   depends only on the type graph, and the GIDs in cd_type_hashes carry the
+   input number, so no input ever sees the cached hashes of another.  So each
+   input is hashed by a worker thread into a scratch dict of its own, with its
+   own atoms and dedup state, and with a population function that only logs
+   its calls.  The main thread merges the scratch dicts into the output in
+   input order, translating their atoms into the output's and replaying the
+   logged calls to ctf_dedup_populate_mappings, so the output state is exactly
+   what hashing the inputs one after another would have produced, and
+   emission stays deterministic.
+
+   The workers only read the inputs.  Errors are the exception: the functions
+   they call set the errno of the inputs, and of the parent dicts that
+   children share, so each worker points _libctf_errno_override at the errno
+   of its scratch dict while hashing, and all of them end up there.  */
+
+/* Upper limit on the number of hashing threads.  */
+#define CTF_DEDUP_MAX_THREADS 16
+
+/* How many inputs the workers may hash ahead of the merging.  This bounds the
+   number of scratch dicts in existence.  */
+#define CTF_DEDUP_HASH_AHEAD 64
+
+/* One logged call of the population function.  */
+
+typedef struct ctf_dedup_populate_call
+{
+  ctf_dict_t *cpc_input;
+  ctf_id_t cpc_type;
+  void *cpc_id;
+  const char *cpc_decorated_name;
+  const char *cpc_hval;
+} ctf_dedup_populate_call_t;
+
+/* The state of one input being hashed.  */
+
+typedef struct ctf_dedup_hash_job
+{
+  ctf_dict_t *chj_scratch;	/* The dict the results are in.  */
+  int chj_err;			/* Nonzero if hashing failed.  */
+  int chj_done;			/* Nonzero once hashing is over.  */
+} ctf_dedup_hash_job_t;
+
+typedef struct ctf_dedup_hash_pool
+{
+  pthread_mutex_t chp_lock;
+  pthread_cond_t chp_cond;
+  ctf_dict_t **chp_inputs;
+  uint32_t chp_ninputs;
+  int chp_link_flags;
+  uint32_t chp_next;		/* The next input to hash.  */
+  uint32_t chp_merged;		/* The number of inputs merged so far.  */
+  int chp_stop;			/* Set to abandon hashing.  */
+  ctf_dedup_hash_job_t *chp_jobs;
+} ctf_dedup_hash_pool_t;
+
+/* The population function used on worker threads: log the call in the
+   scratch dict FP for later replay.  */
+
+static int
+ctf_dedup_log_populate (ctf_dict_t *fp, ctf_dict_t *input,
+			ctf_dict_t **inputs _libctf_unused_,
+			int input_num _libctf_unused_, ctf_id_t type,
+			void *id, const char *decorated_name,
+			const char *hval)
+{
+  ctf_dedup_t *d = &fp->ctf_dedup;
+  ctf_dedup_populate_call_t *call;
+
+  if (d->cd_populate_log_len == d->cd_populate_log_alloced)
+    {
+      size_t alloced = d->cd_populate_log_alloced * 2 + 256;
+
+      if ((call = realloc (d->cd_populate_log,
+			   alloced * sizeof (ctf_dedup_populate_call_t)))
+	  == NULL)
+	return ctf_set_errno (fp, ENOMEM);
+      d->cd_populate_log = call;
+      d->cd_populate_log_alloced = alloced;
+    }
+
+  call = &d->cd_populate_log[d->cd_populate_log_len++];
+  call->cpc_input = input;
+  call->cpc_type = type;
+  call->cpc_id = id;
+  call->cpc_decorated_name = decorated_name;
+  call->cpc_hval = hval;
+  return 0;
+}
+
+static void *
+ctf_dedup_hash_worker (void *arg)
+{
+  ctf_dedup_hash_pool_t *pool = (ctf_dedup_hash_pool_t *) arg;
+
+  pthread_mutex_lock (&pool->chp_lock);
+  while (!pool->chp_stop && pool->chp_next < pool->chp_ninputs)
+    {
+      uint32_t input_num = pool->chp_next;
+      ctf_dedup_hash_job_t *job = &pool->chp_jobs[input_num];
+      ctf_dict_t *scratch;
+      int err = 0;
+
+      if (input_num >= pool->chp_merged + CTF_DEDUP_HASH_AHEAD)
+	{
+	  pthread_cond_wait (&pool->chp_cond, &pool->chp_lock);
+	  continue;
+	}
+      pool->chp_next++;
+
+      /* Dict creation is not known to be thread-safe: do it under the
+	 lock.  */
+      scratch = ctf_create (&err);
+      pthread_mutex_unlock (&pool->chp_lock);
+
+      if (scratch != NULL)
+	{
+	  scratch->ctf_dedup.cd_link_flags = pool->chp_link_flags;
+	  _libctf_errno_override = &scratch->ctf_errno;
+	  if (ctf_dedup_init (scratch) < 0
+	      || ctf_dedup_hash_input (scratch, pool->chp_inputs, input_num,
+				       ctf_dedup_log_populate) < 0)
+	    err = ctf_errno (scratch) != 0 ? ctf_errno (scratch)
+	      : ECTF_INTERNAL;
+	  _libctf_errno_override = NULL;
+	}
+
+      pthread_mutex_lock (&pool->chp_lock);
+      job->chj_scratch = scratch;
+      job->chj_err = err;
+      job->chj_done = 1;
+      pthread_cond_broadcast (&pool->chp_cond);
+    }
+  pthread_mutex_unlock (&pool->chp_lock);
+  return NULL;
+}
+
+/* Translate an ATOM in a scratch dict into the same atom in FP, caching the
+   translation in IMPORTED.  */
+
+static const char *
+ctf_dedup_import_atom (ctf_dict_t *fp, ctf_dynhash_t *imported,
+		       const char *atom)
+{
+  const char *ret;
+  char *copy;
+
+  if (atom == NULL)
+    return NULL;
+
+  if ((ret = ctf_dynhash_lookup (imported, atom)) != NULL)
+    return ret;
+
+  if ((copy = strdup (atom)) == NULL)
+    {
+      ctf_set_errno (fp, ENOMEM);
+      return NULL;
+    }
+  if ((ret = intern (fp, copy)) == NULL)
+    return NULL;				/* errno is set for us.  */
+
+  if (ctf_dynhash_cinsert (imported, atom, ret) < 0)
+    {
+      ctf_set_errno (fp, ENOMEM);
+      return NULL;
+    }
+  return ret;
+}
+
+/* Merge the hashing state of INPUTS[INPUT_NUM] from the SCRATCH dict into the
+   OUTPUT, as if the input had been hashed directly into it.  */
+
+static int
+ctf_dedup_merge_hashes (ctf_dict_t *output, ctf_dict_t **inputs,
+			uint32_t input_num, ctf_dict_t *scratch)
+{
+  ctf_dedup_t *d = &output->ctf_dedup;
+  ctf_dedup_t *sd = &scratch->ctf_dedup;
+  ctf_dynhash_t *imported;
+  ctf_next_t *i = NULL;
+  void *k, *v;
+  size_t j;
+  int err;
+
+  if ((imported = ctf_dynhash_create (ctf_hash_integer, ctf_hash_eq_integer,
+				      NULL, NULL)) == NULL)
+    return ctf_set_errno (output, ENOMEM);
+
+  /* The type hashes must all be known before replaying the population calls,
+     which look them up.  */
+
+  while ((err = ctf_dynhash_next (sd->cd_type_hashes, &i, &k, &v)) == 0)
+    {
+      const char *hval;
+
+      if ((hval = ctf_dedup_import_atom (output, imported, v)) == NULL
+	  || ctf_dynhash_cinsert (d->cd_type_hashes, k, hval) < 0)
+	goto err;
+    }
+  if (err != ECTF_NEXT_END)
+    goto iterr;
+
+  while ((err = ctf_dynhash_next (sd->cd_struct_origin, &i, &k, &v)) == 0)
+    {
+      const char *decorated;
+
+      if ((decorated = ctf_dedup_import_atom (output, imported, k)) == NULL
+	  || ctf_dedup_record_origin (output, input_num, decorated, v) < 0)
+	goto err;
+    }
+  if (err != ECTF_NEXT_END)
+    goto iterr;
+
+  while ((err = ctf_dynhash_next (sd->cd_citers, &i, &k, &v)) == 0)
+    {
+      ctf_dynset_t *citer_hashes;
+      ctf_next_t *ci = NULL;
+      const char *citer;
+      void *hval;
+
+      if ((citer = ctf_dedup_import_atom (output, imported, k)) == NULL
+	  || (citer_hashes = make_set_element (d->cd_citers, citer)) == NULL)
+	goto err;
+
+      while ((err = ctf_dynset_next ((ctf_dynset_t *) v, &ci, &hval)) == 0)
+	{
+	  if ((hval = (void *) ctf_dedup_import_atom (output, imported,
+						      hval)) == NULL
+	      || (!ctf_dynset_exists (citer_hashes, hval, NULL)
+		  && ctf_dynset_cinsert (citer_hashes, hval) < 0))
+	    {
+	      ctf_next_destroy (ci);
+	      goto err;
+	    }
+	}
+      if (err != ECTF_NEXT_END)
+	{
+	  ctf_next_destroy (i);
+	  goto iterr;
+	}
+    }
+  if (err != ECTF_NEXT_END)
+    goto iterr;
+
+  for (j = 0; j < sd->cd_populate_log_len; j++)
+    {
+      ctf_dedup_populate_call_t *call = &sd->cd_populate_log[j];
+      const char *decorated = NULL;
+      const char *hval;
+
+      if ((call->cpc_decorated_name != NULL
+	   && (decorated = ctf_dedup_import_atom (output, imported,
+						  call->cpc_decorated_name))
+	   == NULL)
+	  || (hval = ctf_dedup_import_atom (output, imported,
+					    call->cpc_hval)) == NULL)
+	goto err_noiter;
+
+      if (ctf_dedup_populate_mappings (output, call->cpc_input, inputs,
+				       input_num, call->cpc_type, call->cpc_id,
+				       decorated, hval) < 0)
+	goto err_noiter;
+    }
+
+  ctf_dynhash_destroy (imported);
+  return 0;
+
+ err:
+  ctf_next_destroy (i);
+ err_noiter:
+  err = ctf_errno (output);
+ iterr:
+  ctf_dynhash_destroy (imported);
+  ctf_err_warn (output, 0, err, _("%s (%i): error merging type hashes"),
+		ctf_link_input_name (inputs[input_num]), input_num);
+  return ctf_set_errno (output, err);
+}
+
+/* Free the scratch dict of JOB.  */
+
+static void
+ctf_dedup_free_job (ctf_dedup_hash_pool_t *pool, ctf_dedup_hash_job_t *job)
+{
+  pthread_mutex_lock (&pool->chp_lock);
+  ctf_dict_close (job->chj_scratch);
+  job->chj_scratch = NULL;
+  pthread_mutex_unlock (&pool->chp_lock);
+}
+
+/* Compute hash values for all types in all INPUTS using NTHREADS worker
+   threads, merging them into OUTPUT in input order.  Returns 1 if no thread
+   could be started, in which case the caller must do the hashing itself.  */
+
+static int
+ctf_dedup_hash_parallel (ctf_dict_t *output, ctf_dict_t **inputs,
+			 uint32_t ninputs, long nthreads)
+{
+  ctf_dedup_hash_pool_t pool;
+  pthread_t *threads;
+  long nstarted = 0;
+  uint32_t i;
+  int ret = 0;
+
+  memset (&pool, 0, sizeof (pool));
+  if ((threads = calloc (nthreads, sizeof (pthread_t))) == NULL
+      || (pool.chp_jobs = calloc (ninputs,
+				  sizeof (ctf_dedup_hash_job_t))) == NULL)
+    {
+      free (threads);
+      return 1;
+    }
+  pool.chp_inputs = inputs;
+  pool.chp_ninputs = ninputs;
+  pool.chp_link_flags = output->ctf_dedup.cd_link_flags;
+  pthread_mutex_init (&pool.chp_lock, NULL);
+  pthread_cond_init (&pool.chp_cond, NULL);
+
+  for (nstarted = 0; nstarted < nthreads; nstarted++)
+    if (pthread_create (&threads[nstarted], NULL, ctf_dedup_hash_worker,
+			&pool) != 0)
+      break;
+
+  if (nstarted == 0)
+    {
+      ret = 1;
+      goto out;
+    }
+
+  ctf_dprintf ("Hashing types using %li threads\n", nstarted);
+
+  for (i = 0; i < ninputs; i++)
+    {
+      ctf_dedup_hash_job_t *job = &pool.chp_jobs[i];
+
+      pthread_mutex_lock (&pool.chp_lock);
+      while (!job->chj_done)
+	pthread_cond_wait (&pool.chp_cond, &pool.chp_lock);
+      pthread_mutex_unlock (&pool.chp_lock);
+
+      /* Any errors and warnings go into the output in input order.  */
+      if (job->chj_scratch)
+	ctf_list_splice (&output->ctf_errs_warnings,
+			 &job->chj_scratch->ctf_errs_warnings);
+
+      if (job->chj_err != 0)
+	{
+	  ctf_set_errno (output, job->chj_err);
+	  ret = -1;
+	}
+      else if (ctf_dedup_merge_hashes (output, inputs, i,
+				       job->chj_scratch) < 0)
+	ret = -1;
+      ctf_dedup_free_job (&pool, job);
+
+      pthread_mutex_lock (&pool.chp_lock);
+      pool.chp_merged = i + 1;
+      if (ret < 0)
+	pool.chp_stop = 1;
+      pthread_cond_broadcast (&pool.chp_cond);
+      pthread_mutex_unlock (&pool.chp_lock);
+
+      if (ret < 0)
+	break;
+    }
+
+  while (nstarted > 0)
+    pthread_join (threads[--nstarted], NULL);
+
+  /* Free the scratch dicts of the inputs hashed after an error.  */
+  for (i = 0; i < ninputs; i++)
+    if (pool.chp_jobs[i].chj_scratch)
+      ctf_dict_close (pool.chp_jobs[i].chj_scratch);
+
+ out:
+  pthread_mutex_destroy (&pool.chp_lock);
+  pthread_cond_destroy (&pool.chp_cond);
+  free (pool.chp_jobs);
+  free (threads);
+  return ret;
+}
+
+/* The number of threads to hash NINPUTS inputs with: 1 means no threads at
+   all.  Debugging output is easier to follow without threads.  One thread per
+   CPU is used, unless LIBCTF_DEDUP_THREADS is set in the environment, which
+   the testsuite uses to compare threaded and serial hashing.  */
+
+static long
+ctf_dedup_hash_threads (uint32_t ninputs)
+{
+  const char *env;
+  long nthreads = 1;
+
+#ifdef _SC_NPROCESSORS_ONLN
+  nthreads = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+  if ((env = getenv ("LIBCTF_DEDUP_THREADS")) != NULL)
+    nthreads = strtol (env, NULL, 10);
+  if (nthreads > CTF_DEDUP_MAX_THREADS)
+    nthreads = CTF_DEDUP_MAX_THREADS;
+  if (nthreads > (long) ninputs)
+    nthreads = ninputs;
+  if (nthreads < 1 || ctf_getdebug ())
+    nthreads = 1;
+  return nthreads;
+}
+
+#endif /* CTF_DEDUP_PARALLEL */
+
 /* The core deduplicator.  Populate cd_output_mapping in the output ctf_dedup with a
    mapping of all types that belong in this dictionary and where they come from, and
    cd_conflicting_types with an indication of whether each type is conflicted or not.
@@ -1924,7 +2390,6 @@ ctf_dedup (ctf_dict_t *output, ctf_dict_t **inputs, uint32_t ninputs,
 {
   ctf_dedup_t *d = &output->ctf_dedup;
   size_t i;
-  ctf_next_t *it = NULL;
 
   if (ctf_dedup_init (output) < 0)
     return -1; 					/* errno is set for us.  */
@@ -1959,25 +2424,28 @@ ctf_dedup (ctf_dict_t *output, ctf_dict_t **inputs, uint32_t ninputs,
      IDs in cd_output_mapping.  */
 
   ctf_dprintf ("Computing type hashes\n");
+#ifdef CTF_DEDUP_PARALLEL
+  {
+    long nthreads = ctf_dedup_hash_threads (ninputs);
+    int ret = 1;
+
+    if (nthreads > 1)
+      ret = ctf_dedup_hash_parallel (output, inputs, ninputs, nthreads);
+    if (ret < 0)
+      goto err;					/* errno is set for us.  */
+    if (ret == 0)
+      goto hashed;
+  }
+#endif
+
   for (i = 0; i < ninputs; i++)
-    {
-      ctf_id_t id;
+    if (ctf_dedup_hash_input (output, inputs, i,
+			      ctf_dedup_populate_mappings) < 0)
+      goto err;					/* errno is set for us.  */
 
-      while ((id = ctf_type_next (inputs[i], &it, NULL, 1)) != CTF_ERR)
-	{
-	  if (ctf_dedup_hash_type (output, inputs[i], inputs,
-				   i, id, 0, 0,
-				   ctf_dedup_populate_mappings) == NULL)
-	    goto err;				/* errno is set for us.  */
-	}
-      if (ctf_errno (inputs[i]) != ECTF_NEXT_END)
-	{
-	  ctf_set_errno (output, ctf_errno (inputs[i]));
-	  ctf_err_warn (output, 0, 0, _("iteration failure "
-					"computing type hashes"));
-	  goto err;
-	}
-    }
+#ifdef CTF_DEDUP_PARALLEL
+ hashed:
+#endif
 
   /* Go through the cd_name_counts name->hash->count mapping for all CTF
      namespaces: any name with many hashes associated with it at this stage is
@@ -76,8 +76,17 @@ ctf_errmsg (int error)
   return (str ? gettext (str) : _("Unknown error"));
 }
 
+#ifdef _libctf_thread_local_
+/* If set, the errno used on this thread in place of that of every dict.  */
+_libctf_thread_local_ int *_libctf_errno_override;
+#endif
+
 int
 ctf_errno (ctf_dict_t * fp)
 {
+#ifdef _libctf_thread_local_
+  if (_libctf_errno_override != NULL)
+    return *_libctf_errno_override;
+#endif
   return fp->ctf_errno;
 }
@@ -85,6 +85,14 @@ extern "C"
 
 #endif
 
+/* Thread-local storage, if the compiler has it.  */
+
+#if defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define _libctf_thread_local_ _Thread_local
+#elif defined (__GNUC__)
+#define _libctf_thread_local_ __thread
+#endif
+
 #if defined (ENABLE_LIBCTF_HASH_DEBUGGING) && !defined (NDEBUG)
 #include <assert.h>
 #define ctf_assert(fp, expr) (assert (expr), 1)
@@ -359,6 +367,13 @@ typedef struct ctf_dedup
   /* Points to the output counterpart of this input dictionary, at emission
      time.  */
   ctf_dict_t *cd_output;
+
+  /* The calls made to the population function while hashing the types of one
+     input on a worker thread, in order.  Populated only in the scratch dicts
+     used for parallel hashing.  */
+  struct ctf_dedup_populate_call *cd_populate_log;
+  size_t cd_populate_log_len;
+  size_t cd_populate_log_alloced;
 } ctf_dedup_t;
 
 /* The ctf_dict is the structure used to represent a CTF dictionary to library
@@ -389,10 +404,13 @@ struct ctf_dict
   ctf_dynhash_t *ctf_enums;	    /* Hash table of enum types.  */
   ctf_dynhash_t *ctf_names;	    /* Hash table of remaining types, plus
 				       enumeration constants.  */
+  int ctf_names_pending;	    /* Static types not yet in the hashes
+				       above: see ctf_populate_names.  */
   ctf_lookup_t ctf_lookups[5];	    /* Pointers to nametabs for name lookup.  */
   ctf_strs_t ctf_str[2];	    /* Array of string table base and bounds.  */
   ctf_strs_writable_t *ctf_dynstrtab; /* Dynamically allocated string table, if any. */
   ctf_dynhash_t *ctf_str_atoms;	  /* Hash table of ctf_str_atoms_t.  */
+  int ctf_str_atoms_pending;	  /* Static strtab not yet in ctf_str_atoms.  */
   ctf_dynhash_t *ctf_str_movable_refs; /* Hash table of void * -> ctf_str_atom_ref_movable_t.  */
   uint32_t ctf_str_prov_offset;	  /* Latest provisional offset assigned so far.  */
   unsigned char *ctf_base;	  /* CTF file pointer.  */
@@ -606,6 +624,7 @@ struct ctf_next
 #define LCTF_STRICT_NO_DUP_ENUMERATORS 0x0004 /* Duplicate enums prohibited.  */
 
 extern ctf_dynhash_t *ctf_name_table (ctf_dict_t *, int);
+extern int ctf_populate_names (ctf_dict_t *);
 extern const ctf_type_t *ctf_lookup_by_id (ctf_dict_t **, ctf_id_t);
 extern ctf_id_t ctf_lookup_variable_here (ctf_dict_t *fp, const char *name);
 extern ctf_id_t ctf_lookup_by_sym_or_name (ctf_dict_t *, unsigned long symidx,
@@ -802,6 +821,9 @@ extern const char _CTF_NULLSTR[];	/* empty string */
 
 extern int _libctf_version;	/* library client version */
 extern int _libctf_debug;	/* debugging messages enabled */
+#ifdef _libctf_thread_local_
+extern _libctf_thread_local_ int *_libctf_errno_override; /* see ctf_set_errno */
+#endif
 
 #include "ctf-inlines.h"
 
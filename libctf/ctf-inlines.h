@@ -90,9 +90,19 @@ ctf_assert_internal (ctf_dict_t *fp, const char *file, size_t line,
   return expr;
 }
 
+/* Set the errno of FP, or, if _libctf_errno_override is set, the errno it
+   points to: threads that share dicts with others keep their errors there.  */
+
 static inline int
 ctf_set_errno (ctf_dict_t *fp, int err)
 {
+#ifdef _libctf_thread_local_
+  if (_libctf_errno_override != NULL)
+    {
+      *_libctf_errno_override = err;
+      return -1;
+    }
+#endif
   fp->ctf_errno = err;
   /* Don't rely on CTF_ERR here as it will not properly sign extend on 64-bit
      Windows ABI.  */
@@ -102,6 +112,13 @@ ctf_set_errno (ctf_dict_t *fp, int err)
 static inline ctf_id_t
 ctf_set_typed_errno (ctf_dict_t *fp, int err)
 {
+#ifdef _libctf_thread_local_
+  if (_libctf_errno_override != NULL)
+    {
+      *_libctf_errno_override = err;
+      return CTF_ERR;
+    }
+#endif
   fp->ctf_errno = err;
   return CTF_ERR;
 }
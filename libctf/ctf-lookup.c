@@ -276,6 +276,9 @@ ctf_lookup_by_name_internal (ctf_dict_t *fp, ctf_dict_t *child,
 		    return ctf_set_typed_errno (fp, ENOMEM);
 		}
 
+	      if (ctf_populate_names (fp) < 0)
+		return CTF_ERR;			/* errno is set for us.  */
+
 	      if ((type = (ctf_id_t) (uintptr_t)
 		   ctf_dynhash_lookup (lp->ctl_hash,
 				       fp->ctf_tmp_typeslice)) == 0)
@@ -426,6 +429,9 @@ ctf_lookup_enumerator (ctf_dict_t *fp, const char *name, int64_t *enum_value)
   ctf_id_t type;
   int enum_int_value;
 
+  if (ctf_populate_names (fp) < 0)
+    return CTF_ERR;				/* errno is set for us.  */
+
   if (ctf_dynset_lookup (fp->ctf_conflicting_enums, name))
     return (ctf_set_typed_errno (fp, ECTF_DUPLICATE));
 
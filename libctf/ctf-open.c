@@ -671,39 +671,19 @@ upgrade_types (ctf_dict_t *fp, ctf_header_t *cth)
 }
 
 static int
-init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
-			    ctf_dynset_t *all_enums);
+populate_names_internal (ctf_dict_t *fp, ctf_dynset_t *all_enums);
 
 /* Populate statically-defined types (those loaded from a saved buffer).
 
    Initialize the type ID translation table with the byte offset of each type,
-   and initialize the hash tables of each named type.  Upgrade the type table to
-   the latest supported representation in the process, if needed, and if this
-   recension of libctf supports upgrading.
+   and create (but do not fill) the hash tables of each named type.  Upgrade the
+   type table to the latest supported representation in the process, if needed,
+   and if this recension of libctf supports upgrading.
 
-   Returns zero on success and a *positive* ECTF_* or errno value on error.
-
-   This is a wrapper to simplify memory allocation on error in the _internal
-   function that does all the actual work.  */
+   Returns zero on success and a *positive* ECTF_* or errno value on error.  */
 
 static int
 init_static_types (ctf_dict_t *fp, ctf_header_t *cth)
-{
-  ctf_dynset_t *all_enums;
-  int err;
-
-  if ((all_enums = ctf_dynset_create (htab_hash_pointer, htab_eq_pointer,
-				      NULL)) == NULL)
-    return ENOMEM;
-
-  err = init_static_types_internal (fp, cth, all_enums);
-  ctf_dynset_destroy (all_enums);
-  return err;
-}
-
-static int
-init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
-			    ctf_dynset_t *all_enums)
 {
   const ctf_type_t *tbuf;
   const ctf_type_t *tend;
@@ -714,15 +694,11 @@ init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
   uint32_t id;
   uint32_t *xp;
   unsigned long typemax = 0;
-  ctf_next_t *i = NULL;
-  void *k;
 
   /* We determine whether the dict is a child or a parent based on the value of
      cth_parname.  */
 
   int child = cth->cth_parname != 0;
-  int nlstructs = 0, nlunions = 0;
-  int err;
 
   if (_libctf_unlikely_ (fp->ctf_version == CTF_VERSION_1))
     {
@@ -734,10 +710,9 @@ init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
   tbuf = (ctf_type_t *) (fp->ctf_buf + cth->cth_typeoff);
   tend = (ctf_type_t *) (fp->ctf_buf + cth->cth_stroff);
 
-  /* We make two passes through the entire type section, and one third pass
-     through part of it.  In this first pass, we count the number of each type
-     and type-like identifier (like enumerators) and the total number of
-     types.  */
+  /* We make two passes through the entire type section.  In this first pass,
+     we count the number of each type and type-like identifier (like
+     enumerators) and the total number of types.  */
 
   for (tp = tbuf; tp < tend; typemax++)
     {
@@ -829,30 +804,133 @@ init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
   memset (fp->ctf_ptrtab, 0, sizeof (uint32_t) * (typemax + 1));
 
   /* In the second pass through the types, we fill in each entry of the
-     type and pointer tables and add names to the appropriate hashes.
-
-     (Not all names are added in this pass, only type names.  See below.)
+     type and pointer tables.  Names are not hashed here, but on first use
+     of the name tables, by ctf_populate_names: a lot of callers never look
+     anything up by name at all.
 
      Bump ctf_typemax as we go, but keep it one higher than normal, so that
-     the type being read in is considered a valid type and it is at least
-     barely possible to run simple lookups on it.  */
+     the type being read in is considered a valid type.  */
 
   for (id = 1, fp->ctf_typemax = 1, tp = tbuf; tp < tend; xp++, id++, fp->ctf_typemax++)
     {
       unsigned short kind = LCTF_INFO_KIND (fp, tp->ctt_info);
-      unsigned short isroot = LCTF_INFO_ISROOT (fp, tp->ctt_info);
       unsigned long vlen = LCTF_INFO_VLEN (fp, tp->ctt_info);
       ssize_t size, increment, vbytes;
 
-      const char *name;
-
       (void) ctf_get_ctt_size (fp, tp, &size, &increment);
-      name = ctf_strptr (fp, tp->ctt_name);
       /* Cannot fail: shielded by call in loop above.  */
       vbytes = LCTF_VBYTES (fp, kind, size, vlen);
 
       *xp = (uint32_t) ((uintptr_t) tp - (uintptr_t) fp->ctf_buf);
 
+      switch (kind)
+	{
+	case CTF_K_UNKNOWN:
+	case CTF_K_INTEGER:
+	case CTF_K_FLOAT:
+	case CTF_K_ARRAY:
+	case CTF_K_SLICE:
+	case CTF_K_FUNCTION:
+	case CTF_K_STRUCT:
+	case CTF_K_UNION:
+	case CTF_K_ENUM:
+	case CTF_K_TYPEDEF:
+	case CTF_K_FORWARD:
+	case CTF_K_VOLATILE:
+	case CTF_K_CONST:
+	case CTF_K_RESTRICT:
+	  break;
+
+	case CTF_K_POINTER:
+	  /* If the type referenced by the pointer is in this CTF dict, then
+	     store the index of the pointer type in fp->ctf_ptrtab[ index of
+	     referenced type ].  */
+
+	  if (LCTF_TYPE_ISCHILD (fp, tp->ctt_type) == child
+	      && LCTF_TYPE_TO_INDEX (fp, tp->ctt_type) <= fp->ctf_typemax)
+	    fp->ctf_ptrtab[LCTF_TYPE_TO_INDEX (fp, tp->ctt_type)] = id;
+	  break;
+
+	default:
+	  ctf_err_warn (fp, 0, ECTF_CORRUPT,
+			_("init_static_types(): unhandled CTF kind: %x"), kind);
+	  return ECTF_CORRUPT;
+	}
+      tp = (ctf_type_t *) ((uintptr_t) tp + increment + vbytes);
+    }
+  fp->ctf_typemax--;
+  assert (fp->ctf_typemax == typemax);
+
+  ctf_dprintf ("%lu total types processed\n", fp->ctf_typemax);
+
+  fp->ctf_names_pending = (typemax > 0);
+
+  return 0;
+}
+
+/* Add the names of the static types to the name hashes, and track all the
+   enumeration constants.  This is done the first time the name hashes are
+   needed, by a lookup or by the addition of a new type, rather than at open
+   time.
+
+   Returns 0 on success, or -1 and sets the errno on FP on error (in which
+   case the name hashes may be incomplete).
+
+   This is a wrapper to simplify memory allocation on error in the _internal
+   function that does all the actual work.  */
+
+int
+ctf_populate_names (ctf_dict_t *fp)
+{
+  ctf_dynset_t *all_enums;
+  int err;
+
+  if (!_libctf_unlikely_ (fp->ctf_names_pending))
+    return 0;
+
+  /* Clear this first: the population process itself looks up names, and
+     must not recurse.  */
+  fp->ctf_names_pending = 0;
+
+  if ((all_enums = ctf_dynset_create (htab_hash_pointer, htab_eq_pointer,
+				      NULL)) == NULL)
+    return ctf_set_errno (fp, ENOMEM);
+
+  err = populate_names_internal (fp, all_enums);
+  ctf_dynset_destroy (all_enums);
+
+  if (err != 0)
+    return ctf_set_errno (fp, err);
+  return 0;
+}
+
+static int
+populate_names_internal (ctf_dict_t *fp, ctf_dynset_t *all_enums)
+{
+  int child = fp->ctf_header->cth_parname != 0;
+  int nlstructs = 0, nlunions = 0;
+  ctf_next_t *i = NULL;
+  uint32_t id;
+  void *k;
+  int err;
+
+  /* In the first pass through the static types, we add names to the
+     appropriate hashes.  (Not all names are added in this pass, only type
+     names.  See below.)  */
+
+  for (id = 1; id <= fp->ctf_stypes; id++)
+    {
+      const ctf_type_t *tp = (const ctf_type_t *) (fp->ctf_buf
+						   + fp->ctf_txlate[id]);
+      unsigned short kind = LCTF_INFO_KIND (fp, tp->ctt_info);
+      unsigned short isroot = LCTF_INFO_ISROOT (fp, tp->ctt_info);
+      ssize_t size, increment;
+
+      const char *name;
+
+      (void) ctf_get_ctt_size (fp, tp, &size, &increment);
+      name = ctf_strptr (fp, tp->ctt_name);
+
       switch (kind)
 	{
 	case CTF_K_UNKNOWN:
@@ -993,15 +1071,6 @@ init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
 	  }
 
 	case CTF_K_POINTER:
-	  /* If the type referenced by the pointer is in this CTF dict, then
-	     store the index of the pointer type in fp->ctf_ptrtab[ index of
-	     referenced type ].  */
-
-	  if (LCTF_TYPE_ISCHILD (fp, tp->ctt_type) == child
-	      && LCTF_TYPE_TO_INDEX (fp, tp->ctt_type) <= fp->ctf_typemax)
-	    fp->ctf_ptrtab[LCTF_TYPE_TO_INDEX (fp, tp->ctt_type)] = id;
-	 /*FALLTHRU*/
-
 	case CTF_K_VOLATILE:
 	case CTF_K_CONST:
 	case CTF_K_RESTRICT:
@@ -1014,22 +1083,13 @@ init_static_types_internal (ctf_dict_t *fp, ctf_header_t *cth,
 	  if (err != 0)
 	    return err * -1;
 	  break;
-	default:
-	  ctf_err_warn (fp, 0, ECTF_CORRUPT,
-			_("init_static_types(): unhandled CTF kind: %x"), kind);
-	  return ECTF_CORRUPT;
 	}
-      tp = (ctf_type_t *) ((uintptr_t) tp + increment + vbytes);
     }
-  fp->ctf_typemax--;
-  assert (fp->ctf_typemax == typemax);
 
-  ctf_dprintf ("%lu total types processed\n", fp->ctf_typemax);
-
-  /* In the third pass, we traverse the enums we spotted earlier and track all
+  /* In the second pass, we traverse the enums we spotted earlier and track all
      the enumeration constants to aid in future detection of duplicates.
 
-     Doing this in a third pass is necessary to avoid the case where an
+     Doing this in a second pass is necessary to avoid the case where an
      enum appears with a constant FOO, then later a type named FOO appears,
      too late to spot the conflict by checking the enum's constants.  */
 
@@ -2078,6 +2138,11 @@ ctf_import (ctf_dict_t *fp, ctf_dict_t *pfp)
     {
       int err;
 
+      /* Hash any static names before this dict becomes a child, while type
+	 lookups still resolve the way they did when it was opened.  */
+      if (!(fp->ctf_flags & LCTF_CHILD) && ctf_populate_names (fp) < 0)
+	return -1;				/* errno is set for us.  */
+
       if (fp->ctf_parname == NULL)
 	if ((err = ctf_parent_name_set (fp, "PARENT")) < 0)
 	  return err;
@@ -2116,6 +2181,11 @@ ctf_import_unref (ctf_dict_t *fp, ctf_dict_t *pfp)
     {
       int err;
 
+      /* Hash any static names before this dict becomes a child, while type
+	 lookups still resolve the way they did when it was opened.  */
+      if (!(fp->ctf_flags & LCTF_CHILD) && ctf_populate_names (fp) < 0)
+	return -1;				/* errno is set for us.  */
+
       if (fp->ctf_parname == NULL)
 	if ((err = ctf_parent_name_set (fp, "PARENT")) < 0)
 	  return err;
@@ -145,16 +145,14 @@ ctf_str_free_atom (void *a)
 }
 
 /* Create the atoms table.  There is always at least one atom in it, the null
-   string: but also pull in atoms from the internal strtab.  (We rely on
-   calls to ctf_str_add_external to populate external strtab entries, since
-   these are often not quite the same as what appears in any external
-   strtab, and the external strtab is often huge and best not aggressively
-   pulled in.)  */
+   string: the atoms from the internal strtab are only pulled in when first
+   needed, by ctf_str_populate_atoms.  (We rely on calls to
+   ctf_str_add_external to populate external strtab entries, since these are
+   often not quite the same as what appears in any external strtab, and the
+   external strtab is often huge and best not aggressively pulled in.)  */
 int
 ctf_str_create_atoms (ctf_dict_t *fp)
 {
-  size_t i;
-
   fp->ctf_str_atoms = ctf_dynhash_create (ctf_hash_string, ctf_hash_eq_string,
 					  NULL, ctf_str_free_atom);
   if (!fp->ctf_str_atoms)
@@ -178,28 +176,10 @@ ctf_str_create_atoms (ctf_dict_t *fp)
   if (errno == ENOMEM)
     goto oom_str_add;
 
-  /* Pull in all the strings in the strtab as new atoms.  The provisional
-     strtab must be empty at this point, so there is no need to populate
-     atoms from it as well.  Types in this subset are frozen and readonly,
-     so the refs list and movable refs list need not be populated.  */
-
-  for (i = 0; i < fp->ctf_str[CTF_STRTAB_0].cts_len;
-       i += strlen (&fp->ctf_str[CTF_STRTAB_0].cts_strs[i]) + 1)
-    {
-      ctf_str_atom_t *atom;
-
-      if (fp->ctf_str[CTF_STRTAB_0].cts_strs[i] == 0)
-	continue;
-
-      atom = ctf_str_add_ref_internal (fp, &fp->ctf_str[CTF_STRTAB_0].cts_strs[i],
-				       0, 0);
-
-      if (!atom)
-	goto oom_str_add;
-
-      atom->csa_offset = i;
-    }
+  /* The provisional strtab must be empty at this point, so there is no need
+     to populate atoms from it as well.  */
 
+  fp->ctf_str_atoms_pending = fp->ctf_str[CTF_STRTAB_0].cts_len > 0;
   fp->ctf_str_prov_offset = fp->ctf_str[CTF_STRTAB_0].cts_len + 1;
 
   return 0;
@@ -233,6 +213,42 @@ ctf_str_free_atoms (ctf_dict_t *fp)
 #define CTF_STR_ADD_REF 0x1
 #define CTF_STR_PROVISIONAL 0x2
 #define CTF_STR_MOVABLE 0x4
+#define CTF_STR_STATIC 0x8
+
+/* Pull in all the strings in the internal strtab as new atoms, if this has
+   not been done yet.  Types in this subset are frozen and readonly, so the
+   refs list and movable refs list need not be populated, and the strings
+   live as long as the dict does, so they are not copied.  Returns -1 and
+   sets the errno on FP when out of memory.  */
+
+static int
+ctf_str_populate_atoms (ctf_dict_t *fp)
+{
+  const ctf_strs_t *strtab = &fp->ctf_str[CTF_STRTAB_0];
+  size_t i;
+
+  if (!fp->ctf_str_atoms_pending)
+    return 0;
+  fp->ctf_str_atoms_pending = 0;
+
+  for (i = 0; i < strtab->cts_len; i += strlen (&strtab->cts_strs[i]) + 1)
+    {
+      ctf_str_atom_t *atom;
+
+      if (strtab->cts_strs[i] == 0)
+	continue;
+
+      atom = ctf_str_add_ref_internal (fp, &strtab->cts_strs[i],
+				       CTF_STR_STATIC, 0);
+
+      if (!atom)
+	return -1;				/* errno is set for us.  */
+
+      atom->csa_offset = i;
+    }
+
+  return 0;
+}
 
 /* Allocate a ref and bind it into a ref list.  */
 
@@ -293,6 +309,9 @@ ctf_str_add_ref_internal (ctf_dict_t *fp, const char *str,
   ctf_str_atom_t *atom = NULL;
   int added = 0;
 
+  if (ctf_str_populate_atoms (fp) < 0)
+    return NULL;
+
   atom = ctf_dynhash_lookup (fp->ctf_str_atoms, str);
 
   /* Existing atoms get refs added only if they are provisional:
@@ -332,11 +351,12 @@ ctf_str_add_ref_internal (ctf_dict_t *fp, const char *str,
     goto oom;
   memset (atom, 0, sizeof (struct ctf_str_atom));
 
-  /* Don't allocate new strings if this string is within an mmapped
-     strtab.  */
+  /* Don't allocate new strings if this string is within the internal strtab
+     or an mmapped strtab.  */
 
-  if ((unsigned char *) str < (unsigned char *) fp->ctf_data_mmapped
-      || (unsigned char *) str > (unsigned char *) fp->ctf_data_mmapped + fp->ctf_data_mmapped_len)
+  if (!(flags & CTF_STR_STATIC)
+      && ((unsigned char *) str < (unsigned char *) fp->ctf_data_mmapped
+	  || (unsigned char *) str > (unsigned char *) fp->ctf_data_mmapped + fp->ctf_data_mmapped_len))
     {
       if ((newstr = strdup (str)) == NULL)
 	goto oom;
@@ -350,7 +370,10 @@ ctf_str_add_ref_internal (ctf_dict_t *fp, const char *str,
     goto oom;
   added = 1;
 
-  atom->csa_snapshot_id = fp->ctf_snapshots;
+  /* Atoms from the internal strtab predate all snapshots, and are never
+     rolled back.  */
+  if (!(flags & CTF_STR_STATIC))
+    atom->csa_snapshot_id = fp->ctf_snapshots;
 
   /* New atoms marked provisional go into the provisional strtab, and get a
      ref added.  */
@@ -658,6 +681,12 @@ ctf_str_write_strtab (ctf_dict_t *fp)
   int new_strtab = 0;
   int any_external = 0;
 
+  /* Atoms pulled in from the internal strtab point into it, so they must all
+     be pulled in before it is replaced below.  */
+
+  if (ctf_str_populate_atoms (fp) < 0)
+    return NULL;
+
   strtab = calloc (1, sizeof (ctf_strs_writable_t));
   if (!strtab)
     return NULL;
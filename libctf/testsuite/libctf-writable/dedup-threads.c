@@ -0,0 +1,196 @@
+/* Make sure that hashing the types of the inputs of a link on several threads
+   gives the same output as hashing them one after another, both for inputs
+   with no parent and for the children of a shared parent, as found when
+   relinking the output of a link.  */
+
+#include <ctf-api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NINPUTS 8
+
+/* Create input NUM: common types, plus a struct s and a typedef t_s that
+   conflict between odd and even inputs.  */
+
+static ctf_dict_t *
+create_input (int num)
+{
+  ctf_dict_t *fp;
+  ctf_encoding_t int_encoding = { CTF_INT_SIGNED, 0, sizeof (int) * 8 };
+  ctf_encoding_t long_encoding = { CTF_INT_SIGNED, 0, sizeof (long) * 8 };
+  ctf_id_t int_type, long_type, common, s, ptr;
+  int err;
+
+  if ((fp = ctf_create (&err)) == NULL)
+    {
+      fprintf (stderr, "Cannot create: %s\n", ctf_errmsg (err));
+      exit (1);
+    }
+
+  if ((int_type = ctf_add_integer (fp, CTF_ADD_ROOT, "int",
+				   &int_encoding)) == CTF_ERR
+      || (long_type = ctf_add_integer (fp, CTF_ADD_ROOT, "long int",
+				       &long_encoding)) == CTF_ERR
+      || (common = ctf_add_struct (fp, CTF_ADD_ROOT, "common")) == CTF_ERR
+      || ctf_add_member (fp, common, "a", int_type) < 0
+      || ctf_add_member (fp, common, "b", long_type) < 0
+      || (s = ctf_add_struct (fp, CTF_ADD_ROOT, "s")) == CTF_ERR
+      || ctf_add_member (fp, s, num % 2 ? "odd" : "even",
+			 num % 2 ? long_type : int_type) < 0
+      || (ptr = ctf_add_pointer (fp, CTF_ADD_ROOT, common)) == CTF_ERR
+      || ctf_add_member (fp, s, "common", ptr) < 0
+      || ctf_add_typedef (fp, CTF_ADD_ROOT, "t_s", s) == CTF_ERR
+      || ctf_add_pointer (fp, CTF_ADD_ROOT, s) == CTF_ERR)
+    {
+      fprintf (stderr, "Cannot add: %s\n", ctf_errmsg (ctf_errno (fp)));
+      exit (1);
+    }
+
+  return fp;
+}
+
+/* Turn FP into an archive.  */
+
+static ctf_archive_t *
+to_archive (ctf_dict_t *fp, unsigned char **buf)
+{
+  ctf_archive_t *arc;
+  ctf_sect_t s;
+  size_t buf_sz;
+  int err;
+
+  if ((*buf = ctf_write_mem (fp, &buf_sz, -1)) == NULL)
+    {
+      fprintf (stderr, "Cannot serialize: %s\n", ctf_errmsg (ctf_errno (fp)));
+      exit (1);
+    }
+
+  s.cts_name = "foo";
+  s.cts_data = (void *) *buf;
+  s.cts_size = buf_sz;
+  s.cts_entsize = 64; /* Unimportant.  */
+
+  if ((arc = ctf_arc_bufopen (&s, NULL, NULL, &err)) == NULL)
+    {
+      fprintf (stderr, "Cannot open: %s\n", ctf_errmsg (err));
+      exit (1);
+    }
+  return arc;
+}
+
+/* Link the archive in BUF, of size SIZE, if BUF is set, or else the NINPUTS
+   inputs, hashing with THREADS threads.  Return the written output.  */
+
+static unsigned char *
+link_with_threads (const char *threads, unsigned char *buf, size_t size,
+		   size_t *out_size)
+{
+  ctf_dict_t *fp;
+  ctf_archive_t *arcs[NINPUTS];
+  unsigned char *bufs[NINPUTS];
+  unsigned char *out;
+  size_t narcs = 0, i;
+  int err;
+
+  setenv ("LIBCTF_DEDUP_THREADS", threads, 1);
+
+  if ((fp = ctf_create (&err)) == NULL)
+    {
+      fprintf (stderr, "Cannot create: %s\n", ctf_errmsg (err));
+      exit (1);
+    }
+
+  if (buf != NULL)
+    {
+      ctf_sect_t s;
+
+      s.cts_name = "foo";
+      s.cts_data = (void *) buf;
+      s.cts_size = size;
+      s.cts_entsize = 64; /* Unimportant.  */
+
+      if ((arcs[0] = ctf_arc_bufopen (&s, NULL, NULL, &err)) == NULL)
+	{
+	  fprintf (stderr, "Cannot open: %s\n", ctf_errmsg (err));
+	  exit (1);
+	}
+      bufs[0] = NULL;
+      narcs = 1;
+      if (ctf_link_add_ctf (fp, arcs[0], "relinked") < 0)
+	goto link_err;
+    }
+  else
+    for (narcs = 0; narcs < NINPUTS; narcs++)
+      {
+	ctf_dict_t *in = create_input (narcs);
+	char name[16];
+
+	arcs[narcs] = to_archive (in, &bufs[narcs]);
+	ctf_dict_close (in);
+	sprintf (name, "input%i", (int) narcs);
+	if (ctf_link_add_ctf (fp, arcs[narcs], name) < 0)
+	  goto link_err;
+      }
+
+  if (ctf_link (fp, CTF_LINK_SHARE_UNCONFLICTED) < 0)
+    goto link_err;
+
+  if ((out = ctf_link_write (fp, out_size, 4096)) == NULL)
+    goto link_err;
+
+  /* This closes the archives too.  */
+  ctf_dict_close (fp);
+  for (i = 0; i < narcs; i++)
+    free (bufs[i]);
+  return out;
+
+ link_err:
+  fprintf (stderr, "Cannot link: %s\n", ctf_errmsg (ctf_errno (fp)));
+  exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  unsigned char *serial, *threaded, *serial_relink, *threaded_relink;
+  size_t serial_sz, threaded_sz, serial_relink_sz, threaded_relink_sz;
+
+  /* Linking does not currently work on mingw because of an unreliable tmpfile
+     implementation on that platform (see
+     https://github.com/msys2/MINGW-packages/issues/18878).  Simply skip for
+     now.  */
+
+#ifdef __MINGW32__
+  printf ("UNSUPPORTED: platform bug breaks ctf_link\n");
+  return 0;
+#else
+
+  serial = link_with_threads ("1", NULL, 0, &serial_sz);
+  threaded = link_with_threads ("4", NULL, 0, &threaded_sz);
+
+  if (serial_sz != threaded_sz || memcmp (serial, threaded, serial_sz) != 0)
+    printf ("Link output differs with threads.\n");
+  else
+    printf ("Link output identical with threads.\n");
+
+  /* The output has conflicting types, so its members are children of a
+     shared parent.  */
+  serial_relink = link_with_threads ("1", serial, serial_sz,
+				     &serial_relink_sz);
+  threaded_relink = link_with_threads ("4", serial, serial_sz,
+				       &threaded_relink_sz);
+
+  if (serial_relink_sz != threaded_relink_sz
+      || memcmp (serial_relink, threaded_relink, serial_relink_sz) != 0)
+    printf ("Relink output differs with threads.\n");
+  else
+    printf ("Relink output identical with threads.\n");
+
+  free (serial);
+  free (threaded);
+  free (serial_relink);
+  free (threaded_relink);
+  return 0;
+#endif
+}
@@ -0,0 +1,121 @@
+/* Verify that names in a dict opened from a buffer are looked up correctly,
+   and that types added to it detect clashes with those names, when the name
+   tables are populated on first use rather than at open time.  */
+
+#include <ctf-api.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ctf_dict_t *
+reopen (unsigned char *buf, size_t size)
+{
+  ctf_dict_t *fp;
+  int err;
+
+  if ((fp = ctf_simple_open ((char *) buf, size, NULL, 0, 0, NULL, 0,
+			     &err)) == NULL)
+    {
+      fprintf (stderr, "Cannot reopen: %s\n", ctf_errmsg (err));
+      exit (1);
+    }
+  return fp;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ctf_dict_t *fp;
+  ctf_encoding_t en = { CTF_INT_SIGNED, 0, sizeof (int) * 8 };
+  ctf_id_t itype, stype, etype, type;
+  unsigned char *buf, *buf2;
+  size_t size, size2;
+  int64_t val;
+  int err;
+
+  if ((fp = ctf_create (&err)) == NULL)
+    goto create_err;
+
+  if ((itype = ctf_add_integer (fp, CTF_ADD_ROOT, "int", &en)) == CTF_ERR
+      || (stype = ctf_add_struct (fp, CTF_ADD_ROOT, "foo")) == CTF_ERR
+      || ctf_add_member (fp, stype, "bar", itype) < 0
+      || ctf_add_typedef (fp, CTF_ADD_ROOT, "foo_t", stype) == CTF_ERR
+      || (etype = ctf_add_enum (fp, CTF_ADD_ROOT, "e")) == CTF_ERR
+      || ctf_add_enumerator (fp, etype, "A", 1) < 0
+      || ctf_add_enumerator (fp, etype, "B", 2) < 0)
+    goto err;
+
+  if ((buf = ctf_write_mem (fp, &size, 4096)) == NULL)
+    goto err;
+  ctf_dict_close (fp);
+
+  /* Lookups of all kinds of name.  */
+
+  fp = reopen (buf, size);
+
+  if (ctf_lookup_by_name (fp, "struct foo") == CTF_ERR
+      || ctf_lookup_by_name (fp, "foo_t") == CTF_ERR
+      || ctf_lookup_by_name (fp, "enum e") == CTF_ERR
+      || ctf_lookup_by_name (fp, "int") == CTF_ERR)
+    goto err;
+
+  if (ctf_lookup_by_name (fp, "struct bar") != CTF_ERR)
+    fprintf (stderr, "struct bar unexpectedly found\n");
+
+  if ((type = ctf_lookup_enumerator (fp, "B", &val)) == CTF_ERR)
+    goto err;
+  if (val != 2)
+    fprintf (stderr, "B has value %" PRIi64 ", not 2\n", val);
+  ctf_dict_close (fp);
+
+  /* Addition of types before any lookup.  An enumerator in an anonymous enum
+     is the only name that does not go through the name tables on its way in,
+     so check that it still clashes with the static enumerators.  */
+
+  fp = reopen (buf, size);
+
+  if ((etype = ctf_add_enum (fp, CTF_ADD_ROOT, NULL)) == CTF_ERR
+      || ctf_add_enumerator (fp, etype, "A", 3) < 0)
+    goto err;
+
+  if (ctf_lookup_enumerator (fp, "A", &val) != CTF_ERR)
+    fprintf (stderr, "Clashing enumerator A not detected\n");
+  else if (ctf_errno (fp) != ECTF_DUPLICATE)
+    goto err;
+
+  if (ctf_add_typedef (fp, CTF_ADD_ROOT, "foo_t", itype) != CTF_ERR)
+    fprintf (stderr, "Static typedef unexpectedly replaced\n");
+  else if (ctf_errno (fp) != ECTF_RDONLY)
+    goto err;
+
+  /* Writing out uses the strings in the existing strtab without duplicating
+     them, looked up or not.  */
+
+  if (ctf_add_typedef (fp, CTF_ADD_ROOT, "foo", itype) == CTF_ERR)
+    goto err;
+
+  if ((buf2 = ctf_write_mem (fp, &size2, 4096)) == NULL)
+    goto err;
+  ctf_dict_close (fp);
+
+  fp = reopen (buf2, size2);
+  if ((type = ctf_lookup_by_name (fp, "foo")) == CTF_ERR
+      || ctf_type_kind (fp, type) != CTF_K_TYPEDEF
+      || ctf_lookup_by_name (fp, "struct foo") == CTF_ERR)
+    goto err;
+  ctf_dict_close (fp);
+  free (buf2);
+  free (buf);
+
+  printf ("All done.\n");
+  return 0;
+
+ create_err:
+  fprintf (stderr, "Creation failed: %s\n", ctf_errmsg (err));
+  return 1;
+ err:
+  fprintf (stderr, "Cannot populate or look up: %s\n",
+	   ctf_errmsg (ctf_errno (fp)));
+  return 1;
+}
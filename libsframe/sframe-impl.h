@@ -30,6 +30,40 @@ extern "C"
 #include <assert.h>
 #define sframe_assert(expr) (assert (expr))
 
+/* Number of entries in the PC lookup cache of the FRE index.  */
+#define SFRAME_INDEX_CACHE_SIZE 256
+
+typedef struct sframe_index_cache_entry
+{
+  /* PC looked up.  */
+  int32_t sfc_pc;
+  /* Index of the FDE containing PC.  */
+  uint32_t sfc_fde;
+  /* Index, plus one, of the FRE in the index arrays.  Zero if the entry
+     is unused.  */
+  uint32_t sfc_fre;
+} sframe_index_cache_entry;
+
+/* Decoded form of the FDE and FRE sub-sections, built on request by
+   sframe_decoder_build_index, so that lookups need not decode the
+   variable-width FREs one by one.  */
+
+typedef struct sframe_fre_index
+{
+  /* Start address of each function, one per FDE.  */
+  int32_t *sfi_func_start;
+  /* Position of the first FRE of each function in the arrays below.  */
+  uint32_t *sfi_first_fre;
+  /* Start address offset of each FRE, widened to 32 bits.  */
+  uint32_t *sfi_fre_start;
+  /* Offset of each FRE in the FRE sub-section.  */
+  uint32_t *sfi_fre_off;
+  /* Total number of FREs.  */
+  uint32_t sfi_num_fres;
+  /* Recent lookups, indexed by PC.  */
+  sframe_index_cache_entry sfi_cache[SFRAME_INDEX_CACHE_SIZE];
+} sframe_fre_index;
+
 struct sframe_decoder_ctx
 {
   /* SFrame header.  */
@@ -43,6 +77,8 @@ struct sframe_decoder_ctx
   /* Reference to the internally malloc'd buffer, if any, for endian flipping
      the original input buffer before decoding.  */
   void *sfd_buf;
+  /* Decoded index for the lookups, if built.  */
+  sframe_fre_index *sfd_index;
 };
 
 typedef struct sf_fde_tbl sf_fde_tbl;
@@ -595,6 +595,18 @@ sframe_get_fre_offset (sframe_frame_row_entry *fre, int idx, int *errp)
     }
 }
 
+/* Free the FRE index IDX.  */
+
+static void
+sframe_free_index (sframe_fre_index *idx)
+{
+  free (idx->sfi_func_start);
+  free (idx->sfi_first_fre);
+  free (idx->sfi_fre_start);
+  free (idx->sfi_fre_off);
+  free (idx);
+}
+
 /* Free the decoder context.  */
 
 void
@@ -621,6 +633,11 @@ sframe_decoder_free (sframe_decoder_ctx **dctxp)
 	  free (dctx->sfd_buf);
 	  dctx->sfd_buf = NULL;
 	}
+      if (dctx->sfd_index != NULL)
+	{
+	  sframe_free_index (dctx->sfd_index);
+	  dctx->sfd_index = NULL;
+	}
 
       free (*dctxp);
       *dctxp = NULL;
@@ -1103,6 +1120,196 @@ sframe_fre_get_end_ip_offset (sframe_func_desc_entry *fdep, unsigned int i,
   return end_ip_offset;
 }
 
+/* Build the FRE index for the decoder CTX.  The start address of every
+   FRE is decoded once, and kept in a fixed-width array together with the
+   FRE offset, so that sframe_find_fre can binary search both the FDEs and
+   the FREs of a function.  Returns SFRAME_ERR if failure.  */
+
+int
+sframe_decoder_build_index (sframe_decoder_ctx *ctx)
+{
+  sframe_header *dhp;
+  sframe_func_desc_entry *fdep;
+  sframe_fre_index *idx;
+  uint32_t num_fdes, num_fres, fre_type, fre_off, n, i, j;
+  uint32_t start_addr;
+  size_t addr_size, fre_size;
+  int err = 0;
+
+  if (ctx == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_INVAL);
+
+  if (ctx->sfd_index != NULL)
+    return 0;
+
+  dhp = sframe_decoder_get_header (ctx);
+  if (dhp->sfh_num_fdes == 0 || ctx->sfd_funcdesc == NULL
+      || ctx->sfd_fres == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_DCTX_INVAL);
+  if ((dhp->sfh_preamble.sfp_flags & SFRAME_F_FDE_SORTED) == 0)
+    return sframe_set_errno (&err, SFRAME_ERR_FDE_NOTSORTED);
+
+  num_fdes = dhp->sfh_num_fdes;
+  num_fres = 0;
+  for (i = 0; i < num_fdes; i++)
+    {
+      n = ctx->sfd_funcdesc[i].sfde_func_num_fres;
+      if (n > UINT32_MAX - num_fres)
+	return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+      num_fres += n;
+    }
+
+  idx = calloc (1, sizeof (sframe_fre_index));
+  if (idx == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+  idx->sfi_func_start = malloc (num_fdes * sizeof (int32_t));
+  idx->sfi_first_fre = malloc (num_fdes * sizeof (uint32_t));
+  idx->sfi_fre_start = malloc ((num_fres + 1) * sizeof (uint32_t));
+  idx->sfi_fre_off = malloc ((num_fres + 1) * sizeof (uint32_t));
+  if (idx->sfi_func_start == NULL || idx->sfi_first_fre == NULL
+      || idx->sfi_fre_start == NULL || idx->sfi_fre_off == NULL)
+    {
+      sframe_free_index (idx);
+      return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+    }
+
+  n = 0;
+  for (i = 0; i < num_fdes; i++)
+    {
+      fdep = &ctx->sfd_funcdesc[i];
+      fre_type = sframe_get_fre_type (fdep);
+      if (fre_type > SFRAME_FRE_TYPE_ADDR4)
+	goto bad_fre;
+      addr_size = sframe_fre_start_addr_size (fre_type);
+
+      idx->sfi_func_start[i] = fdep->sfde_func_start_address;
+      idx->sfi_first_fre[i] = n;
+
+      fre_off = fdep->sfde_func_start_fre_off;
+      for (j = 0; j < fdep->sfde_func_num_fres; j++, n++)
+	{
+	  /* The FREs are decoded without further checks by the lookups, so
+	     make sure each one lies within the FRE sub-section here.  */
+	  if (fre_off >= (uint32_t) ctx->sfd_fre_nbytes
+	      || addr_size + 1 > ctx->sfd_fre_nbytes - fre_off)
+	    goto bad_fre;
+	  sframe_decode_fre_start_address (ctx->sfd_fres + fre_off,
+					   &start_addr, fre_type);
+	  fre_size = addr_size + 1 + sframe_fre_offset_bytes_size
+				       (ctx->sfd_fres[fre_off + addr_size]);
+	  if (fre_size > ctx->sfd_fre_nbytes - fre_off)
+	    goto bad_fre;
+	  /* The FREs must be sorted on their start address for the
+	     binary search.  */
+	  if (j > 0 && start_addr < idx->sfi_fre_start[n - 1])
+	    goto bad_fre;
+
+	  idx->sfi_fre_start[n] = start_addr;
+	  idx->sfi_fre_off[n] = fre_off;
+	  fre_off += fre_size;
+	}
+    }
+  idx->sfi_num_fres = n;
+
+  ctx->sfd_index = idx;
+  return 0;
+
+ bad_fre:
+  sframe_free_index (idx);
+  return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+}
+
+/* Find the SFrame Row Entry which contains the PC using the FRE index of
+   CTX.  The result is the same as that of the linear scan done in
+   sframe_find_fre without an index.  Returns SFRAME_ERR if failure.  */
+
+static int
+sframe_find_fre_indexed (sframe_decoder_ctx *ctx, int32_t pc,
+			 sframe_frame_row_entry *frep)
+{
+  sframe_fre_index *idx = ctx->sfd_index;
+  sframe_index_cache_entry *ce;
+  sframe_func_desc_entry *fdep;
+  const uint32_t *fre_start;
+  uint32_t fde_i, fre_i;
+  uint32_t low, high, num_fres;
+  int32_t key;
+  size_t size = 0;
+  int err = 0;
+
+  ce = &idx->sfi_cache[(uint32_t) pc % SFRAME_INDEX_CACHE_SIZE];
+  if (ce->sfc_fre != 0 && ce->sfc_pc == pc)
+    {
+      fdep = &ctx->sfd_funcdesc[ce->sfc_fde];
+      fre_i = ce->sfc_fre - 1;
+      goto found;
+    }
+
+  /* Find the last function which starts at or before PC.  */
+  low = 0;
+  high = ctx->sfd_header.sfh_num_fdes;
+  while (low < high)
+    {
+      uint32_t mid = low + (high - low) / 2;
+
+      if (idx->sfi_func_start[mid] <= pc)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+  if (low == 0)
+    return sframe_set_errno (&err, SFRAME_ERR_DCTX_INVAL);
+  fde_i = low - 1;
+  fdep = &ctx->sfd_funcdesc[fde_i];
+
+  num_fres = fdep->sfde_func_num_fres;
+  if (num_fres == 0)
+    return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+
+  if (sframe_get_fde_type (fdep) == SFRAME_FDE_TYPE_PCMASK)
+    {
+      if (fdep->sfde_func_rep_size == 0)
+	return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+      key = pc % fdep->sfde_func_rep_size;
+    }
+  else
+    {
+      key = pc - fdep->sfde_func_start_address;
+      /* First FRE's start_ip must be more than pc for regular SFrame
+	 FDEs.  */
+      if ((int32_t) idx->sfi_fre_start[idx->sfi_first_fre[fde_i]] > key)
+	return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+    }
+
+  /* Find the last FRE which starts at or before KEY.  Only that one can
+     contain KEY, as each FRE ends where the next one starts.  */
+  fre_start = idx->sfi_fre_start + idx->sfi_first_fre[fde_i];
+  low = 0;
+  high = num_fres;
+  while (low < high)
+    {
+      uint32_t mid = low + (high - low) / 2;
+
+      if ((int32_t) fre_start[mid] <= key)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+  if (low == 0
+      || (low == num_fres
+	  && key > (int32_t) (fdep->sfde_func_size - 1)))
+    return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+  fre_i = idx->sfi_first_fre[fde_i] + low - 1;
+
+  ce->sfc_pc = pc;
+  ce->sfc_fde = fde_i;
+  ce->sfc_fre = fre_i + 1;
+
+ found:
+  return sframe_decode_fre (ctx->sfd_fres + idx->sfi_fre_off[fre_i], frep,
+			    sframe_get_fre_type (fdep), &size);
+}
+
 /* Find the SFrame Row Entry which contains the PC.  Returns
    SFRAME_ERR if failure.  */
 
@@ -1124,6 +1331,9 @@ sframe_find_fre (sframe_decoder_ctx *ctx, int32_t pc,
   if ((ctx == NULL) || (frep == NULL))
     return sframe_set_errno (&err, SFRAME_ERR_INVAL);
 
+  if (ctx->sfd_index != NULL)
+    return sframe_find_fre_indexed (ctx, pc, frep);
+
   /* Find the FDE which contains the PC, then scan its fre entries.  */
   fdep = sframe_get_funcdesc_with_addr_internal (ctx, pc, &err);
   if (fdep == NULL || ctx->sfd_fres == NULL)
@@ -0,0 +1,184 @@
+/* findfre-index-1.c -- Test for sframe_find_fre with the
+   index built by sframe_decoder_build_index.
+
+   Copyright (C) 2025 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sframe-api.h"
+
+/* DejaGnu should not use gnulib's vsnprintf replacement here.  */
+#undef vsnprintf
+#include <dejagnu.h>
+
+/* Number of PCINC functions, and the distance between their start
+   addresses.  A PCMASK function follows them.  */
+#define NUM_FUNCS 2000
+#define FUNC_ALIGN 0x200
+#define FUNC_BASE 0x1000
+#define PLT_START (FUNC_BASE + NUM_FUNCS * FUNC_ALIGN)
+#define PLT_SIZE 0x400
+
+static int
+add_fre (sframe_encoder_ctx *encode, int idx, uint32_t start_addr,
+	 int32_t cfa_offset)
+{
+  sframe_frame_row_entry fre;
+
+  memset (&fre, 0, sizeof (fre));
+  fre.fre_start_addr = start_addr;
+  memcpy (fre.fre_offsets, &cfa_offset, sizeof (cfa_offset));
+  fre.fre_info = SFRAME_V1_FRE_INFO (SFRAME_BASE_REG_SP, 1,
+				     SFRAME_FRE_OFFSET_4B);
+  return sframe_encoder_add_fre (encode, idx, &fre);
+}
+
+/* Add the functions, with a varying size and number of FREs so that all
+   the FRE start address sizes are used.  */
+
+static int
+add_fdes (sframe_encoder_ctx *encode)
+{
+  unsigned char finfo;
+  uint32_t size, num_fres, j;
+  int i;
+
+  for (i = 0; i < NUM_FUNCS; i++)
+    {
+      size = (i % 3 == 0) ? 0x80 + (i % 7) * 0x10 : 0x100 + (i % 11) * 0x20;
+      num_fres = 1 + i % 24;
+      finfo = sframe_fde_create_func_info (sframe_calc_fre_type (size),
+					   SFRAME_FDE_TYPE_PCINC);
+      if (sframe_encoder_add_funcdesc (encode, FUNC_BASE + i * FUNC_ALIGN,
+				       size, finfo, num_fres) == SFRAME_ERR)
+	return -1;
+      for (j = 0; j < num_fres; j++)
+	if (add_fre (encode, i, j * (size / num_fres), i * 32 + j)
+	    == SFRAME_ERR)
+	  return -1;
+    }
+
+  finfo = sframe_fde_create_func_info (SFRAME_FRE_TYPE_ADDR1,
+				       SFRAME_FDE_TYPE_PCMASK);
+  if (sframe_encoder_add_funcdesc_v2 (encode, PLT_START, PLT_SIZE, finfo,
+				      16, 2) == SFRAME_ERR
+      || add_fre (encode, i, 0x0, 8) == SFRAME_ERR
+      || add_fre (encode, i, 0xb, 16) == SFRAME_ERR)
+    return -1;
+
+  return 0;
+}
+
+/* Check that the lookups for PC in the decoders LINEAR and INDEXED give
+   the same result.  */
+
+static int
+same_fre_p (sframe_decoder_ctx *linear, sframe_decoder_ctx *indexed,
+	    int32_t pc)
+{
+  sframe_frame_row_entry fre1, fre2;
+  int err1, err2;
+
+  memset (&fre1, 0, sizeof (fre1));
+  memset (&fre2, 0, sizeof (fre2));
+  err1 = sframe_find_fre (linear, pc, &fre1);
+  err2 = sframe_find_fre (indexed, pc, &fre2);
+  if (err1 != err2)
+    return 0;
+  return (err1 != 0
+	  || (fre1.fre_start_addr == fre2.fre_start_addr
+	      && fre1.fre_info == fre2.fre_info
+	      && memcmp (fre1.fre_offsets, fre2.fre_offsets,
+			 MAX_OFFSET_BYTES) == 0));
+}
+
+int main (void)
+{
+  sframe_encoder_ctx *encode;
+  sframe_decoder_ctx *linear, *indexed;
+  sframe_frame_row_entry frep;
+  char *sframe_buf;
+  size_t sf_size;
+  int err = 0;
+  int32_t pc;
+  int mismatch;
+
+#define TEST(name, cond)                                                      \
+  do                                                                          \
+    {                                                                         \
+      if (cond)                                                               \
+	pass (name);                                                          \
+      else                                                                    \
+	fail (name);                                                          \
+    }                                                                         \
+    while (0)
+
+  encode = sframe_encode (SFRAME_VERSION, SFRAME_F_FDE_SORTED,
+			  SFRAME_ABI_AMD64_ENDIAN_LITTLE,
+			  SFRAME_CFA_FIXED_FP_INVALID,
+			  -8, /* Fixed RA offset for AMD64.  */
+			  &err);
+
+  err = add_fdes (encode);
+  TEST ("findfre-index-1: Adding FDEs", err == 0);
+
+  sframe_buf = sframe_encoder_write (encode, &sf_size, &err);
+  TEST ("findfre-index-1: Encoder write", err == 0);
+
+  linear = sframe_decode (sframe_buf, sf_size, &err);
+  indexed = sframe_decode (sframe_buf, sf_size, &err);
+  TEST ("findfre-index-1: Decoder setup", linear != NULL && indexed != NULL);
+
+  err = sframe_decoder_build_index (indexed);
+  TEST ("findfre-index-1: Build index", err == 0);
+
+  /* Find the last FRE of the third function.  */
+  err = sframe_find_fre (indexed, FUNC_BASE + 2 * FUNC_ALIGN + 0x130, &frep);
+  TEST ("findfre-index-1: Find last FRE",
+	err == 0 && sframe_fre_get_cfa_offset (indexed, &frep, &err) == 66);
+
+  /* Find an FRE for PC in the gap after a function.  Expect error code.  */
+  err = sframe_find_fre (indexed, FUNC_BASE + FUNC_ALIGN - 1, &frep);
+  TEST ("findfre-index-1: Find FRE for PC between functions",
+	err == SFRAME_ERR);
+
+  /* Find an FRE for PC before the first function.  Expect error code.  */
+  err = sframe_find_fre (indexed, FUNC_BASE - 1, &frep);
+  TEST ("findfre-index-1: Find FRE for PC before first function",
+	err == SFRAME_ERR);
+
+  /* Find the second FRE of the PCMASK function.  */
+  err = sframe_find_fre (indexed, PLT_START + 0x10 * 5 + 0xc, &frep);
+  TEST ("findfre-index-1: Find FRE in PCMASK function",
+	err == 0 && sframe_fre_get_cfa_offset (indexed, &frep, &err) == 16);
+
+  /* Compare every PC against the linear scan.  The second lookup of each
+     PC is answered from the lookup cache.  */
+  mismatch = 0;
+  for (pc = FUNC_BASE - 0x10; pc < PLT_START + PLT_SIZE + 0x10; pc++)
+    if (!same_fre_p (linear, indexed, pc) || !same_fre_p (linear, indexed, pc))
+      mismatch++;
+  TEST ("findfre-index-1: Indexed lookups match linear scan", mismatch == 0);
+
+  sframe_encoder_free (&encode);
+  sframe_decoder_free (&linear);
+  sframe_decoder_free (&indexed);
+
+  return 0;
+}
@@ -1,11 +1,16 @@
 if HAVE_COMPAT_DEJAGNU
-  check_PROGRAMS += %D%/findfre-1 %D%/findfunc-1 %D%/plt-findfre-1
+  check_PROGRAMS += %D%/findfre-1 %D%/findfre-index-1 %D%/findfunc-1 \
+	%D%/plt-findfre-1
 endif
 
 %C%_findfre_1_SOURCES = %D%/findfre-1.c
 %C%_findfre_1_LDADD = ${top_builddir}/libsframe.la
 %C%_findfre_1_CPPFLAGS = -I${top_srcdir}/../include -Wall
 
+%C%_findfre_index_1_SOURCES = %D%/findfre-index-1.c
+%C%_findfre_index_1_LDADD = ${top_builddir}/libsframe.la
+%C%_findfre_index_1_CPPFLAGS = -I${top_srcdir}/../include -Wall
+
 %C%_findfunc_1_SOURCES = %D%/findfunc-1.c
 %C%_findfunc_1_LDADD = ${top_builddir}/libsframe.la
 %C%_findfunc_1_CPPFLAGS = -I${top_srcdir}/../include -Wall